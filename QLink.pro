@@ -9,7 +9,14 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# Cross-check every answer of the incremental pair index against a full scan
+# of the board. Very slow, only meant for debugging.
+#DEFINES += QLINK_VERIFY_PAIR_INDEX
+
+include(core.pri)
+
 SOURCES += \
+    analysisworker.cpp \
     block.cpp \
     gamewindow.cpp \
     main.cpp \
@@ -22,13 +29,13 @@ SOURCES += \
     utils.cpp
 
 HEADERS += \
+    analysisworker.h \
     block.h \
     gamewindow.h \
     includes.h \
     player.h \
     qlinkmap.h \
     startwindow.h \
-    types.h \
     uiconfig.h \
     uimanager.h \
     unittest.h \
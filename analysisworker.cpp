@@ -0,0 +1,65 @@
+#include "analysisworker.h"
+
+#include "nextstep.h"
+
+AnalysisWorker::AnalysisWorker(QObject *parent): QObject(parent),
+    pairIndex(&board)
+{
+    fields[0].setBoard(&board);
+    fields[1].setBoard(&board);
+
+}
+
+void AnalysisWorker::submit(shared_ptr<const BoardSnapshot> snapshot)
+{
+    QMutexLocker locker(&lock);
+    const bool idle = !pending;
+    pending = std::move(snapshot);
+
+    // A queued call is already on its way otherwise, and will pick up the
+    // newer snapshot.
+    if (idle) {
+        QMetaObject::invokeMethod(this, "analyzePending",
+                                  Qt::QueuedConnection);
+    }
+}
+
+void AnalysisWorker::analyzePending()
+{
+    shared_ptr<const BoardSnapshot> snapshot;
+    {
+        QMutexLocker locker(&lock);
+        snapshot.swap(pending);
+    }
+    if (snapshot) {
+        emit sendAnalysis(analyze(*snapshot));
+    }
+}
+
+BoardAnalysis AnalysisWorker::analyze(const BoardSnapshot &snapshot)
+{
+    BoardAnalysis result;
+    result.version = snapshot.version;
+
+    board = snapshot.board;
+    pairIndex.rebuild(snapshot.maxTurns);
+
+    result.stuck = true;
+    for (int i = 0; i < 2; ++i) {
+        if (snapshot.players[i].r < 0) {
+            continue;
+        }
+
+        // Every snapshot may hold a different board.
+        fields[i].invalidate();
+        fields[i].setSource(snapshot.players[i]);
+        fields[i].refresh();
+        result.hasHint[i] = findCheapestPairs(board, pairIndex, fields[i], 1,
+                                              &cheapest) > 0;
+        if (result.hasHint[i]) {
+            result.hints[i] = cheapest[0];
+        }
+        result.stuck = result.stuck && !result.hasHint[i];
+    }
+    return result;
+}
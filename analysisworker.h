@@ -0,0 +1,50 @@
+#ifndef ANALYSISWORKER_H
+#define ANALYSISWORKER_H
+
+#include <utility>
+
+#include "includes.h"
+#include "board.h"
+#include "distancefield.h"
+#include "gameengine.h"
+#include "pairindex.h"
+
+Q_DECLARE_METATYPE(BoardAnalysis)
+
+// Searches board snapshots for hints and dead ends on a thread of its own, so
+// that dense boards do not freeze the game.
+//
+// Snapshots are passed through a mailbox that holds only the latest one: a
+// snapshot that is replaced before the worker gets to it is never analyzed.
+class AnalysisWorker: public QObject {
+    Q_OBJECT
+
+public:
+    AnalysisWorker(QObject *parent = nullptr);
+
+    // Hand <snapshot> over to the worker. May be called from any thread.
+    void submit(shared_ptr<const BoardSnapshot> snapshot);
+
+signals:
+    void sendAnalysis(const BoardAnalysis &analysis);
+
+private slots:
+    // Analyze the snapshot in the mailbox, if there is one.
+    void analyzePending();
+
+private:
+    QMutex lock;
+    shared_ptr<const BoardSnapshot> pending;
+
+    // Copy of the analyzed board that the indices below run on.
+    Board board;
+    PairIndex pairIndex;
+
+    // Walking distances from each player.
+    DistanceField fields[2];
+    std::vector<std::pair<Cell, Cell>> cheapest;
+
+    BoardAnalysis analyze(const BoardSnapshot &snapshot);
+};
+
+#endif // ANALYSISWORKER_H
@@ -0,0 +1,228 @@
+#include "beamsolver.h"
+
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+
+BeamSolver::BeamSolver(const int workers): pool(workers),
+    found(pool.workerCount()), ranked(pool.workerCount()), totalBlocks(0),
+    hasDeadline(false)
+{
+
+}
+
+BeamResult BeamSolver::solve(const Board &board, const int maxTurns,
+                             const BeamOptions &options)
+{
+    const auto start = std::chrono::steady_clock::now();
+    BeamResult result;
+    hasDeadline = options.maxMillis > 0;
+    deadline = start + std::chrono::milliseconds(options.maxMillis);
+
+    // Fixed keys, so that runs on the same board are repeatable.
+    std::mt19937_64 rng(0);
+    keys.resize(board.size());
+    for (auto &key: keys) {
+        key = rng();
+    }
+
+    beam.clear();
+    beam.emplace_back(new State());
+    State &root = *beam[0];
+    root.board = board;
+    root.pairs.setBoard(&root.board);
+    root.pairs.rebuild(maxTurns);
+    root.regions.setBoard(&root.board);
+    root.regions.rebuild();
+    totalBlocks = 0;
+    for (BlockContent bc = 1; bc < board.contentLimit(); ++bc) {
+        for (const int idx: board.blocksOf(bc)) {
+            root.hash ^= keys[idx];
+            ++totalBlocks;
+        }
+    }
+
+    std::vector<std::pair<int, int>> bestLine;
+    std::vector<Child> chosen;
+    std::unordered_set<uint64_t> seen;
+    int blocksLeft = totalBlocks;
+
+    while (blocksLeft && !beam.empty()) {
+        if (isExpired()) {
+            result.timedOut = true;
+            break;
+        }
+
+        // Score the moves of every position in the beam.
+        for (auto &f: found) {
+            f.clear();
+        }
+        pool.run(static_cast<int>(beam.size()),
+                 [&](const int task, const int worker) {
+            expand(*beam[task], task, options, worker);
+        });
+        result.expanded += beam.size();
+
+        // A layer cut short by the deadline is not trusted.
+        if (isExpired()) {
+            result.timedOut = true;
+            break;
+        }
+
+        children.clear();
+        for (const auto &f: found) {
+            children.insert(children.end(), f.begin(), f.end());
+        }
+        result.scored += children.size();
+        if (children.empty()) {
+            break;
+        }
+        std::sort(children.begin(), children.end(),
+                  [](const Child &x, const Child &y) {
+            return x.score != y.score ? x.score > y.score : x.hash < y.hash;
+        });
+
+        // The best move of the deepest layer so far, even if it is a dead end.
+        bestLine = beam[children[0].parent]->line;
+        bestLine.emplace_back(children[0].a, children[0].b);
+        blocksLeft -= 2;
+        if (!blocksLeft) {
+            break;
+        }
+
+        // The next layer: the best distinct positions that are not stuck.
+        chosen.clear();
+        seen.clear();
+        for (const Child &child: children) {
+            if (static_cast<int>(chosen.size()) >= options.width) {
+                break;
+            }
+            if (!child.dead && seen.insert(child.hash).second) {
+                chosen.push_back(child);
+            }
+        }
+
+        next.resize(chosen.size());
+        for (auto &state: next) {
+            if (!state) {
+                state.reset(new State());
+            }
+        }
+        pool.run(static_cast<int>(chosen.size()),
+                 [&](const int task, const int) {
+            const Child &child = chosen[task];
+            State &state = *next[task];
+            copyState(*beam[child.parent], state);
+            for (const int idx: { child.a, child.b }) {
+                const Cell cell = state.board.cellAt(idx);
+                state.board.clearCell(cell.r, cell.c);
+                state.pairs.removeBlock(cell);
+                state.regions.removeBlock(cell);
+            }
+            state.line.emplace_back(child.a, child.b);
+            state.hash = child.hash;
+        });
+        std::swap(beam, next);
+    }
+
+    result.cleared = !blocksLeft;
+    result.blocksLeft = totalBlocks - 2 * static_cast<int>(bestLine.size());
+    for (const auto &m: bestLine) {
+        result.moves.emplace_back(board.cellAt(m.first),
+                                  board.cellAt(m.second));
+    }
+    result.seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void BeamSolver::copyState(const State &from, State &to)
+{
+    to.board = from.board;
+    to.pairs = from.pairs;
+    to.pairs.setBoard(&to.board);
+    to.regions = from.regions;
+    to.regions.setBoard(&to.board);
+    to.line = from.line;
+    to.hash = from.hash;
+}
+
+void BeamSolver::expand(State &state, const int parent,
+                        const BeamOptions &options, const int worker)
+{
+    std::vector<Candidate> &order = ranked[worker];
+    order.clear();
+
+    // The last two blocks of a content are always safe to remove, as in the
+    // exact solver, so such a position has a single move worth scoring.
+    for (BlockContent bc = 1; bc < state.board.contentLimit(); ++bc) {
+        const std::vector<int> &blocks = state.board.blocksOf(bc);
+        if (blocks.size() == 2 &&
+            state.pairs.contains(state.board.cellAt(blocks[0]),
+                                 state.board.cellAt(blocks[1]))) {
+            order.push_back({ 0, blocks[0], blocks[1] });
+            break;
+        }
+    }
+
+    // Otherwise, only the moves that break up the fewest other pairs are
+    // scored.
+    if (order.empty()) {
+        for (int i = 0; i < state.pairs.count(); ++i) {
+            const auto pair = state.pairs.pairAt(i);
+            order.push_back({ state.pairs.partnerCount(pair.first) +
+                              state.pairs.partnerCount(pair.second),
+                              state.board.index(pair.first),
+                              state.board.index(pair.second) });
+        }
+        if (options.branching > 0 &&
+            static_cast<int>(order.size()) > options.branching) {
+            std::partial_sort(order.begin(), order.begin() + options.branching,
+                              order.end(),
+                              [](const Candidate &x, const Candidate &y) {
+                if (x.broken != y.broken) {
+                    return x.broken < y.broken;
+                }
+                return x.a != y.a ? x.a < y.a : x.b < y.b;
+            });
+            order.resize(options.branching);
+        }
+    }
+
+    const int blocksLeft = totalBlocks -
+            2 * static_cast<int>(state.line.size());
+    for (const Candidate &candidate: order) {
+        if (isExpired()) {
+            return;
+        }
+
+        // Score the move by playing it on the board only, and asking the
+        // indices what they would look like.
+        const int x = candidate.a;
+        const int y = candidate.b;
+        const Cell a = state.board.cellAt(x);
+        const Cell b = state.board.cellAt(y);
+        const BlockContent bc = state.board.content(a.r, a.c);
+        state.board.clearCell(a.r, a.c);
+        state.board.clearCell(b.r, b.c);
+        const int pairs = state.pairs.countAfterRemoving(a, b);
+        const int regions = state.regions.countAfterRemoving(a, b);
+        state.board.setCell(a.r, a.c, BlockType::kBlock, bc);
+        state.board.setCell(b.r, b.c, BlockType::kBlock, bc);
+
+        Child child;
+        child.score = static_cast<long long>(options.pairWeight) * pairs -
+                static_cast<long long>(options.regionWeight) * regions;
+        child.hash = state.hash ^ keys[x] ^ keys[y];
+        child.parent = parent;
+        child.a = x;
+        child.b = y;
+        child.dead = !pairs && blocksLeft > 2;
+        found[worker].push_back(child);
+    }
+}
+
+bool BeamSolver::isExpired() const
+{
+    return hasDeadline && std::chrono::steady_clock::now() >= deadline;
+}
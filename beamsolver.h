@@ -0,0 +1,134 @@
+#ifndef BEAMSOLVER_H
+#define BEAMSOLVER_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "pairindex.h"
+#include "regionindex.h"
+#include "taskpool.h"
+
+struct BeamOptions {
+    // Number of positions kept per layer.
+    int width = 8;
+
+    // Moves scored per position, the ones that break up the fewest other
+    // pairs first. 0 scores every move.
+    int branching = 8;
+
+    // Give up after this many milliseconds, 0 for no limit.
+    int maxMillis = 0;
+
+    // A position scores <pairWeight> for each legal pair, and loses
+    // <regionWeight> for each walkable region.
+    int pairWeight = 4;
+    int regionWeight = 1;
+};
+
+struct BeamResult {
+    // True if <moves> clears the board.
+    bool cleared = false;
+
+    // True if the deadline expired before the search finished.
+    bool timedOut = false;
+
+    // The deepest line of eliminations found, the whole clearing if
+    // <cleared>.
+    std::vector<std::pair<Cell, Cell>> moves;
+
+    // Blocks left on the board after <moves>.
+    int blocksLeft = 0;
+
+    // Positions expanded and scored moves.
+    uint64_t expanded = 0;
+    uint64_t scored = 0;
+
+    double seconds = 0;
+};
+
+// Anytime solver for boards too large for the exact Solver. Each layer of the
+// search plays one more pair. The best positions of a layer are kept, and all
+// of their moves are scored to pick the next layer. Positions are expanded in
+// parallel on a TaskPool.
+//
+// A move is scored by the number of legal pairs and the number of walkable
+// regions of the position it leads to. Both counts are derived from
+// incremental PairIndex and RegionIndex updates, without copying the
+// position. Positions reached twice are merged by their Zobrist hash.
+//
+// Unlike the exact solver, failing to clear a board proves nothing.
+class BeamSolver {
+public:
+    // Use <workers> threads, or one per hardware thread if <workers> is 0.
+    BeamSolver(const int workers = 0);
+
+    // Search for a way to clear <board> with links of at most <maxTurns>
+    // turns. Returns the deepest line found when the deadline expires.
+    BeamResult solve(const Board &board, const int maxTurns,
+                     const BeamOptions &options = BeamOptions());
+
+private:
+    // A position of the search, along with its indices.
+    struct State {
+        Board board;
+        PairIndex pairs;
+        RegionIndex regions;
+
+        // Eliminations that lead here from the root, as flat indices.
+        std::vector<std::pair<int, int>> line;
+
+        uint64_t hash = 0;
+    };
+
+    // A scored move out of the state at position <parent> of the beam.
+    struct Child {
+        long long score;
+        uint64_t hash;
+        int parent;
+        int a;
+        int b;
+        bool dead;
+    };
+
+    // A move to score, with the number of other pairs it breaks up.
+    struct Candidate {
+        int broken;
+        int a;
+        int b;
+    };
+
+    TaskPool pool;
+
+    std::vector<std::unique_ptr<State>> beam;
+    std::vector<std::unique_ptr<State>> next;
+
+    // Children found by each worker, and all of them merged.
+    std::vector<std::vector<Child>> found;
+    std::vector<Child> children;
+
+    // Moves of the position being expanded by each worker.
+    std::vector<std::vector<Candidate>> ranked;
+
+    // Zobrist key of each flat index.
+    std::vector<uint64_t> keys;
+
+    // Blocks on the board being solved.
+    int totalBlocks;
+
+    bool hasDeadline;
+    std::chrono::steady_clock::time_point deadline;
+
+    // Copy <from> into <to>, pointing the indices of <to> at its own board.
+    static void copyState(const State &from, State &to);
+
+    // Score the moves of <state> into the children found by <worker>.
+    void expand(State &state, const int parent, const BeamOptions &options,
+                const int worker);
+
+    bool isExpired() const;
+};
+
+#endif // BEAMSOLVER_H
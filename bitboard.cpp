@@ -0,0 +1,71 @@
+#include "bitboard.h"
+
+#include <algorithm>
+
+BitBoard::BitBoard(const int rows, const int cols)
+{
+    reset(rows, cols);
+}
+
+void BitBoard::reset(const int rows, const int cols)
+{
+    this->nRows = rows;
+    this->nCols = cols;
+    this->rowWords = (cols + kWordBits - 1) / kWordBits;
+    this->colWords = (rows + kWordBits - 1) / kWordBits;
+    rowBits.assign(rows * rowWords, 0);
+    colBits.assign(cols * colWords, 0);
+}
+
+void BitBoard::set(const int r, const int c, const bool occupied)
+{
+    const Word rowMask = Word(1) << (c % kWordBits);
+    const Word colMask = Word(1) << (r % kWordBits);
+    Word &rowWord = rowBits[r * rowWords + c / kWordBits];
+    Word &colWord = colBits[c * colWords + r / kWordBits];
+    if (occupied) {
+        rowWord |= rowMask;
+        colWord |= colMask;
+    } else {
+        rowWord &= ~rowMask;
+        colWord &= ~colMask;
+    }
+}
+
+bool BitBoard::test(const int r, const int c) const
+{
+    return (rowBits[r * rowWords + c / kWordBits] >> (c % kWordBits)) & 1;
+}
+
+bool BitBoard::rowClear(const int r, const int c1, const int c2) const
+{
+    return rangeClear(&rowBits[r * rowWords], std::min(c1, c2),
+                      std::max(c1, c2));
+}
+
+bool BitBoard::colClear(const int c, const int r1, const int r2) const
+{
+    return rangeClear(&colBits[c * colWords], std::min(r1, r2),
+                      std::max(r1, r2));
+}
+
+bool BitBoard::rangeClear(const Word *bits, int lo, int hi)
+{
+    const int loWord = lo / kWordBits;
+    const int hiWord = hi / kWordBits;
+    const Word loMask = ~Word(0) << (lo % kWordBits);
+    const Word hiMask = ~Word(0) >> (kWordBits - 1 - hi % kWordBits);
+
+    if (loWord == hiWord) {
+        return !(bits[loWord] & loMask & hiMask);
+    }
+    if (bits[loWord] & loMask) {
+        return false;
+    }
+    for (int w = loWord + 1; w < hiWord; ++w) {
+        if (bits[w]) {
+            return false;
+        }
+    }
+    return !(bits[hiWord] & hiMask);
+}
@@ -0,0 +1,50 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+#include <vector>
+
+// Occupancy of the map stored twice, once as one bit set per row and once as
+// one bit set per column, so that "is this part of a row or column empty" is a
+// couple of mask operations instead of a walk over the cells. Boards of up to
+// 64 columns (rows) fit a row (column) into a single word.
+class BitBoard {
+public:
+    BitBoard(const int rows = 0, const int cols = 0);
+
+    // Resize to <rows> x <cols> and mark every cell as free.
+    void reset(const int rows, const int cols);
+
+    // Mark the cell at row <r>, column <c> as occupied or free.
+    void set(const int r, const int c, const bool occupied);
+
+    // Returns true if the cell at row <r>, column <c> is occupied.
+    bool test(const int r, const int c) const;
+
+    // Returns true if no cell of row <r> between columns <c1> and <c2>, both
+    // inclusive and in any order, is occupied.
+    bool rowClear(const int r, const int c1, const int c2) const;
+
+    // Returns true if no cell of column <c> between rows <r1> and <r2>, both
+    // inclusive and in any order, is occupied.
+    bool colClear(const int c, const int r1, const int r2) const;
+
+private:
+    typedef uint64_t Word;
+    static const int kWordBits = 64;
+
+    int nRows;
+    int nCols;
+
+    // Number of words that one row (column) takes.
+    int rowWords;
+    int colWords;
+
+    std::vector<Word> rowBits;
+    std::vector<Word> colBits;
+
+    // Primitive on a single bit set, shared by rows and columns.
+    static bool rangeClear(const Word *bits, int lo, int hi);
+};
+
+#endif // BITBOARD_H
@@ -15,44 +15,6 @@ Block::Block(const int r, const int c, const bool markedAsHint,
 
 }
 
-Block * Block::fromTextStream(QTextStream &s) {
-    int r;
-    int c;
-    int markedAsHint;
-    int t;
-    int bc;
-    int p;
-    Block *b;
-    s >> r >> c >> markedAsHint >> t >> bc >> p;
-    b = new Block(r, c, markedAsHint, static_cast<BlockType>(t), bc,
-                  static_cast<WhichPlayer>(p), nullptr);
-    return b;
-}
-
-bool Block::isEmpty() const
-{
-    return t == BlockType::kEmpty;
-}
-
-bool Block::isBlock() const
-{
-    return t == BlockType::kBlock;
-}
-
-bool Block::isChosen() const
-{
-    return p != WhichPlayer::kNoPlayer;
-}
-
-bool Block::isInItemRange(const int x, const int y) const {
-    const auto &g = this->geometry();
-    return t == BlockType::kItem &&
-           QRect(g.center().x() - (kItemSize >> 1),
-                 g.center().y() - (kItemSize >> 1),
-                 kItemSize,
-                 kItemSize).contains(x, y);
-}
-
 int Block::row() const
 {
     return this->r;
@@ -77,39 +39,19 @@ WhichPlayer Block::chosenBy() const
     return this->p;
 }
 
-int Block::boundary(const Direction d) const
-{
-    auto &g = this->geometry();
-    switch (d) {
-    case Direction::kUp:
-        return g.top();
-    case Direction::kDown:
-        return g.bottom();
-    case Direction::kLeft:
-        return g.left();
-    case Direction::kRight:
-        return g.right();
-    }
-}
-
 void Block::setPosition(const int r, const int c)
 {
     this->r = r;
     this->c = c;
 }
 
-void Block::setChosenBy(const WhichPlayer p)
+void Block::setState(const BlockType t, const BlockContent bc,
+                     const WhichPlayer p, const bool markedAsHint)
 {
+    this->t = t;
+    this->bc = bc;
     this->p = p;
-    this->update();
-}
-
-void Block::eliminateSelf()
-{
-    this->markedAsHint = false;
-    this->p = WhichPlayer::kNoPlayer;
-    this->bc = kEmptyBlock;
-    this->t = BlockType::kEmpty;
+    this->markedAsHint = markedAsHint;
     this->update();
 }
 
@@ -160,45 +102,7 @@ void Block::paintEvent(QPaintEvent *event)
     // Do nothing if it is empty.
 }
 
-void Block::spawnItem(const ItemType type)
-{
-    this->markedAsHint = false;
-    this->t = BlockType::kItem;
-    this->bc = type;
-    this->update();
-}
-
-void Block::consumeItem() {
-    this->markedAsHint = false;
-    this->p = WhichPlayer::kNoPlayer;
-    this->t = BlockType::kEmpty;
-    this->bc = kEmptyBlock;
-    this->update();
-}
-
-void Block::markAsHint() {
-    this->markedAsHint = true;
-    this->update();
-}
-
-void Block::unmarkAsHint() {
-    this->markedAsHint = false;
-    try {
-        this->update();
-    }  catch (...) {
-        return;
-    }
-}
-
 QDebug operator<<(QDebug dbg, const Block &b) {
     dbg << b.r << b.c << b.markedAsHint << b.t << b.bc << b.p;
     return dbg;
 }
-
-QTextStream &operator<<(QTextStream &ds, const Block &b)
-{
-    ds << b.r << ' ' << b.c << ' ' << b.markedAsHint << ' ' << b.t << ' '
-       << b.bc << ' ' << b.p;
-    return ds;
-}
-
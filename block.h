@@ -2,18 +2,13 @@
 #define BLOCK_H
 
 #include "includes.h"
+#include "gameengine.h"
 #include "types.h"
 
-class GameWindow;
-class UnitTest;
-
-// The basic element that constitutes the map. Manages both the logic and ui of
-// map unit operations.
+// A cell of the map as shown in the game window, holding a copy of the state
+// of its cell in the `GameEngine`.
 class Block: public QPushButton {
-    friend class UnitTest;
-    friend class GameWindow;
     friend QDebug operator<<(QDebug dbg, const Block &b);
-    friend QTextStream &operator<<(QTextStream &ds, const Block &b);
 
 private:
     // Row of this block in the map.
@@ -38,7 +33,7 @@ private:
 
 public:
     static const BlockContent kEmptyBlock = 0;
-    static const int kItemSize = 20;
+    static const int kItemSize = GameEngine::kItemSize;
     static const QMap<WhichPlayer, QColor> kHighlightColor;
 
     Block(const int r,
@@ -48,20 +43,6 @@ public:
           const BlockContent bc = Block::kEmptyBlock,
           const WhichPlayer p = WhichPlayer::kNoPlayer,
           QWidget *parent = nullptr);
-    static Block * fromTextStream(QTextStream &s);
-
-    // Returns true only if this block is neither block (type) or item.
-    bool isEmpty() const;
-
-    // Returns true only if this block is block (type).
-    bool isBlock() const;
-
-    // Returns true only if this block is chosen by player 1 or player 2.
-    bool isChosen() const;
-
-    // Return true only if given point (x, y) in in the geometric range of the item
-    // drawn on this block.
-    bool isInItemRange(const int x, const int y) const;
 
     // Returns r member.
     int row() const;
@@ -78,32 +59,13 @@ public:
     // Returns p member.
     WhichPlayer chosenBy() const;
 
-    // A wrapping function for geometry().left()/right()/top()/bottom() that
-    // accepts custom Direction type as argument.
-    int boundary(const Direction) const;
-
     // Sets the row and column of this block in block map.
     void setPosition(const int r, const int c);
 
-    // Sets the p field.
-    void setChosenBy(const WhichPlayer p);
-
-    // Mark this block as empty, clear its contents.
-    void eliminateSelf();
-
-    // Mark this block as item, given the item type.
-    void spawnItem(const ItemType type);
-
-    // Just an alias for eliminate self for readability.
-    void consumeItem();
-
-    // Mark this block as being highlighted for hint, main purpose is to
-    // encapsulate invocation of update().
-    void markAsHint();
-
-    // Mark this block as not being highlighted for hint, main purpose is to
-    // encapsulate invocation of update().
-    void unmarkAsHint();
+    // Show type <t> and content <bc>, chosen by player <p> and highlighted as
+    // hint if <markedAsHint>.
+    void setState(const BlockType t, const BlockContent bc,
+                  const WhichPlayer p, const bool markedAsHint);
 
 protected:
     // Draw the widget depending on the combination of its fields.
@@ -0,0 +1,264 @@
+#include "board.h"
+
+#include <cassert>
+#include <sstream>
+
+namespace {
+
+const char kAsciiBlocks[] =
+        "123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+}
+
+Board::Board(const int rows, const int cols): routeBorder(false),
+    updating(false)
+{
+    reset(rows, cols);
+}
+
+void Board::reset(const int rows, const int cols)
+{
+    this->nRows = rows;
+    this->nCols = cols;
+    this->nStride = cols + 2 * kPadding;
+
+    const int n = (rows + 2 * kPadding) * nStride;
+    types.assign(n, BlockType::kEmpty);
+    contents.assign(n, 0);
+
+    // Everything is a wall until proven to be inside the map.
+    obstacles.assign(n, 1);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            obstacles[index(r, c)] = 0;
+        }
+    }
+    linkObstacles = obstacles;
+    if (routeBorder) {
+        setLane(0);
+    }
+    bits.reset(rows, cols);
+    blockContents.assign(n, 0);
+    if (!updating) {
+        nearest.rebuild(*this);
+        buckets.rebuild(blockContents.data(), n);
+    }
+}
+
+void Board::setBorderRouting(const bool enabled)
+{
+    if (routeBorder == enabled) {
+        return;
+    }
+    this->routeBorder = enabled;
+    setLane(enabled ? 0 : 1);
+    if (!updating) {
+        nearest.rebuild(*this);
+    }
+}
+
+bool Board::borderRouting() const
+{
+    return this->routeBorder;
+}
+
+void Board::setLane(const uint8_t obstacle)
+{
+    for (int c = -1; c <= nCols; ++c) {
+        linkObstacles[index(-1, c)] = obstacle;
+        linkObstacles[index(nRows, c)] = obstacle;
+    }
+    for (int r = 0; r < nRows; ++r) {
+        linkObstacles[index(r, -1)] = obstacle;
+        linkObstacles[index(r, nCols)] = obstacle;
+    }
+}
+
+void Board::beginUpdate()
+{
+    this->updating = true;
+}
+
+void Board::endUpdate()
+{
+    this->updating = false;
+    nearest.rebuild(*this);
+    buckets.rebuild(blockContents.data(), size());
+}
+
+int Board::rows() const
+{
+    return this->nRows;
+}
+
+int Board::cols() const
+{
+    return this->nCols;
+}
+
+int Board::stride() const
+{
+    return this->nStride;
+}
+
+int Board::size() const
+{
+    return static_cast<int>(obstacles.size());
+}
+
+int Board::index(const Cell &cell) const
+{
+    return index(cell.r, cell.c);
+}
+
+Cell Board::cellAt(const int idx) const
+{
+    return { idx / nStride - kPadding, idx % nStride - kPadding };
+}
+
+int Board::offset(const Direction d) const
+{
+    switch (d) {
+    case Direction::kUp:
+        return -nStride;
+    case Direction::kDown:
+        return nStride;
+    case Direction::kLeft:
+        return -1;
+    case Direction::kRight:
+        return 1;
+    }
+    return 0;
+}
+
+BlockType Board::type(const int r, const int c) const
+{
+    return static_cast<BlockType>(types[index(r, c)]);
+}
+
+BlockContent Board::content(const int r, const int c) const
+{
+    return contents[index(r, c)];
+}
+
+void Board::setCell(const int r, const int c, const BlockType t,
+                    const BlockContent bc)
+{
+    const int idx = index(r, c);
+    const bool obstacle = (t == BlockType::kBlock);
+    const uint8_t newBlockContent = obstacle ? bc : 0;
+    assert(!obstacle || (bc > 0 && bc <= UINT8_MAX));
+    types[idx] = t;
+    contents[idx] = bc;
+
+    if (blockContents[idx] != newBlockContent) {
+        if (!updating && blockContents[idx]) {
+            buckets.erase(idx, blockContents[idx]);
+        }
+        if (!updating && newBlockContent) {
+            buckets.insert(idx, newBlockContent);
+        }
+        blockContents[idx] = newBlockContent;
+    }
+
+    // Items do not obstruct links, so only blocks coming and going need the
+    // obstacle indices to be updated.
+    if (obstacles[idx] != obstacle) {
+        obstacles[idx] = obstacle;
+        linkObstacles[idx] = obstacle;
+        bits.set(r, c, obstacle);
+        if (!updating) {
+            nearest.update(*this, r, c);
+        }
+    }
+}
+
+void Board::clearCell(const int r, const int c)
+{
+    setCell(r, c, BlockType::kEmpty, 0);
+}
+
+const BitBoard &Board::occupancy() const
+{
+    return this->bits;
+}
+
+const std::vector<int> &Board::blocksOf(const BlockContent bc) const
+{
+    return buckets.bucket(bc);
+}
+
+int Board::contentLimit() const
+{
+    return buckets.bucketCount();
+}
+
+std::string Board::toAscii() const
+{
+    std::string text;
+    text.reserve((nCols + 1) * nRows);
+    for (int r = 0; r < nRows; ++r) {
+        for (int c = 0; c < nCols; ++c) {
+            switch (type(r, c)) {
+            case BlockType::kBlock:
+                assert(content(r, c) <= kMaxAsciiContent);
+                text += kAsciiBlocks[content(r, c) - 1];
+                break;
+            case BlockType::kItem:
+                text += '*';
+                break;
+            default:
+                text += '.';
+                break;
+            }
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+bool Board::fromAscii(const std::string &text)
+{
+    std::istringstream s(text);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(s, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (!lines.empty() && line.size() != lines[0].size()) {
+            return false;
+        }
+        for (const char ch: line) {
+            if (ch != '.' && ch != '*' &&
+                !std::char_traits<char>::find(kAsciiBlocks,
+                                              kMaxAsciiContent, ch)) {
+                return false;
+            }
+        }
+        lines.push_back(line);
+    }
+
+    const int rows = static_cast<int>(lines.size());
+    const int cols = rows ? static_cast<int>(lines[0].size()) : 0;
+    beginUpdate();
+    reset(rows, cols);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            const char ch = lines[r][c];
+            if (ch == '*') {
+                setCell(r, c, BlockType::kItem, 0);
+            } else if (ch != '.') {
+                const char *pos = std::char_traits<char>::find(
+                            kAsciiBlocks, kMaxAsciiContent, ch);
+                setCell(r, c, BlockType::kBlock,
+                        static_cast<int>(pos - kAsciiBlocks) + 1);
+            }
+        }
+    }
+    endUpdate();
+    return true;
+}
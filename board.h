@@ -0,0 +1,193 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bitboard.h"
+#include "contentbuckets.h"
+#include "obstacletable.h"
+#include "types.h"
+
+// Row and column of a cell in the map.
+struct Cell {
+    int r;
+    int c;
+};
+
+// A path that connects two blocks, described by its corners. The first and the
+// last element are the two blocks themselves, so a path with n turns has n + 2
+// corners.
+typedef std::vector<Cell> LinkPath;
+
+// Headless model of the map that the game logic runs on. It does not know about
+// widgets, so it can be copied, searched and tested without a display.
+// Cells are stored row-major in flat arrays that are surrounded by a ring of
+// wall cells, so that a search can step off any cell without checking bounds.
+// Between the map and the wall runs a lane of border cells, rows -1 and
+// `rows()` and columns -1 and `cols()`. Players never walk there, and links
+// only pass through it in border routing mode.
+class Board {
+public:
+    // Width of the border lane and the wall ring around the map.
+    static const int kPadding = 2;
+
+    // Number of distinct block contents `toAscii` can write.
+    static const int kMaxAsciiContent = 61;
+
+    Board(const int rows = 0, const int cols = 0);
+
+    // Resize the board to <rows> x <cols> and mark every cell as empty. The
+    // routing mode is kept.
+    void reset(const int rows, const int cols);
+
+    // Let links run through the border lane around the map, as in the
+    // classic game, or keep them inside the map.
+    void setBorderRouting(const bool enabled);
+    bool borderRouting() const;
+
+    // Bracket a bulk change, such as loading a whole map. In between, `setCell`
+    // skips the incremental maintenance of the derived indices, which are
+    // rebuilt in one pass by `endUpdate`.
+    void beginUpdate();
+    void endUpdate();
+
+    // Returns the number of rows and columns of the map, padding excluded.
+    int rows() const;
+    int cols() const;
+
+    // Number of cells in one padded row, which is also the offset between the
+    // flat indices of two vertically adjacent cells.
+    int stride() const;
+
+    // Number of cells in the padded arrays.
+    int size() const;
+
+    // Flat index of the cell at row <r>, column <c>.
+    int index(const int r, const int c) const;
+    int index(const Cell &cell) const;
+
+    // Row and column of the cell with flat index <idx>.
+    Cell cellAt(const int idx) const;
+
+    // Offset between the flat index of a cell and that of its neighbour in
+    // direction <d>.
+    int offset(const Direction d) const;
+
+    BlockType type(const int r, const int c) const;
+    BlockContent content(const int r, const int c) const;
+
+    // Returns true if a player cannot walk on the cell with flat index <idx>,
+    // i.e. the cell holds a block or lies outside the map. Items are walked
+    // over.
+    bool isObstacle(const int idx) const;
+
+    // Returns true if a link cannot pass through the cell with flat index
+    // <idx>. Same as `isObstacle`, except that the border lane is open in
+    // border routing mode.
+    bool isLinkObstacle(const int idx) const;
+
+    // Returns true if the cell with flat index <idx> holds a block.
+    bool isBlock(const int idx) const;
+
+    // Set type and content of the cell at row <r>, column <c>.
+    void setCell(const int r, const int c, const BlockType t,
+                 const BlockContent bc);
+
+    // Mark the cell at row <r>, column <c> as empty.
+    void clearCell(const int r, const int c);
+
+    // Row and column bit sets of the cells that links cannot pass through.
+    const BitBoard &occupancy() const;
+
+    // Flat indices of the blocks with content <bc>, in no particular order.
+    const std::vector<int> &blocksOf(const BlockContent bc) const;
+
+    // One more than the largest content `blocksOf` accepts.
+    int contentLimit() const;
+
+    // Steps from the cell with flat index <idx> to the nearest link obstacle
+    // in direction <d>. 1 means that the neighbour is one. Defined for the
+    // cells of the map and of the border lane.
+    int obstacleDistance(const int idx, const Direction d) const;
+
+    // Text form of the board for tools and test output, one line per row:
+    // '.' is an empty cell, '*' an item, and blocks of content 1 to 61 are
+    // written as '1' to '9', 'a' to 'z' and 'A' to 'Z'.
+    std::string toAscii() const;
+
+    // Replace the board with the one described by <text>, in the form written
+    // by `toAscii`. Returns false, leaving the board untouched, if <text> is
+    // not a rectangle of known characters.
+    bool fromAscii(const std::string &text);
+
+private:
+    int nRows;
+    int nCols;
+    int nStride;
+
+    // BlockType of each padded cell.
+    std::vector<uint8_t> types;
+
+    // BlockContent of each padded cell.
+    std::vector<BlockContent> contents;
+
+    // 1 for cells that players cannot walk on, including the border lane and
+    // the wall ring.
+    std::vector<uint8_t> obstacles;
+
+    // 1 for cells that links cannot pass through. Differs from <obstacles>
+    // only on the border lane.
+    std::vector<uint8_t> linkObstacles;
+
+    // True in border routing mode.
+    bool routeBorder;
+
+    // Same as <obstacles>, restricted to the map, packed into bit sets.
+    BitBoard bits;
+
+    // Distance from every cell to the nearest obstacle in each direction.
+    ObstacleTable nearest;
+
+    // Content of the block in each padded cell, 0 if there is none. Kept
+    // narrow so that `buckets` can be rebuilt by a vectorized scan.
+    std::vector<uint8_t> blockContents;
+
+    // Blocks grouped by content.
+    ContentBuckets buckets;
+
+    // True between `beginUpdate` and `endUpdate`.
+    bool updating;
+
+    // Mark every cell of the border lane in <linkObstacles>.
+    void setLane(const uint8_t obstacle);
+};
+
+// Queried in the inner loop of every link search, so it lives in the header.
+inline bool Board::isObstacle(const int idx) const
+{
+    return obstacles[idx];
+}
+
+inline bool Board::isLinkObstacle(const int idx) const
+{
+    return linkObstacles[idx];
+}
+
+inline bool Board::isBlock(const int idx) const
+{
+    return types[idx] == BlockType::kBlock;
+}
+
+inline int Board::obstacleDistance(const int idx, const Direction d) const
+{
+    return nearest.distance(idx, d);
+}
+
+inline int Board::index(const int r, const int c) const
+{
+    return (r + kPadding) * nStride + c + kPadding;
+}
+
+#endif // BOARD_H
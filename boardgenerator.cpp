@@ -0,0 +1,239 @@
+#include "boardgenerator.h"
+
+#include <algorithm>
+#include <cassert>
+
+BoardGenerator::BoardGenerator()
+{
+
+}
+
+GeneratorResult BoardGenerator::generate(Board *board, const uint64_t seed,
+                                         const GeneratorOptions &options)
+{
+    assert(options.blocks % 2 == 0 && options.blocksPerType % 2 == 0);
+    assert(options.players >= 1);
+    GeneratorResult result;
+    rng.seed(seed);
+    checker.setBoard(board);
+    checker.setTurnLimit(options.maxTurns);
+    if (options.rows * options.cols < options.blocks + options.players) {
+        board->reset(options.rows, options.cols);
+        return result;
+    }
+
+    // Placing pairs greedily can paint itself into a corner, mostly with few
+    // turns. Start over from the state the random engine is in, so that the
+    // seed still decides the board.
+    for (int i = 0; i < kMaxAttempts && !result.complete; ++i) {
+        result = attempt(board, options);
+    }
+    return result;
+}
+
+GeneratorResult BoardGenerator::attempt(Board *board,
+                                        const GeneratorOptions &options)
+{
+    GeneratorResult result;
+    board->reset(options.rows, options.cols);
+
+    // Players do not start along the edge, unless the map is too thin.
+    const bool thin = options.rows < 3 || options.cols < 3 ||
+            (options.rows - 2) * (options.cols - 2) < options.players;
+    const int margin = thin ? 0 : 1;
+    const uint64_t spawnRows = options.rows - 2 * margin;
+    const uint64_t spawnCols = options.cols - 2 * margin;
+    while (static_cast<int>(result.spawns.size()) < options.players) {
+        const Cell cell = { margin + static_cast<int>(rng.below(spawnRows)),
+                            margin + static_cast<int>(rng.below(spawnCols)) };
+        if (std::none_of(result.spawns.begin(), result.spawns.end(),
+                         [&](const Cell &spawn) {
+                             return spawn.r == cell.r && spawn.c == cell.c;
+                         })) {
+            result.spawns.push_back(cell);
+        }
+    }
+
+    buildTree(*board, board->index(result.spawns[0]));
+    for (const Cell &spawn: result.spawns) {
+        reserved[board->index(spawn)] = 1;
+        if (leafPos[board->index(spawn)] >= 0) {
+            removeLeaf(board->index(spawn));
+        }
+    }
+
+    // Contents are dealt to the pairs in random order, so that each content
+    // ends up on <blocksPerType> blocks.
+    const int nPairs = options.blocks / 2;
+    std::vector<BlockContent> contents(nPairs);
+    for (int i = 0; i < nPairs; ++i) {
+        contents[i] = i / (options.blocksPerType / 2) + 1;
+    }
+    rng.shuffle(&contents);
+
+    int failures = 0;
+    while (static_cast<int>(result.order.size()) < nPairs &&
+           leaves.size() >= 2) {
+        const int a = leaves[rng.below(leaves.size())];
+        const int parent = fill(a);
+
+        // The parent of <a> must stay empty when <a> is taken away, or <a>
+        // might not be walked up to.
+        const int b = findPartner(*board, a, parent);
+        if (b < 0) {
+            unfill(a, parent);
+            if (++failures > kMaxFailures) {
+                break;
+            }
+            continue;
+        }
+        failures = 0;
+        fill(b);
+
+        const Cell cellA = board->cellAt(a);
+        const Cell cellB = board->cellAt(b);
+        const BlockContent bc = contents[result.order.size()];
+        board->setCell(cellA.r, cellA.c, BlockType::kBlock, bc);
+        board->setCell(cellB.r, cellB.c, BlockType::kBlock, bc);
+        result.order.emplace_back(cellA, cellB);
+    }
+
+    // The last pair placed is the first to take away.
+    std::reverse(result.order.begin(), result.order.end());
+    result.complete = static_cast<int>(result.order.size()) == nPairs;
+    return result;
+}
+
+void BoardGenerator::buildTree(const Board &board, const int root)
+{
+    const int n = board.size();
+    parents.assign(n, -1);
+    children.assign(n, 0);
+    reserved.assign(n, 0);
+    leaves.clear();
+    leafPos.assign(n, -1);
+
+    // Randomized Prim: grow the tree by a random edge out of it at a time.
+    // Unlike a breadth first tree, this leaves dead ends all over the map,
+    // so blocks do not pile up far from the root.
+    std::vector<uint8_t> inTree(n, 0);
+    std::vector<std::pair<int, int>> edges;
+    std::vector<int> order;
+    order.reserve(n);
+    const int steps[] = {
+        board.offset(Direction::kUp),
+        board.offset(Direction::kDown),
+        board.offset(Direction::kLeft),
+        board.offset(Direction::kRight)
+    };
+    auto grow = [&](const int idx, const int parent) {
+        inTree[idx] = 1;
+        parents[idx] = parent;
+        if (parent >= 0) {
+            ++children[parent];
+        }
+        order.push_back(idx);
+        for (const int step: steps) {
+            if (!inTree[idx + step] && !board.isObstacle(idx + step)) {
+                edges.emplace_back(idx + step, idx);
+            }
+        }
+    };
+
+    grow(root, -1);
+    while (!edges.empty()) {
+        const size_t i = rng.below(edges.size());
+        const std::pair<int, int> edge = edges[i];
+        edges[i] = edges.back();
+        edges.pop_back();
+        if (!inTree[edge.first]) {
+            grow(edge.first, edge.second);
+        }
+    }
+    for (const int idx: order) {
+        if (!children[idx]) {
+            addLeaf(idx);
+        }
+    }
+}
+
+void BoardGenerator::addLeaf(const int idx)
+{
+    leafPos[idx] = static_cast<int>(leaves.size());
+    leaves.push_back(idx);
+}
+
+void BoardGenerator::removeLeaf(const int idx)
+{
+    const int pos = leafPos[idx];
+    leaves[pos] = leaves.back();
+    leafPos[leaves[pos]] = pos;
+    leaves.pop_back();
+    leafPos[idx] = -1;
+}
+
+int BoardGenerator::fill(const int idx)
+{
+    removeLeaf(idx);
+    const int parent = parents[idx];
+    if (parent >= 0 && !--children[parent] && !reserved[parent]) {
+        addLeaf(parent);
+        return parent;
+    }
+    return -1;
+}
+
+void BoardGenerator::unfill(const int idx, const int parent)
+{
+    if (parents[idx] >= 0) {
+        ++children[parents[idx]];
+    }
+    if (parent >= 0) {
+        removeLeaf(parent);
+    }
+    addLeaf(idx);
+}
+
+int BoardGenerator::findPartner(const Board &board, const int a,
+                                const int excluded)
+{
+    if (leaves.empty()) {
+        return -1;
+    }
+    const Cell from = board.cellAt(a);
+    const uint64_t span = 2 * kPartnerRadius + 1;
+
+    // Alternate between partners nearby, which are likely to link on a
+    // crowded board, and anywhere, which keeps pairs from clustering.
+    for (int i = 0; i < kPartnerTrials; ++i) {
+        int b;
+        if (i & 1) {
+            b = leaves[rng.below(leaves.size())];
+        } else {
+            const int dr = static_cast<int>(rng.below(span)) - kPartnerRadius;
+            const int dc = static_cast<int>(rng.below(span)) - kPartnerRadius;
+            const Cell cell = { from.r + dr, from.c + dc };
+            if (cell.r < 0 || cell.r >= board.rows() ||
+                cell.c < 0 || cell.c >= board.cols()) {
+                continue;
+            }
+            b = board.index(cell);
+            if (leafPos[b] < 0) {
+                continue;
+            }
+        }
+        if (b != excluded && checker.link(from, board.cellAt(b), nullptr)) {
+            return b;
+        }
+    }
+
+    // Fall back to every leaf that <a> can be linked to.
+    checker.connectAll(from, checker.turnLimit(), nullptr);
+    std::vector<int> reached;
+    for (const int b: leaves) {
+        if (b != excluded && checker.isReached(board.cellAt(b))) {
+            reached.push_back(b);
+        }
+    }
+    return reached.empty() ? -1 : reached[rng.below(reached.size())];
+}
@@ -0,0 +1,114 @@
+#ifndef BOARDGENERATOR_H
+#define BOARDGENERATOR_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "linkchecker.h"
+#include "xoshiro256.h"
+
+struct GeneratorOptions {
+    // Size of the map.
+    int rows = 0;
+    int cols = 0;
+
+    // Number of blocks, and of blocks that share a content. Both even.
+    int blocks = 0;
+    int blocksPerType = 2;
+
+    // Turns that a link of the clearing order may take.
+    int maxTurns = 2;
+
+    // Number of player spawn points to keep free.
+    int players = 1;
+};
+
+struct GeneratorResult {
+    // True if all blocks have been placed.
+    bool complete = false;
+
+    // Cells the players start on, away from the edge if the map allows.
+    std::vector<Cell> spawns;
+
+    // A way to clear the board: every pair can be linked, and walked up to
+    // from the spawn points, once the pairs before it are gone.
+    std::vector<std::pair<Cell, Cell>> order;
+};
+
+// Generates boards that can be cleared by construction, by playing a game
+// backwards: starting from an empty map, it keeps placing a pair of blocks
+// that can be linked on the board so far, until all blocks are placed. Taking
+// the pairs away in reverse order clears the board.
+//
+// Blocks must also stay within walking distance of the players. Cells are
+// filled along a random spanning tree of the map, rooted at the first spawn
+// point, and only cells with no empty children can be filled. The empty cells
+// then always form a subtree around the spawn points, so each block is next
+// to the region of the players when its pair is placed, and thus when it is
+// taken away.
+//
+// Partners of a block are tried near it and anywhere on the map, and only
+// when none can be linked does a full sweep of the cells it can link to run.
+// Each step is cheap, so boards of tens of thousands of cells generate in
+// well under a second.
+class BoardGenerator {
+public:
+    BoardGenerator();
+
+    // Replace <board> with a board generated from <seed>. The routing mode of
+    // <board> is kept. The same seed and options always give the same board.
+    // If the result is not complete, <board> holds the pairs that could be
+    // placed.
+    GeneratorResult generate(Board *board, const uint64_t seed,
+                             const GeneratorOptions &options);
+
+private:
+    // Partners tried for each block before falling back to a full sweep, and
+    // the distance up to which nearby partners are drawn.
+    static const int kPartnerTrials = 16;
+    static const int kPartnerRadius = 4;
+
+    // Blocks that may find no partner in a row before an attempt gives up,
+    // and attempts before `generate` does.
+    static const int kMaxFailures = 64;
+    static const int kMaxAttempts = 8;
+
+    Xoshiro256 rng;
+    LinkChecker checker;
+
+    // Parent of each flat index in the spanning tree, -1 for the root and
+    // cells outside the map, and the number of its children still empty.
+    std::vector<int> parents;
+    std::vector<int> children;
+
+    // 1 for spawn points, which are never filled.
+    std::vector<uint8_t> reserved;
+
+    // Empty cells without empty children, which can be filled next, and the
+    // position of each flat index in <leaves>, -1 if it is not a leaf.
+    std::vector<int> leaves;
+    std::vector<int> leafPos;
+
+    // Place spawn points and all pairs on <board> once.
+    GeneratorResult attempt(Board *board, const GeneratorOptions &options);
+
+    // Build a random spanning tree of the empty <board> from <root>.
+    void buildTree(const Board &board, const int root);
+
+    void addLeaf(const int idx);
+    void removeLeaf(const int idx);
+
+    // Take <idx> out of the tree, making its parent a leaf if it was the last
+    // empty child. Returns the parent if so, -1 otherwise.
+    int fill(const int idx);
+
+    // Undo `fill(idx)`, which returned <parent>.
+    void unfill(const int idx, const int parent);
+
+    // Returns a random leaf other than <excluded> that <a> can be linked
+    // to, or -1.
+    int findPartner(const Board &board, const int a, const int excluded);
+};
+
+#endif // BOARDGENERATOR_H
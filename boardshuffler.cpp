@@ -0,0 +1,203 @@
+#include "boardshuffler.h"
+
+#include <algorithm>
+#include <cassert>
+
+BoardShuffler::BoardShuffler()
+{
+
+}
+
+ShuffleResult BoardShuffler::shuffle(Board *board,
+                                     const std::vector<Cell> &players,
+                                     const std::vector<Cell> &pinned,
+                                     const int maxTurns, const uint64_t seed)
+{
+    const int rows = board->rows();
+    const int cols = board->cols();
+    rng.seed(seed);
+    checker.setBoard(board);
+    regions.setBoard(board);
+
+    std::vector<uint8_t> isPinned(rows * cols, 0);
+    for (const Cell &cell: pinned) {
+        assert(cell.r >= 0 && cell.r < rows && cell.c >= 0 && cell.c < cols);
+        isPinned[cell.r * cols + cell.c] = 1;
+    }
+    const Board before = *board;
+
+    ShuffleResult result;
+    while (result.attempts < kMaxAttempts && !result.playable) {
+        ++result.attempts;
+        deal(board, isPinned);
+        regions.rebuild();
+        result.playable = hasPlayablePair(*board, players, maxTurns);
+    }
+    if (!result.playable) {
+        result.repaired = repair(board, players, isPinned, maxTurns);
+        result.playable = result.repaired;
+    }
+
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (board->type(r, c) != before.type(r, c) ||
+                board->content(r, c) != before.content(r, c)) {
+                result.changed.push_back({ r, c });
+            }
+        }
+    }
+    return result;
+}
+
+void BoardShuffler::deal(Board *board, const std::vector<uint8_t> &isPinned)
+{
+    const int rows = board->rows();
+    const int cols = board->cols();
+    int pinnedCount = 0;
+    for (const uint8_t p: isPinned) {
+        pinnedCount += p;
+    }
+
+    // Drop an empty cell from the contents for every pinned cell, and deal
+    // the rest out to the cells that are not pinned. Pinned cells that no
+    // empty cell is left for keep taking part.
+    contents.clear();
+    cells.clear();
+    int dropped = 0;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            const BlockType t = board->type(r, c);
+            if (t == BlockType::kEmpty && dropped < pinnedCount) {
+                ++dropped;
+            } else {
+                contents.emplace_back(t, board->content(r, c));
+            }
+            if (!isPinned[r * cols + c]) {
+                cells.push_back({ r, c });
+            }
+        }
+    }
+    std::vector<Cell> cleared;
+    for (int i = 0, left = pinnedCount - dropped; i < rows * cols; ++i) {
+        if (isPinned[i]) {
+            if (left > 0) {
+                cells.push_back({ i / cols, i % cols });
+                --left;
+            } else {
+                cleared.push_back({ i / cols, i % cols });
+            }
+        }
+    }
+    assert(contents.size() == cells.size());
+    rng.shuffle(&contents);
+
+    board->beginUpdate();
+    for (size_t i = 0; i < cells.size(); ++i) {
+        board->setCell(cells[i].r, cells[i].c, contents[i].first,
+                       contents[i].second);
+    }
+    for (const Cell &cell: cleared) {
+        board->clearCell(cell.r, cell.c);
+    }
+    board->endUpdate();
+}
+
+bool BoardShuffler::hasPlayablePair(const Board &board,
+                                    const std::vector<Cell> &players,
+                                    const int maxTurns)
+{
+    for (const Cell &player: players) {
+        for (BlockContent bc = 1; bc < board.contentLimit(); ++bc) {
+            for (const int idx: board.blocksOf(bc)) {
+                const Cell a = board.cellAt(idx);
+                if (!regions.canReach(player, a)) {
+                    continue;
+                }
+                checker.connectAll(a, maxTurns, &partners);
+                for (const Cell &b: partners) {
+                    if (board.content(b.r, b.c) == bc &&
+                        regions.canReach(player, b)) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool BoardShuffler::repair(Board *board, const std::vector<Cell> &players,
+                           const std::vector<uint8_t> &isPinned,
+                           const int maxTurns)
+{
+    const int rows = board->rows();
+    const int cols = board->cols();
+
+    // Cells next to the ones the players stand on.
+    std::vector<Cell> around;
+    for (int i = 0; i < rows * cols; ++i) {
+        if (!isPinned[i]) {
+            continue;
+        }
+        const int r = i / cols;
+        const int c = i % cols;
+        const Cell next[] = { { r - 1, c }, { r + 1, c },
+                              { r, c - 1 }, { r, c + 1 } };
+        for (const Cell &cell: next) {
+            if (cell.r >= 0 && cell.r < rows && cell.c >= 0 && cell.c < cols &&
+                !isPinned[cell.r * cols + cell.c] &&
+                std::find_if(around.begin(), around.end(), [&](const Cell &x) {
+                    return x.r == cell.r && x.c == cell.c;
+                }) == around.end()) {
+                around.push_back(cell);
+            }
+        }
+    }
+
+    // Any content with two blocks will do.
+    BlockContent bc = 0;
+    for (BlockContent k = 1; k < board->contentLimit() && !bc; ++k) {
+        if (board->blocksOf(k).size() >= 2) {
+            bc = k;
+        }
+    }
+    if (!bc) {
+        return false;
+    }
+
+    for (size_t i = 0; i < around.size(); ++i) {
+        for (size_t j = i + 1; j < around.size(); ++j) {
+            const Cell &x = around[i];
+            const Cell &y = around[j];
+            Cell a = board->cellAt(board->blocksOf(bc)[0]);
+            Cell b = board->cellAt(board->blocksOf(bc)[1]);
+
+            // Moving <a> to <x> must not move <b> away from it.
+            if (b.r == x.r && b.c == x.c) {
+                std::swap(a, b);
+            }
+            swapCells(board, a, x);
+            swapCells(board, b, y);
+            regions.rebuild();
+            for (const Cell &player: players) {
+                if (regions.canReach(player, x) &&
+                    regions.canReach(player, y) &&
+                    checker.connect(x, y, maxTurns, nullptr)) {
+                    return true;
+                }
+            }
+            swapCells(board, b, y);
+            swapCells(board, a, x);
+        }
+    }
+    regions.rebuild();
+    return false;
+}
+
+void BoardShuffler::swapCells(Board *board, const Cell &a, const Cell &b)
+{
+    const BlockType t = board->type(a.r, a.c);
+    const BlockContent bc = board->content(a.r, a.c);
+    board->setCell(a.r, a.c, board->type(b.r, b.c), board->content(b.r, b.c));
+    board->setCell(b.r, b.c, t, bc);
+}
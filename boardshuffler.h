@@ -0,0 +1,75 @@
+#ifndef BOARDSHUFFLER_H
+#define BOARDSHUFFLER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "linkchecker.h"
+#include "regionindex.h"
+#include "xoshiro256.h"
+
+struct ShuffleResult {
+    // True if a pair of blocks can be linked and walked up to by a player.
+    bool playable = false;
+
+    // Arrangements drawn, including the last one.
+    int attempts = 0;
+
+    // True if the last arrangement has been repaired by moving a pair next to
+    // a player.
+    bool repaired = false;
+
+    // Cells whose type or content differs from before the shuffle.
+    std::vector<Cell> changed;
+};
+
+// Shuffles the contents of a board in place. The blocks, items and empty
+// cells of the board are dealt out to its cells at random in a single pass,
+// leaving the cells that players stand on empty.
+//
+// An arrangement without a pair that a player can walk up to and link is
+// drawn again, and if none of a few is playable, the last one is repaired by
+// swapping a pair of blocks onto two cells next to a player that can be
+// linked.
+class BoardShuffler {
+public:
+    BoardShuffler();
+
+    // Shuffle <board> from <seed>, with links of at most <maxTurns> turns.
+    // Players stand at <players>, and <pinned> are the cells they cover, which
+    // include <players> and are left empty if there are enough empty cells.
+    ShuffleResult shuffle(Board *board, const std::vector<Cell> &players,
+                          const std::vector<Cell> &pinned, const int maxTurns,
+                          const uint64_t seed);
+
+private:
+    // Arrangements drawn before repairing the last one.
+    static const int kMaxAttempts = 8;
+
+    Xoshiro256 rng;
+    LinkChecker checker;
+    RegionIndex regions;
+
+    // Scratch of `deal` and `hasPlayablePair`.
+    std::vector<std::pair<BlockType, BlockContent>> contents;
+    std::vector<Cell> cells;
+    std::vector<Cell> partners;
+
+    // Deal the contents of <board> out at random, leaving <pinned> empty.
+    void deal(Board *board, const std::vector<uint8_t> &isPinned);
+
+    // Returns true if a player at one of <players> can walk up to a pair that
+    // can be linked within <maxTurns> turns. <regions> must be built.
+    bool hasPlayablePair(const Board &board, const std::vector<Cell> &players,
+                         const int maxTurns);
+
+    // Move a pair of blocks onto two cells next to one of <players> that can
+    // be linked. Returns false if there are no such cells.
+    bool repair(Board *board, const std::vector<Cell> &players,
+                const std::vector<uint8_t> &isPinned, const int maxTurns);
+
+    // Swap the contents of <a> and <b>.
+    static void swapCells(Board *board, const Cell &a, const Cell &b);
+};
+
+#endif // BOARDSHUFFLER_H
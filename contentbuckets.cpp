@@ -0,0 +1,58 @@
+#include "contentbuckets.h"
+
+#include <cassert>
+
+#include "contentscan.h"
+
+ContentBuckets::ContentBuckets(): buckets(kMaxContent + 1)
+{
+
+}
+
+void ContentBuckets::rebuild(const uint8_t *contents, const int n)
+{
+    for (auto &b: buckets) {
+        b.clear();
+    }
+    scanContents(contents, n, buckets);
+
+    offsets.assign(n, -1);
+    for (const auto &b: buckets) {
+        for (int i = 0; i < static_cast<int>(b.size()); ++i) {
+            offsets[b[i]] = i;
+        }
+    }
+}
+
+void ContentBuckets::insert(const int idx, const BlockContent bc)
+{
+    assert(bc > 0 && bc <= kMaxContent);
+    if (idx >= static_cast<int>(offsets.size())) {
+        offsets.resize(idx + 1, -1);
+    }
+    offsets[idx] = static_cast<int>(buckets[bc].size());
+    buckets[bc].push_back(idx);
+}
+
+void ContentBuckets::erase(const int idx, const BlockContent bc)
+{
+    std::vector<int> &b = buckets[bc];
+    const int slot = offsets[idx];
+    assert(slot >= 0 && b[slot] == idx);
+
+    // Move the last position into the hole.
+    b[slot] = b.back();
+    offsets[b[slot]] = slot;
+    b.pop_back();
+    offsets[idx] = -1;
+}
+
+const std::vector<int> &ContentBuckets::bucket(const BlockContent bc) const
+{
+    return buckets[bc];
+}
+
+int ContentBuckets::bucketCount() const
+{
+    return static_cast<int>(buckets.size());
+}
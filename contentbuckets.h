@@ -0,0 +1,45 @@
+#ifndef CONTENTBUCKETS_H
+#define CONTENTBUCKETS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "types.h"
+
+// Positions of the blocks on a Board, grouped by content. Only blocks of the
+// same content can ever match, so enumerating candidates through a bucket
+// costs time proportional to the blocks of that content instead of the area
+// of the board. Insertion and removal are O(1), positions within a bucket are
+// unordered.
+class ContentBuckets {
+public:
+    ContentBuckets();
+
+    // Rebuild every bucket from the flat array <contents> of <n> cells, where
+    // 0 marks a cell without a block.
+    void rebuild(const uint8_t *contents, const int n);
+
+    // Add the block at flat index <idx> with content <bc>.
+    void insert(const int idx, const BlockContent bc);
+
+    // Remove the block at flat index <idx> with content <bc>.
+    void erase(const int idx, const BlockContent bc);
+
+    // Flat indices of the blocks with content <bc>.
+    const std::vector<int> &bucket(const BlockContent bc) const;
+
+    // One more than the largest content that has a bucket.
+    int bucketCount() const;
+
+private:
+    // Largest content a block can have, limited by the width of the flat
+    // content array.
+    static const int kMaxContent = UINT8_MAX;
+
+    std::vector<std::vector<int>> buckets;
+
+    // Position of each flat index within its bucket.
+    std::vector<int> offsets;
+};
+
+#endif // CONTENTBUCKETS_H
@@ -0,0 +1,111 @@
+#include "contentscan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QLINK_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef void (*ScanFunction)(const uint8_t *data, const int n,
+                             std::vector<std::vector<int>> &buckets);
+
+void scanScalar(const uint8_t *data, const int begin, const int n,
+                std::vector<std::vector<int>> &buckets)
+{
+    for (int i = begin; i < n; ++i) {
+        if (data[i]) {
+            buckets[data[i]].push_back(i);
+        }
+    }
+}
+
+void scanPortable(const uint8_t *data, const int n,
+                  std::vector<std::vector<int>> &buckets)
+{
+    scanScalar(data, 0, n, buckets);
+}
+
+#ifdef QLINK_X86_SIMD
+
+// Push the positions of the set bits of <mask>, counted from <base>.
+inline void scanMask(const uint8_t *data, const int base, uint32_t mask,
+                     std::vector<std::vector<int>> &buckets)
+{
+    while (mask) {
+        const int i = base + __builtin_ctz(mask);
+        buckets[data[i]].push_back(i);
+        mask &= mask - 1;
+    }
+}
+
+__attribute__((target("sse2")))
+void scanSse2(const uint8_t *data, const int n,
+              std::vector<std::vector<int>> &buckets)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(data + i));
+        const uint32_t empty = _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+        scanMask(data, i, ~empty & 0xffffu, buckets);
+    }
+    scanScalar(data, i, n, buckets);
+}
+
+__attribute__((target("avx2")))
+void scanAvx2(const uint8_t *data, const int n,
+              std::vector<std::vector<int>> &buckets)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(data + i));
+        const uint32_t empty = static_cast<uint32_t>(
+                    _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero)));
+        scanMask(data, i, ~empty, buckets);
+    }
+    scanScalar(data, i, n, buckets);
+}
+
+#endif
+
+struct Kernel {
+    ScanFunction function;
+    const char *name;
+};
+
+Kernel resolveKernel()
+{
+#ifdef QLINK_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return { scanAvx2, "avx2" };
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return { scanSse2, "sse2" };
+    }
+#endif
+    return { scanPortable, "scalar" };
+}
+
+const Kernel &kernel()
+{
+    static const Kernel k = resolveKernel();
+    return k;
+}
+
+}
+
+void scanContents(const uint8_t *data, const int n,
+                  std::vector<std::vector<int>> &buckets)
+{
+    kernel().function(data, n, buckets);
+}
+
+const char *contentScanKernel()
+{
+    return kernel().name;
+}
@@ -0,0 +1,21 @@
+#ifndef CONTENTSCAN_H
+#define CONTENTSCAN_H
+
+#include <cstdint>
+#include <vector>
+
+// Vectorized kernel that turns a flat array of block contents into per-content
+// position lists. For every i in [0, <n>) with a non-zero <data>[i], appends i
+// to <buckets>[<data>[i]], which must be large enough for every value that
+// occurs. Positions are appended in increasing order.
+//
+// The kernel skips 32 (AVX2) or 16 (SSE2) empty cells per comparison. The
+// widest variant the CPU supports is chosen on first use, with a scalar
+// fallback for other architectures.
+void scanContents(const uint8_t *data, const int n,
+                  std::vector<std::vector<int>> &buckets);
+
+// Name of the variant that `scanContents` dispatches to, for benchmarks.
+const char *contentScanKernel();
+
+#endif // CONTENTSCAN_H
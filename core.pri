@@ -0,0 +1,59 @@
+# Game logic that does not depend on Qt, shared by the game and the tools
+# under tools/.
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/beamsolver.cpp \
+    $$PWD/bitboard.cpp \
+    $$PWD/board.cpp \
+    $$PWD/boardgenerator.cpp \
+    $$PWD/boardshuffler.cpp \
+    $$PWD/contentbuckets.cpp \
+    $$PWD/contentscan.cpp \
+    $$PWD/difficultymeter.cpp \
+    $$PWD/difficultysearch.cpp \
+    $$PWD/distancefield.cpp \
+    $$PWD/freecells.cpp \
+    $$PWD/gameengine.cpp \
+    $$PWD/gamerandom.cpp \
+    $$PWD/levelpack.cpp \
+    $$PWD/linkchecker.cpp \
+    $$PWD/mappool.cpp \
+    $$PWD/moveenumerator.cpp \
+    $$PWD/nextstep.cpp \
+    $$PWD/obstacletable.cpp \
+    $$PWD/pairindex.cpp \
+    $$PWD/pathfinder.cpp \
+    $$PWD/regionindex.cpp \
+    $$PWD/solver.cpp \
+    $$PWD/taskpool.cpp \
+    $$PWD/xoshiro256.cpp
+
+HEADERS += \
+    $$PWD/beamsolver.h \
+    $$PWD/bitboard.h \
+    $$PWD/board.h \
+    $$PWD/boardgenerator.h \
+    $$PWD/boardshuffler.h \
+    $$PWD/contentbuckets.h \
+    $$PWD/contentscan.h \
+    $$PWD/difficultymeter.h \
+    $$PWD/difficultysearch.h \
+    $$PWD/distancefield.h \
+    $$PWD/freecells.h \
+    $$PWD/gameengine.h \
+    $$PWD/gamerandom.h \
+    $$PWD/levelpack.h \
+    $$PWD/linkchecker.h \
+    $$PWD/mappool.h \
+    $$PWD/moveenumerator.h \
+    $$PWD/nextstep.h \
+    $$PWD/obstacletable.h \
+    $$PWD/pairindex.h \
+    $$PWD/pathfinder.h \
+    $$PWD/regionindex.h \
+    $$PWD/solver.h \
+    $$PWD/taskpool.h \
+    $$PWD/types.h \
+    $$PWD/xoshiro256.h
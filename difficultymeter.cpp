@@ -0,0 +1,62 @@
+#include "difficultymeter.h"
+
+DifficultyMeter::DifficultyMeter(): pairs(&board), regions(&board)
+{
+
+}
+
+BoardMetrics DifficultyMeter::measure(const Board &board, const Cell &spawn,
+                                      const int maxTurns, const uint64_t seed)
+{
+    this->board = board;
+    pairs.rebuild(maxTurns);
+    regions.rebuild();
+    rng.seed(seed);
+
+    int blocks = 0;
+    for (int r = 0; r < board.rows(); ++r) {
+        for (int c = 0; c < board.cols(); ++c) {
+            blocks += board.type(r, c) == kBlock;
+        }
+    }
+
+    BoardMetrics metrics;
+    long long branchSum = 0;
+    int branchMoves = 0;
+    int moves = 0;
+    for (int n = collectLive(spawn); n > 0; n = collectLive(spawn)) {
+        if (!moves) {
+            metrics.pairs = n;
+        }
+        if (branchMoves < kBranchingMoves) {
+            branchSum += n;
+            ++branchMoves;
+        }
+
+        const std::pair<Cell, Cell> move = live[rng.below(n)];
+        this->board.clearCell(move.first.r, move.first.c);
+        this->board.clearCell(move.second.r, move.second.c);
+        pairs.removeBlock(move.first);
+        pairs.removeBlock(move.second);
+        regions.removeBlock(move.first);
+        regions.removeBlock(move.second);
+        ++moves;
+    }
+
+    metrics.branching = branchMoves ? double(branchSum) / branchMoves : 0;
+    metrics.depth = blocks ? double(moves * 2) / blocks : 1;
+    return metrics;
+}
+
+int DifficultyMeter::collectLive(const Cell &spawn)
+{
+    live.clear();
+    for (int i = 0; i < pairs.count(); ++i) {
+        const std::pair<Cell, Cell> pair = pairs.pairAt(i);
+        if (regions.canReach(spawn, pair.first) &&
+            regions.canReach(spawn, pair.second)) {
+            live.push_back(pair);
+        }
+    }
+    return static_cast<int>(live.size());
+}
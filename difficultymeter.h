@@ -0,0 +1,55 @@
+#ifndef DIFFICULTYMETER_H
+#define DIFFICULTYMETER_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "pairindex.h"
+#include "regionindex.h"
+#include "xoshiro256.h"
+
+// How hard a board is to play, as seen from a player's spawn point.
+struct BoardMetrics {
+    // Pairs that can be linked and walked up to at the start.
+    int pairs = 0;
+
+    // Mean number of such pairs over the first moves of a random playout.
+    double branching = 0;
+
+    // Fraction of the pairs that the playout clears before it gets stuck, 1
+    // if it clears the board.
+    double depth = 0;
+};
+
+// Measures boards by playing them out at random: each move takes away a pair
+// drawn among those the player can walk up to and link. The legal pairs and
+// walkable regions are kept by incremental PairIndex and RegionIndex updates,
+// so a playout costs one sweep per block to build the indices and little
+// more.
+class DifficultyMeter {
+public:
+    DifficultyMeter();
+
+    // Measure <board> for a player starting at <spawn>, with links of at most
+    // <maxTurns> turns. The playout is drawn from <seed>.
+    BoardMetrics measure(const Board &board, const Cell &spawn,
+                         const int maxTurns, const uint64_t seed);
+
+private:
+    // Moves of the playout that branching is averaged over.
+    static const int kBranchingMoves = 10;
+
+    Board board;
+    PairIndex pairs;
+    RegionIndex regions;
+    Xoshiro256 rng;
+
+    // Pairs that can be walked up to from the spawn point.
+    std::vector<std::pair<Cell, Cell>> live;
+
+    // Fill <live> with the pairs reachable from <spawn> and return how many.
+    int collectLive(const Cell &spawn);
+};
+
+#endif // DIFFICULTYMETER_H
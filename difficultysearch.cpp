@@ -0,0 +1,168 @@
+#include "difficultysearch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+
+#include "linkchecker.h"
+
+namespace {
+
+// Blocks of the boards that the targets were measured on.
+const int kCalibrationBlocks = 200;
+
+// Median pairs and branching of the calibration boards, by routing mode,
+// tier and turn limit. Links around the map only pay off with two turns or
+// more.
+const int kTargetPairs[2][3][LinkChecker::kMaxTurnLimit + 1] = {
+    {
+        {109, 277, 560, 907, 1320},
+        {99, 227, 456, 729, 1050},
+        {74, 127, 235, 367, 519},
+    },
+    {
+        {109, 277, 677, 1365, 2203},
+        {99, 227, 546, 1081, 1763},
+        {74, 127, 280, 538, 852},
+    },
+};
+const double kTargetBranching[2][3][LinkChecker::kMaxTurnLimit + 1] = {
+    {
+        {102, 271, 570, 944, 1367},
+        {92, 221, 461, 761, 1078},
+        {69, 122, 235, 376, 532},
+    },
+    {
+        {102, 271, 694, 1393, 2205},
+        {92, 221, 557, 1101, 1756},
+        {69, 122, 283, 550, 865},
+    },
+};
+
+// Median depth of the calibration boards, by tier and turn limit. Random
+// play gets stuck on most boards without turns, and clears nearly all
+// boards with them, in either routing mode.
+const double kTargetDepth[3][LinkChecker::kMaxTurnLimit + 1] = {
+    {0.84, 1, 1, 1, 1},
+    {0.84, 1, 1, 1, 1},
+    {0.85, 1, 1, 1, 1},
+};
+
+const int kTierTypes[3] = {4, 5, 10};
+
+}
+
+DifficultyTarget DifficultyTarget::forTier(const Difficulty tier,
+                                           const int maxTurns,
+                                           const bool borderRouting,
+                                           const int blocks)
+{
+    assert(tier >= kEasy && tier <= kHard);
+    assert(maxTurns >= 0 && maxTurns <= LinkChecker::kMaxTurnLimit);
+    const double scale = double(blocks) / kCalibrationBlocks;
+
+    DifficultyTarget target;
+    target.types = kTierTypes[tier];
+    target.pairs = static_cast<int>(std::lround(
+                kTargetPairs[borderRouting][tier][maxTurns] * scale));
+    target.branching = kTargetBranching[borderRouting][tier][maxTurns] *
+            scale;
+    target.depth = kTargetDepth[tier][maxTurns];
+    return target;
+}
+
+double DifficultyTarget::distance(const BoardMetrics &metrics) const
+{
+    const double pairError = pairs ?
+                std::abs(metrics.pairs - pairs) / (pairs * tolerance) : 0;
+    const double branchError = branching > 0 ?
+                std::abs(metrics.branching - branching) /
+                (branching * tolerance) : 0;
+    const double depthError = std::abs(metrics.depth - depth) / depthTolerance;
+    return std::max(pairError, std::max(branchError, depthError));
+}
+
+DifficultySearch::DifficultySearch(const int workers): pool(workers),
+    candidates(kCandidates)
+{
+    for (int i = 0; i < pool.workerCount(); ++i) {
+        this->workers.emplace_back(new Worker());
+    }
+}
+
+SearchResult DifficultySearch::search(Board *board,
+                                      const GeneratorOptions &options,
+                                      const DifficultyTarget &target,
+                                      Xoshiro256 *rng, const int budgetMillis)
+{
+    assert(target.types > 0);
+    GeneratorOptions tierOptions = options;
+    tierOptions.blocksPerType = std::max(2,
+                                         options.blocks / target.types / 2 * 2);
+
+    for (Candidate &candidate: candidates) {
+        candidate.seed = (*rng)();
+        candidate.measured = false;
+        candidate.board.setBorderRouting(board->borderRouting());
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::milliseconds(budgetMillis);
+    // Lowest candidate within tolerance so far. Candidates after it cannot
+    // win and are skipped.
+    std::atomic<int> firstHit(kCandidates);
+    pool.run(kCandidates, [&](const int task, const int worker) {
+        if (task > firstHit.load() ||
+            (task > 0 && std::chrono::steady_clock::now() >= deadline)) {
+            return;
+        }
+
+        Worker &w = *workers[worker];
+        Candidate &candidate = candidates[task];
+        candidate.generated = w.generator.generate(
+                    &candidate.board, candidate.seed, tierOptions);
+        if (!candidate.generated.complete) {
+            return;
+        }
+        candidate.metrics = w.meter.measure(
+                    candidate.board, candidate.generated.spawns[0],
+                    options.maxTurns, candidate.seed);
+        candidate.distance = target.distance(candidate.metrics);
+        candidate.measured = true;
+
+        if (candidate.distance <= 1) {
+            int hit = firstHit.load();
+            while (task < hit && !firstHit.compare_exchange_weak(hit, task)) {
+            }
+        }
+    });
+
+    SearchResult result;
+    int best = -1;
+    for (int i = 0; i < kCandidates; ++i) {
+        const Candidate &candidate = candidates[i];
+        if (!candidate.measured) {
+            continue;
+        }
+        ++result.measured;
+        if (best < 0 || candidate.distance < candidates[best].distance) {
+            best = i;
+        }
+    }
+    if (firstHit.load() < kCandidates) {
+        best = firstHit.load();
+    }
+    if (best < 0) {
+        // Not a single candidate could be generated in time.
+        return result;
+    }
+
+    Candidate &chosen = candidates[best];
+    *board = chosen.board;
+    result.generated = std::move(chosen.generated);
+    result.metrics = chosen.metrics;
+    result.onTarget = chosen.distance <= 1;
+    return result;
+}
@@ -0,0 +1,96 @@
+#ifndef DIFFICULTYSEARCH_H
+#define DIFFICULTYSEARCH_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "boardgenerator.h"
+#include "difficultymeter.h"
+#include "taskpool.h"
+#include "types.h"
+
+// Metrics that a board should have, and how far it may be off.
+struct DifficultyTarget {
+    // Number of contents the blocks are split into, the knob of the search.
+    // Fewer contents leave more pairs to choose from.
+    int types = 5;
+
+    int pairs = 0;
+    double branching = 0;
+    double depth = 1;
+
+    // Tolerance relative to <pairs> and <branching>, and absolute on
+    // <depth>.
+    double tolerance = 0.1;
+    double depthTolerance = 0.1;
+
+    // The target of <tier> for boards of <blocks> blocks with links of at
+    // most <maxTurns> turns, around the map if <borderRouting>. Targets are
+    // the median metrics of generated 15 x 30 boards of 200 blocks, split
+    // into 4, 5 and 10 contents from easy to hard, in the same routing mode.
+    // Pairs and branching scale with the number of blocks.
+    static DifficultyTarget forTier(const Difficulty tier, const int maxTurns,
+                                    const bool borderRouting,
+                                    const int blocks);
+
+    // Largest error of <metrics>, in tolerances: at most 1 within tolerance.
+    double distance(const BoardMetrics &metrics) const;
+};
+
+struct SearchResult {
+    // The chosen board as generated.
+    GeneratorResult generated;
+    BoardMetrics metrics;
+
+    // True if the board is within tolerance of the target.
+    bool onTarget = false;
+
+    // Candidates generated and measured.
+    int measured = 0;
+};
+
+// Generates boards of a given difficulty. A batch of candidate seeds is
+// drawn up front, and the candidates are generated and measured in parallel
+// on a TaskPool. The first candidate in seed order that is within tolerance
+// wins, so the result only depends on the seeds, unless the time budget runs
+// out first. If no candidate is within tolerance, the closest one wins.
+class DifficultySearch {
+public:
+    // Use <workers> threads, or one per hardware thread if <workers> is 0.
+    DifficultySearch(const int workers = 0);
+
+    // Replace <board> with a board of <target> generated with the size,
+    // blocks and turn limit of <options>, from seeds drawn from <rng>. The
+    // routing mode of <board> is kept. Candidates not started within
+    // <budgetMillis> milliseconds are skipped, but the first one always
+    // runs.
+    SearchResult search(Board *board, const GeneratorOptions &options,
+                        const DifficultyTarget &target, Xoshiro256 *rng,
+                        const int budgetMillis);
+
+private:
+    // Candidates drawn per search.
+    static const int kCandidates = 32;
+
+    // Generator and meter of one worker.
+    struct Worker {
+        BoardGenerator generator;
+        DifficultyMeter meter;
+    };
+
+    struct Candidate {
+        uint64_t seed = 0;
+        bool measured = false;
+        double distance = 0;
+        Board board;
+        GeneratorResult generated;
+        BoardMetrics metrics;
+    };
+
+    TaskPool pool;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<Candidate> candidates;
+};
+
+#endif // DIFFICULTYSEARCH_H
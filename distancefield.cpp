@@ -0,0 +1,129 @@
+#include "distancefield.h"
+
+#include <cassert>
+
+DistanceField::DistanceField(const Board *board): board(board),
+    from({ -1, -1 }), stale(true), nSearches(0)
+{
+
+}
+
+void DistanceField::setBoard(const Board *board)
+{
+    this->board = board;
+    stale = true;
+}
+
+void DistanceField::setSource(const Cell &cell)
+{
+    if (cell.r != from.r || cell.c != from.c) {
+        from = cell;
+        stale = true;
+    }
+}
+
+void DistanceField::invalidate()
+{
+    stale = true;
+}
+
+void DistanceField::removeBlock(const Cell &cell)
+{
+    if (stale) {
+        return;
+    }
+    const int idx = board->index(cell);
+    assert(!board->isObstacle(idx));
+
+    // The freed cell is one step further than its nearest neighbour, and
+    // everything behind it may now be closer.
+    int best = -1;
+    for (const Direction d: { Direction::kUp, Direction::kDown,
+                              Direction::kLeft, Direction::kRight }) {
+        const int dist = distances[idx + board->offset(d)];
+        if (dist >= 0 && (best < 0 || dist < best)) {
+            best = dist;
+        }
+    }
+    if (best < 0) {
+        return;
+    }
+    distances[idx] = best + 1;
+    queue.clear();
+    queue.push_back(idx);
+    spread();
+}
+
+bool DistanceField::refresh()
+{
+    assert(board);
+    if (!stale) {
+        return false;
+    }
+    stale = false;
+    ++nSearches;
+    distances.assign(board->size(), -1);
+
+    if (from.r < 0 || from.r >= board->rows() ||
+        from.c < 0 || from.c >= board->cols()) {
+        return true;
+    }
+    const int idx = board->index(from);
+    if (board->isObstacle(idx)) {
+        return true;
+    }
+    distances[idx] = 0;
+    queue.clear();
+    queue.push_back(idx);
+    spread();
+    return true;
+}
+
+int DistanceField::distanceTo(const Cell &cell) const
+{
+    assert(!stale);
+    return distances[board->index(cell)];
+}
+
+int DistanceField::reachCost(const Cell &cell) const
+{
+    assert(!stale);
+    const int idx = board->index(cell);
+    int best = -1;
+    for (const Direction d: { Direction::kUp, Direction::kDown,
+                              Direction::kLeft, Direction::kRight }) {
+        const int dist = distances[idx + board->offset(d)];
+        if (dist >= 0 && (best < 0 || dist < best)) {
+            best = dist;
+        }
+    }
+    return best;
+}
+
+const Cell &DistanceField::source() const
+{
+    return this->from;
+}
+
+int DistanceField::searches() const
+{
+    return this->nSearches;
+}
+
+void DistanceField::spread()
+{
+    // The wall ring is an obstacle, so neighbours always exist.
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const int idx = queue[head];
+        const int dist = distances[idx] + 1;
+        for (const Direction d: { Direction::kUp, Direction::kDown,
+                                  Direction::kLeft, Direction::kRight }) {
+            const int next = idx + board->offset(d);
+            if (!board->isObstacle(next) &&
+                (distances[next] < 0 || distances[next] > dist)) {
+                distances[next] = dist;
+                queue.push_back(next);
+            }
+        }
+    }
+}
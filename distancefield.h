@@ -0,0 +1,69 @@
+#ifndef DISTANCEFIELD_H
+#define DISTANCEFIELD_H
+
+#include <vector>
+
+#include "board.h"
+
+// Walking distances from the cell a player stands on to every cell it can walk
+// on, found by breadth first search. Like in RegionIndex, blocks and the wall
+// ring cannot be walked on, items can.
+//
+// The field is only searched again when the player steps onto another cell or
+// the board is rebuilt. Eliminations only ever free cells, which can only
+// shorten distances, so they are repaired by a search that starts from the
+// freed cell and stops where distances do not improve.
+class DistanceField {
+public:
+    DistanceField(const Board *board = nullptr);
+
+    // Sets the board that the field is computed on. Marks the field stale.
+    void setBoard(const Board *board);
+
+    // Move the player to <cell>, or take it off the board if <cell> is outside
+    // the map. Marks the field stale only if the cell changes.
+    void setSource(const Cell &cell);
+
+    // Mark the field stale, e.g. after blocks have been moved around.
+    void invalidate();
+
+    // Update the field after the block at <cell> has been removed from the
+    // board.
+    void removeBlock(const Cell &cell);
+
+    // Search the board again if the field is stale. Returns true if it was.
+    // Must be called before querying the field.
+    bool refresh();
+
+    // Steps from the player to <cell>, or -1 if it cannot walk there.
+    int distanceTo(const Cell &cell) const;
+
+    // Steps the player has to take to stand next to <cell>, e.g. to touch the
+    // block on it. -1 if it cannot walk up to <cell>.
+    int reachCost(const Cell &cell) const;
+
+    const Cell &source() const;
+
+    // Number of full searches so far.
+    int searches() const;
+
+private:
+    const Board *board;
+
+    Cell from;
+    bool stale;
+
+    // Distance of each flat index, -1 for cells the player cannot walk to.
+    std::vector<int> distances;
+
+    // Scratch queue of flat indices.
+    std::vector<int> queue;
+
+    int nSearches;
+
+    // Breadth first search from the cells in <queue>, whose distances are
+    // already set, lowering the distance of every cell it gets to first.
+    void spread();
+};
+
+#endif // DISTANCEFIELD_H
@@ -0,0 +1,70 @@
+#include "freecells.h"
+
+#include <cassert>
+
+FreeCells::FreeCells(const int rows, const int cols)
+{
+    reset(rows, cols);
+}
+
+void FreeCells::reset(const int rows, const int cols)
+{
+    this->cols = cols;
+    cells.clear();
+    cells.reserve(rows * cols);
+    positions.assign(rows * cols, -1);
+}
+
+void FreeCells::insert(const Cell &cell)
+{
+    const int idx = flat(cell);
+    if (positions[idx] >= 0) {
+        return;
+    }
+    positions[idx] = static_cast<int>(cells.size());
+    cells.push_back(idx);
+}
+
+void FreeCells::erase(const Cell &cell)
+{
+    const int idx = flat(cell);
+    const int slot = positions[idx];
+    if (slot < 0) {
+        return;
+    }
+
+    // Move the last cell into the hole.
+    cells[slot] = cells.back();
+    positions[cells[slot]] = slot;
+    cells.pop_back();
+    positions[idx] = -1;
+}
+
+bool FreeCells::contains(const Cell &cell) const
+{
+    return positions[flat(cell)] >= 0;
+}
+
+int FreeCells::size() const
+{
+    return static_cast<int>(cells.size());
+}
+
+bool FreeCells::empty() const
+{
+    return cells.empty();
+}
+
+Cell FreeCells::at(const int i) const
+{
+    assert(i >= 0 && i < size());
+    return { cells[i] / cols, cells[i] % cols };
+}
+
+int FreeCells::flat(const Cell &cell) const
+{
+    const int idx = cell.r * cols + cell.c;
+    assert(cell.c >= 0 && cell.c < cols && idx >= 0 &&
+           idx < static_cast<int>(positions.size()));
+    return idx;
+}
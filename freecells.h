@@ -0,0 +1,44 @@
+#ifndef FREECELLS_H
+#define FREECELLS_H
+
+#include <vector>
+
+#include "board.h"
+
+// Set of the empty cells of a map, for placing items and players. Insertion,
+// removal and access by position are O(1), so a uniformly random empty cell
+// can be picked in constant time however full the map is. Positions within
+// the set are unordered, and change when cells are removed.
+class FreeCells {
+public:
+    // An empty set for a map of <rows> x <cols>.
+    FreeCells(const int rows = 0, const int cols = 0);
+
+    // Empty the set and size it for a map of <rows> x <cols>.
+    void reset(const int rows, const int cols);
+
+    // Add <cell> to the set, or remove it. Does nothing if <cell> already is,
+    // or is not, in the set.
+    void insert(const Cell &cell);
+    void erase(const Cell &cell);
+
+    bool contains(const Cell &cell) const;
+
+    int size() const;
+    bool empty() const;
+
+    // Cell at position <i> of the set, 0 <= <i> < `size()`.
+    Cell at(const int i) const;
+
+private:
+    int cols;
+
+    // Cells of the set as flat indices, and the position of each flat index
+    // in <cells>, -1 if it is not in the set.
+    std::vector<int> cells;
+    std::vector<int> positions;
+
+    int flat(const Cell &cell) const;
+};
+
+#endif // FREECELLS_H
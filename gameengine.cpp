@@ -0,0 +1,1233 @@
+#include "gameengine.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+
+#include "nextstep.h"
+
+GameEngine::GameEngine():
+    gameMode(GameMode::kSingle),
+    turns(kDefaultMaxTurns),
+    gameBoard(kMaxRows, kMaxCols),
+    choosers(kMaxRows * kMaxCols, WhichPlayer::kNoPlayer),
+    linkChecker(&gameBoard),
+    pairIndex(&gameBoard),
+    regionIndex(&gameBoard),
+    freeCells(kMaxRows, kMaxCols),
+    running(false),
+    over(false),
+    nBlocksRemaining(0),
+    nTimeRemaining(kInitialTime),
+    secondTicks(0),
+    hint(false),
+    hintFor(WhichPlayer::kNoPlayer),
+    hintTicks(0),
+    hintPending(false),
+    externalAnalysis(false),
+    boardVersion(0)
+{
+    // Check the number of blocks and block types.
+    assert(kBlockNum < kMaxRows * kMaxCols - 1);
+    assert(kBlocksPerType * kTypeNum == kBlockNum);
+    assert(!(kBlocksPerType & 1));
+
+    // Players and items are centered on cells.
+    assert(!(kCellSize & 1) && !(kPlayerSize & 1) && !(kItemSize & 1));
+    assert(kPlayerSize < kCellSize && kItemSize < kCellSize);
+
+    pairIndex.setEnumerator(&moveEnumerator);
+    for (auto &field: distanceFields) {
+        field.setBoard(&gameBoard);
+    }
+    pathFinder.setBoard(&gameBoard);
+    hintPair[0] = hintPair[1] = { -1, -1 };
+    setMaxTurns(kDefaultMaxTurns);
+    rebuild();
+}
+
+GeneratorOptions GameEngine::mapOptions()
+{
+    GeneratorOptions options;
+    options.rows = kMaxRows;
+    options.cols = kMaxCols;
+    options.blocks = kBlockNum;
+    options.blocksPerType = kBlocksPerType;
+    return options;
+}
+
+void GameEngine::addListener(GameListener *listener)
+{
+    listeners.push_back(listener);
+}
+
+void GameEngine::removeListener(GameListener *listener)
+{
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), listener),
+                    listeners.end());
+}
+
+void GameEngine::setExternalAnalysis(const bool enabled)
+{
+    this->externalAnalysis = enabled;
+}
+
+void GameEngine::newGame(const GameMode mode, const PooledMap &map)
+{
+    assert(map.spec.players == (mode == GameMode::kSingle ? 1 : 2));
+    assert(map.board.rows() == kMaxRows && map.board.cols() == kMaxCols);
+    this->gameMode = mode;
+    random.reseed(map.seed);
+    setMaxTurns(map.spec.maxTurns);
+
+    // Pooled maps come with a spawn point for each player, and are cleared
+    // by construction.
+    gameBoard = map.board;
+    gameBoard.setBorderRouting(map.spec.borderRouting);
+    choosers.assign(choosers.size(), WhichPlayer::kNoPlayer);
+    spawnPoints = map.spawns;
+    nBlocksRemaining = 0;
+    for (int r = 0; r < kMaxRows; ++r) {
+        for (int c = 0; c < kMaxCols; ++c) {
+            nBlocksRemaining += gameBoard.type(r, c) == BlockType::kBlock;
+        }
+    }
+    assert(!(nBlocksRemaining & 1));
+
+    for (auto &walk: autoWalks) {
+        walk = AutoWalk();
+    }
+    rebuild();
+    for (int i = 0; i < 2; ++i) {
+        players[i] = PlayerState();
+        if (i < playerCount()) {
+            generatePlayer(playerAt(i));
+        }
+    }
+
+    nTimeRemaining = kInitialTime;
+    secondTicks = 0;
+    hint = false;
+    hintFor = WhichPlayer::kNoPlayer;
+    hintTicks = 0;
+    hintPair[0] = hintPair[1] = { -1, -1 };
+    hintPending = false;
+    running = false;
+    over = false;
+
+    changeBoard();
+    notify([](GameListener *l) { l->gameReset(); });
+}
+
+void GameEngine::save(std::ostream &out) const
+{
+    // Save mode.
+    out << gameMode << '\n';
+
+    // Save every cell as its row, column, hint mark, type, content and
+    // choosing player.
+    for (int r = 0; r < kMaxRows; ++r) {
+        for (int c = 0; c < kMaxCols; ++c) {
+            const Cell cell = { r, c };
+            out << r << ' ' << c << ' ' << isHint(cell) << ' '
+                << gameBoard.type(r, c) << ' ' << gameBoard.content(r, c)
+                << ' ' << chosenBy(cell) << ' ';
+        }
+        out << '\n';
+    }
+
+    // Save players.
+    for (int i = 0; i < playerCount(); ++i) {
+        const PlayerState &player = players[i];
+        out << playerAt(i) << ' ' << player.x << ' ' << player.y << ' '
+            << player.score << '\n';
+    }
+
+    // Save the blocks the players have chosen.
+    for (int i = 0; i < playerCount(); ++i) {
+        out << players[i].chosen.r << ' ' << players[i].chosen.c << '\n';
+    }
+
+    out << nBlocksRemaining << '\n';
+    out << nTimeRemaining << '\n';
+
+    // Save hint status, the player it is for, milliseconds left, and pair.
+    out << hint << '\n';
+    out << hintFor << '\n';
+    out << hintTicks * kTickMsec << '\n';
+    for (const Cell &cell: hintPair) {
+        out << cell.r << ' ' << cell.c << '\n';
+    }
+
+    // Save turn limit and routing mode.
+    out << turns << '\n';
+    out << gameBoard.borderRouting() << '\n';
+
+    // Save seed and where each random stream has got to.
+    out << random.seed() << '\n';
+    for (const uint64_t word: random.state()) {
+        out << word << ' ';
+    }
+    out << '\n';
+}
+
+bool GameEngine::load(std::istream &in)
+{
+    const auto isCell = [](const Cell &cell) {
+        return isNone(cell) || (cell.r >= 0 && cell.r < kMaxRows &&
+                                cell.c >= 0 && cell.c < kMaxCols);
+    };
+    const int range = kPlayerSize >> 1;
+    int x;
+
+    // Everything is read before anything is set, so that a malformed save
+    // leaves the game as it was.
+    if (!(in >> x) || (x != GameMode::kSingle && x != GameMode::kDouble)) {
+        return false;
+    }
+    const GameMode loadedMode = static_cast<GameMode>(x);
+    const int loadedPlayers = loadedMode == GameMode::kSingle ? 1 : 2;
+
+    Board loadedBoard(kMaxRows, kMaxCols);
+    std::vector<WhichPlayer> loadedChoosers(choosers.size());
+    int loadedBlocks = 0;
+    loadedBoard.beginUpdate();
+    for (int r = 0; r < kMaxRows; ++r) {
+        for (int c = 0; c < kMaxCols; ++c) {
+            int cellR;
+            int cellC;
+            int marked;
+            int t;
+            int bc;
+            int p;
+            if (!(in >> cellR >> cellC >> marked >> t >> bc >> p) ||
+                t < BlockType::kEmpty || t > BlockType::kItem ||
+                (t == BlockType::kBlock && (bc <= 0 || bc > UINT8_MAX)) ||
+                p < WhichPlayer::kNoPlayer || p > WhichPlayer::kPlayer2) {
+                return false;
+            }
+            loadedBoard.setCell(r, c, static_cast<BlockType>(t), bc);
+            loadedChoosers[r * kMaxCols + c] = static_cast<WhichPlayer>(p);
+            loadedBlocks += t == BlockType::kBlock;
+        }
+    }
+    loadedBoard.endUpdate();
+
+    PlayerState loaded[2];
+    for (int i = 0; i < loadedPlayers; ++i) {
+        if (!(in >> x >> loaded[i].x >> loaded[i].y >> loaded[i].score) ||
+            loaded[i].x < range || loaded[i].x > kMaxCols * kCellSize - range ||
+            loaded[i].y < range || loaded[i].y > kMaxRows * kCellSize - range) {
+            return false;
+        }
+    }
+    for (int i = 0; i < loadedPlayers; ++i) {
+        if (!(in >> loaded[i].chosen.r >> loaded[i].chosen.c) ||
+            !isCell(loaded[i].chosen)) {
+            return false;
+        }
+    }
+
+    int blocks;
+    int time;
+    int loadedHint;
+    int loadedHintFor;
+    int hintMsec;
+    Cell loadedHintPair[2];
+    if (!(in >> blocks >> time >> loadedHint >> loadedHintFor >> hintMsec) ||
+        loadedHintFor < WhichPlayer::kNoPlayer ||
+        loadedHintFor > WhichPlayer::kPlayer2) {
+        return false;
+    }
+    for (Cell &cell: loadedHintPair) {
+        if (!(in >> cell.r >> cell.c) || !isCell(cell)) {
+            return false;
+        }
+    }
+
+    // Saves from before turn limits were a setting have none, and likewise
+    // for the routing mode.
+    int loadedTurns = kDefaultMaxTurns;
+    bool border = kDefaultBorderRouting;
+    if (in >> x) {
+        if (x < 0 || x > LinkChecker::kMaxTurnLimit) {
+            return false;
+        }
+        loadedTurns = x;
+        if (in >> x) {
+            border = x;
+        }
+    }
+
+    // Likewise for the random streams. Games saved without them go on from a
+    // fresh seed.
+    uint64_t loadedSeed;
+    std::array<uint64_t, 4 * GameRandom::kStreams> state;
+    bool seeded = static_cast<bool>(in >> loadedSeed);
+    for (uint64_t &word: state) {
+        seeded = seeded && in >> word;
+    }
+    if (seeded && !GameRandom::isValidState(state)) {
+        return false;
+    }
+
+    gameMode = loadedMode;
+    setMaxTurns(loadedTurns);
+    gameBoard = loadedBoard;
+    gameBoard.setBorderRouting(border);
+    choosers = loadedChoosers;
+    spawnPoints.clear();
+    for (int i = 0; i < 2; ++i) {
+        players[i] = loaded[i];
+    }
+    if (seeded) {
+        random.setState(loadedSeed, state);
+    } else {
+        random.reseed(GameRandom::freshSeed());
+    }
+    // Blocks are counted rather than trusted.
+    nBlocksRemaining = loadedBlocks;
+    nTimeRemaining = time;
+    secondTicks = 0;
+    hint = loadedHint;
+    hintFor = static_cast<WhichPlayer>(loadedHintFor);
+    hintTicks = (hintMsec + kTickMsec - 1) / kTickMsec;
+    hintPair[0] = loadedHintPair[0];
+    hintPair[1] = loadedHintPair[1];
+    hintPending = false;
+    for (auto &walk: autoWalks) {
+        walk = AutoWalk();
+    }
+    running = false;
+    over = false;
+
+    rebuild();
+    changeBoard();
+    notify([](GameListener *l) { l->gameReset(); });
+    return true;
+}
+
+void GameEngine::start()
+{
+    this->running = true;
+
+    // The board may have run into a dead end while the game was paused.
+    applyAnalysis();
+}
+
+void GameEngine::pause()
+{
+    this->running = false;
+}
+
+void GameEngine::tick()
+{
+    if (!running || over) {
+        return;
+    }
+
+    for (int i = 0; i < playerCount() && !over; ++i) {
+        if (autoWalks[i].active) {
+            stepAutoWalk(playerAt(i));
+        }
+    }
+    if (over) {
+        return;
+    }
+
+    if (hint && --hintTicks <= 0) {
+        stopHint();
+    }
+
+    // Reduce time remaining, and possibly generate new item, once a second.
+    if (++secondTicks < kTicksPerSecond) {
+        return;
+    }
+    secondTicks = 0;
+    changeTime(-1);
+    if (!over && random.uniform(kItemStream, 0, 101) <= kSpawnItemProbability) {
+        spawnItem();
+    }
+}
+
+void GameEngine::move(const WhichPlayer which, const Direction d)
+{
+    if (!running || over || slot(which) >= playerCount()) {
+        return;
+    }
+
+    const int range = kPlayerSize >> 1;
+    PlayerState &player = players[slot(which)];
+
+    // Edges of the player, inclusive.
+    const int left = player.x - range;
+    const int right = player.x + range - 1;
+    const int top = player.y - range;
+    const int bottom = player.y + range - 1;
+
+    int newX;
+    int newY;
+    bool collide1;
+    bool collide2;
+    Cell rc;
+    Cell block1;
+    Cell block2;
+    Cell item1;
+    Cell item2;
+
+    // To make sure the character does not clip through blocks, need to check
+    // two points for each direction. For example, if the character is moving
+    // up, then top left and top right corner needs to be checked.
+    switch (d) {
+    case Direction::kUp:
+        newY = std::max(player.y - kMoveStep, range);
+        rc = cellAt(player.x, newY - range);
+        collide1 = checkCollision(left, newY - range, &block1);
+        collide2 = checkCollision(right, newY - range, &block2);
+        checkItem(left, newY - range, &item1);
+        checkItem(right, newY - range, &item2);
+        player.y = collide1 || collide2 ? (rc.r + 1) * kCellSize + range :
+                                          newY;
+        break;
+    case Direction::kDown:
+        newY = std::min(player.y + kMoveStep, kMaxRows * kCellSize - range);
+        rc = cellAt(player.x, newY + range);
+        collide1 = checkCollision(left, newY + range, &block1);
+        collide2 = checkCollision(right, newY + range, &block2);
+        checkItem(left, newY + range, &item1);
+        checkItem(right, newY + range, &item2);
+        player.y = collide1 || collide2 ? rc.r * kCellSize - range : newY;
+        break;
+    case Direction::kLeft:
+        newX = std::max(player.x - kMoveStep, range);
+        rc = cellAt(newX - range, player.y);
+        collide1 = checkCollision(newX - range, top, &block1);
+        collide2 = checkCollision(newX - range, bottom, &block2);
+        checkItem(newX - range, top, &item1);
+        checkItem(newX - range, bottom, &item2);
+        player.x = collide1 || collide2 ? (rc.c + 1) * kCellSize + range :
+                                          newX;
+        break;
+    case Direction::kRight:
+    default:
+        newX = std::min(player.x + kMoveStep, kMaxCols * kCellSize - range);
+        rc = cellAt(newX + range, player.y);
+        collide1 = checkCollision(newX + range, top, &block1);
+        collide2 = checkCollision(newX + range, bottom, &block2);
+        checkItem(newX + range, top, &item1);
+        checkItem(newX + range, bottom, &item2);
+        player.x = collide1 || collide2 ? rc.c * kCellSize - range : newX;
+        break;
+    }
+    notify([which](GameListener *l) { l->playerMoved(which); });
+
+    if (!isNone(block1) && !isNone(block2) && !isSame(block1, block2)) {
+        const Cell block = distinguishCollision(player, block1, block2, d);
+        if (!isNone(block)) {
+            choose(which, block);
+        }
+    } else if (!isNone(block1)) {
+        choose(which, block1);
+    } else if (!isNone(block2)) {
+        choose(which, block2);
+    }
+
+    if (!isNone(item1)) {
+        consumeItem(which, item1);
+    }
+    if (!isNone(item2)) {
+        consumeItem(which, item2);
+    }
+}
+
+void GameEngine::choose(const WhichPlayer which, const Cell &cell)
+{
+    if (!running || over || slot(which) >= playerCount() ||
+        gameBoard.type(cell.r, cell.c) != BlockType::kBlock) {
+        return;
+    }
+
+    // Check if the block is already chosen by another player.
+    WhichPlayer &chooser = choosers[cellIndex(cell)];
+    if (chooser != WhichPlayer::kNoPlayer && chooser != which) {
+        return;
+    }
+    chooser = which;
+    notify([&cell](GameListener *l) { l->cellChanged(cell); });
+
+    PlayerState &player = players[slot(which)];
+    if (isNone(player.chosen)) {
+        player.chosen = cell;
+    } else if (!isSame(cell, player.chosen)) {
+        const Cell first = player.chosen;
+        player.chosen = { -1, -1 };
+        validate(which, first, cell);
+    }
+}
+
+void GameEngine::toggleAutoWalk(const WhichPlayer which)
+{
+    if (slot(which) >= playerCount()) {
+        return;
+    }
+    AutoWalk &walk = autoWalks[slot(which)];
+    if (walk.active || !hint || isNone(hintPair[0]) || isNone(hintPair[1])) {
+        walk.active = false;
+        return;
+    }
+    walk = AutoWalk();
+    walk.active = true;
+    walk.targets[0] = hintPair[0];
+    walk.targets[1] = hintPair[1];
+}
+
+void GameEngine::stopAutoWalk(const WhichPlayer which)
+{
+    autoWalks[slot(which)].active = false;
+}
+
+void GameEngine::setAnalysis(const BoardAnalysis &analysis)
+{
+    if (analysis.version != boardVersion) {
+        return;
+    }
+    this->analysis = analysis;
+    applyAnalysis();
+}
+
+std::shared_ptr<BoardSnapshot> GameEngine::snapshot() const
+{
+    auto snapshot = std::make_shared<BoardSnapshot>();
+    snapshot->version = boardVersion;
+    snapshot->board = gameBoard;
+    snapshot->maxTurns = turns;
+    for (int i = 0; i < 2; ++i) {
+        snapshot->players[i] = i < playerCount() ? cellOf(players[i]) :
+                                                   Cell { -1, -1 };
+    }
+    return snapshot;
+}
+
+bool GameEngine::checkMatch(const Cell &a, const Cell &b, LinkPath *path)
+{
+    return !isSame(a, b) &&
+           gameBoard.type(a.r, a.c) == BlockType::kBlock &&
+           gameBoard.type(b.r, b.c) == BlockType::kBlock &&
+           gameBoard.content(a.r, a.c) == gameBoard.content(b.r, b.c) &&
+           chosenBy(a) == chosenBy(b) &&
+           linkChecker.link(a, b, path);
+}
+
+bool GameEngine::hasNextStep(Cell *a, Cell *b)
+{
+    bool found = false;
+
+    for (int i = 0; i < playerCount() && !found; ++i) {
+        const WhichPlayer which =
+                (!i && hintFor != WhichPlayer::kPlayer2) ||
+                (i && hintFor == WhichPlayer::kPlayer2) ?
+                    WhichPlayer::kPlayer1 :
+                    WhichPlayer::kPlayer2;
+        const auto pairs = cheapestPairs(which, 1);
+        if (!pairs.empty()) {
+            found = true;
+            *a = pairs[0].first;
+            *b = pairs[0].second;
+        }
+    }
+
+#ifdef QLINK_VERIFY_PAIR_INDEX
+    Cell scanned1;
+    Cell scanned2;
+    assert(pairIndex.isConsistent());
+    assert(regionIndex.isConsistent());
+    assert(scanNextStep(&scanned1, &scanned2) == found);
+#endif
+
+    return found;
+}
+
+std::vector<std::pair<Cell, Cell>> GameEngine::cheapestPairs(
+        const WhichPlayer which,
+        const int k)
+{
+    std::vector<std::pair<Cell, Cell>> pairs;
+    if (slot(which) >= playerCount()) {
+        return pairs;
+    }
+
+    // Only searched again if the player has stepped onto another cell.
+    DistanceField &field = distanceFields[slot(which)];
+    field.setSource(cellOf(players[slot(which)]));
+    field.refresh();
+    findCheapestPairs(gameBoard, pairIndex, field, k, &pairs);
+    return pairs;
+}
+
+bool GameEngine::scanNextStep(Cell *a, Cell *b)
+{
+    std::vector<int> sources;
+    std::vector<int> ranks;
+    MoveEnumerator::Move move;
+
+    for (int i = 0; i < playerCount(); ++i) {
+        const WhichPlayer which =
+                (!i && hintFor != WhichPlayer::kPlayer2) ||
+                (i && hintFor == WhichPlayer::kPlayer2) ?
+                    WhichPlayer::kPlayer1 :
+                    WhichPlayer::kPlayer2;
+        const Cell here = cellOf(players[slot(which)]);
+        const int region = regionIndex.regionOf(here);
+
+        // Blocks the player can reach, nearest first. Only those are accepted
+        // as partners, favoring the nearest one.
+        sources.clear();
+        ranks.assign(gameBoard.size(), -1);
+        for (int r = 0; r < kMaxRows; ++r) {
+            for (int c = 0; c < kMaxCols; ++c) {
+                if (gameBoard.type(r, c) == BlockType::kBlock &&
+                    regionIndex.touches({ r, c }, region)) {
+                    const int idx = gameBoard.index(r, c);
+                    sources.push_back(idx);
+                    ranks[idx] = nearestRank(gameBoard, { r, c }, here);
+                }
+            }
+        }
+        std::sort(sources.begin(), sources.end(),
+                  [&ranks](const int x, const int y) {
+            return ranks[x] < ranks[y];
+        });
+
+        if (moveEnumerator.findFirst(gameBoard, turns, sources, ranks,
+                                     &move)) {
+            *a = gameBoard.cellAt(move.first);
+            *b = gameBoard.cellAt(move.second);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const Board &GameEngine::board() const
+{
+    return this->gameBoard;
+}
+
+GameMode GameEngine::mode() const
+{
+    return this->gameMode;
+}
+
+int GameEngine::maxTurns() const
+{
+    return this->turns;
+}
+
+uint64_t GameEngine::seed() const
+{
+    return random.seed();
+}
+
+int GameEngine::playerCount() const
+{
+    return gameMode == GameMode::kSingle ? 1 : 2;
+}
+
+const PlayerState &GameEngine::player(const WhichPlayer which) const
+{
+    return players[slot(which)];
+}
+
+WhichPlayer GameEngine::chosenBy(const Cell &cell) const
+{
+    return choosers[cellIndex(cell)];
+}
+
+bool GameEngine::isHint(const Cell &cell) const
+{
+    return isSame(cell, hintPair[0]) || isSame(cell, hintPair[1]);
+}
+
+bool GameEngine::isRunning() const
+{
+    return this->running;
+}
+
+bool GameEngine::isOver() const
+{
+    return this->over;
+}
+
+int GameEngine::blocksRemaining() const
+{
+    return this->nBlocksRemaining;
+}
+
+int GameEngine::timeRemaining() const
+{
+    return this->nTimeRemaining;
+}
+
+Cell GameEngine::cellAt(const int x, const int y)
+{
+    assert(x >= 0 && x <= kMaxCols * kCellSize &&
+           y >= 0 && y <= kMaxRows * kCellSize);
+    return { y / kCellSize, x / kCellSize };
+}
+
+int GameEngine::slot(const WhichPlayer which)
+{
+    return which == WhichPlayer::kPlayer2 ? 1 : 0;
+}
+
+WhichPlayer GameEngine::playerAt(const int i)
+{
+    return i ? WhichPlayer::kPlayer2 : WhichPlayer::kPlayer1;
+}
+
+int GameEngine::cellIndex(const Cell &cell) const
+{
+    return cell.r * kMaxCols + cell.c;
+}
+
+bool GameEngine::isNone(const Cell &cell)
+{
+    return cell.r < 0;
+}
+
+bool GameEngine::isSame(const Cell &a, const Cell &b)
+{
+    return a.r == b.r && a.c == b.c;
+}
+
+Cell GameEngine::cellOf(const PlayerState &player)
+{
+    return cellAt(player.x, player.y);
+}
+
+void GameEngine::setMaxTurns(const int maxTurns)
+{
+    assert(maxTurns >= 0 && maxTurns <= LinkChecker::kMaxTurnLimit);
+    this->turns = maxTurns;
+    linkChecker.setTurnLimit(maxTurns);
+}
+
+void GameEngine::setCell(const Cell &cell, const BlockType t,
+                         const BlockContent bc)
+{
+    gameBoard.setCell(cell.r, cell.c, t, bc);
+    choosers[cellIndex(cell)] = WhichPlayer::kNoPlayer;
+    if (t == BlockType::kEmpty) {
+        freeCells.insert(cell);
+    } else {
+        freeCells.erase(cell);
+    }
+    notify([&cell](GameListener *l) { l->cellChanged(cell); });
+}
+
+void GameEngine::rebuild()
+{
+    freeCells.reset(kMaxRows, kMaxCols);
+    for (int r = 0; r < kMaxRows; ++r) {
+        for (int c = 0; c < kMaxCols; ++c) {
+            if (gameBoard.type(r, c) == BlockType::kEmpty) {
+                freeCells.insert({ r, c });
+            }
+        }
+    }
+    pairIndex.rebuild(turns);
+    regionIndex.rebuild();
+    for (auto &field: distanceFields) {
+        field.invalidate();
+    }
+
+    // Blocks may have been moved onto the routes of auto-walks.
+    for (auto &walk: autoWalks) {
+        if (walk.active && !walk.route.empty()) {
+            walk.next = pathFinder.repair(&walk.route, walk.next - 1,
+                                          walk.goal) ? 1 : 0;
+        }
+    }
+}
+
+void GameEngine::eliminateBlock(const Cell &cell)
+{
+    setCell(cell, BlockType::kEmpty, 0);
+    pairIndex.removeBlock(cell);
+    regionIndex.removeBlock(cell);
+    for (auto &field: distanceFields) {
+        field.removeBlock(cell);
+    }
+}
+
+void GameEngine::changeBoard()
+{
+    ++boardVersion;
+    notify([](GameListener *l) { l->boardChanged(); });
+    if (!externalAnalysis) {
+        analysis = analyze();
+        applyAnalysis();
+    }
+}
+
+BoardAnalysis GameEngine::analyze()
+{
+    BoardAnalysis result;
+    result.version = boardVersion;
+    result.stuck = true;
+    for (int i = 0; i < playerCount(); ++i) {
+        DistanceField &field = distanceFields[i];
+        field.setSource(cellOf(players[i]));
+        field.refresh();
+        result.hasHint[i] = findCheapestPairs(gameBoard, pairIndex, field, 1,
+                                              &cheapest) > 0;
+        if (result.hasHint[i]) {
+            result.hints[i] = cheapest[0];
+        }
+        result.stuck = result.stuck && !result.hasHint[i];
+    }
+    return result;
+}
+
+void GameEngine::applyAnalysis()
+{
+    if (analysis.version != boardVersion) {
+        return;
+    }
+
+#ifdef QLINK_VERIFY_PAIR_INDEX
+    Cell a;
+    Cell b;
+    assert(hasNextStep(&a, &b) == !analysis.stuck);
+#endif
+
+    if (analysis.stuck) {
+        if (running && !over && nBlocksRemaining) {
+            finish(GameOutcome::kNoMoreMatch);
+        }
+        return;
+    }
+    if (hint && hintPending) {
+        showHint();
+    }
+}
+
+void GameEngine::finish(const GameOutcome outcome)
+{
+    this->over = true;
+    for (auto &walk: autoWalks) {
+        walk = AutoWalk();
+    }
+    notify([outcome](GameListener *l) { l->gameOver(outcome); });
+}
+
+bool GameEngine::generatePlayer(const WhichPlayer which)
+{
+    PlayerState &player = players[slot(which)];
+
+    // Generated maps come with a spawn point for each player, from which all
+    // blocks can be walked up to.
+    if (slot(which) < static_cast<int>(spawnPoints.size())) {
+        const Cell &cell = spawnPoints[slot(which)];
+        player.x = cell.c * kCellSize + (kCellSize >> 1);
+        player.y = cell.r * kCellSize + (kCellSize >> 1);
+        return true;
+    }
+
+    // Look through the empty cells from a random one on, and give up once
+    // all of them have been looked at.
+    const int n = freeCells.size();
+    const int start = n ? random.uniform(kPlayerStream, 0, n) : 0;
+    for (int i = 0; i < n; ++i) {
+        const Cell cell = freeCells.at((start + i) % n);
+        const int row = cell.r;
+        const int col = cell.c;
+
+        // Never generate player beside the edge, or surrounded by blocks.
+        if (!row || row == kMaxRows - 1 || !col || col == kMaxCols - 1) {
+            continue;
+        }
+        if (gameBoard.type(row - 1, col) != BlockType::kEmpty &&
+            gameBoard.type(row + 1, col) != BlockType::kEmpty &&
+            gameBoard.type(row, col - 1) != BlockType::kEmpty &&
+            gameBoard.type(row, col + 1) != BlockType::kEmpty) {
+            continue;
+        }
+
+        player.x = col * kCellSize + (kCellSize >> 1);
+        player.y = row * kCellSize + (kCellSize >> 1);
+        return true;
+    }
+    return false;
+}
+
+void GameEngine::validate(const WhichPlayer which, const Cell &a,
+                          const Cell &b)
+{
+    LinkPath path;
+    if (!checkMatch(a, b, &path)) {
+        choosers[cellIndex(a)] = WhichPlayer::kNoPlayer;
+        choosers[cellIndex(b)] = WhichPlayer::kNoPlayer;
+        notify([&a, &b](GameListener *l) {
+            l->cellChanged(a);
+            l->cellChanged(b);
+        });
+        return;
+    }
+
+    PlayerState &player = players[slot(which)];
+    player.score += kScorePerMatch;
+    const int score = player.score;
+    notify([which, score, &path](GameListener *l) {
+        l->scoreChanged(which, score);
+        l->linked(which, path);
+    });
+
+    eliminateBlock(a);
+    eliminateBlock(b);
+    nBlocksRemaining -= 2;
+    assert(!(nBlocksRemaining & 1) && nBlocksRemaining >= 0);
+
+    // Check for game end. Dead ends are found by the analysis.
+    if (!nBlocksRemaining) {
+        finish(GameOutcome::kAllMatched);
+    }
+    changeBoard();
+
+    // Check for hint.
+    if (hint && (isHint(a) || isHint(b))) {
+        generateHint();
+    }
+}
+
+void GameEngine::changeTime(const int dsec)
+{
+    this->nTimeRemaining += dsec;
+    const int time = nTimeRemaining;
+    notify([time](GameListener *l) { l->timeChanged(time); });
+
+    if (nTimeRemaining <= 0) {
+        finish(GameOutcome::kOutOfTime);
+    }
+}
+
+void GameEngine::spawnItem()
+{
+    const int rand = random.uniform(kItemStream, 0, 3);
+    const ItemType t = (rand == 0) ? ItemType::kExtend30s :
+                            (rand == 1) ? ItemType::kShuffle :
+                                ItemType::kHint;
+
+    // Players stand on empty cells, which are left out of the draw.
+    std::vector<Cell> playerCells;
+    for (int i = 0; i < playerCount(); ++i) {
+        const Cell cell = cellOf(players[i]);
+        if (freeCells.contains(cell)) {
+            freeCells.erase(cell);
+            playerCells.push_back(cell);
+        }
+    }
+
+    // No item spawns on a full map.
+    if (!freeCells.empty()) {
+        const Cell cell = freeCells.at(
+                    random.uniform(kItemStream, 0, freeCells.size()));
+        setCell(cell, BlockType::kItem, t);
+    }
+
+    for (const Cell &cell: playerCells) {
+        freeCells.insert(cell);
+    }
+}
+
+void GameEngine::consumeItem(const WhichPlayer which, const Cell &cell)
+{
+    // Both corners of a player may touch the same item.
+    if (gameBoard.type(cell.r, cell.c) != BlockType::kItem) {
+        return;
+    }
+
+    // The item goes before it takes effect, so that a shuffle does not move
+    // it away first.
+    const BlockContent item = gameBoard.content(cell.r, cell.c);
+    setCell(cell, BlockType::kEmpty, 0);
+    switch (item) {
+    case ItemType::kExtend30s:
+        changeTime(kExtendSeconds);
+        break;
+    case ItemType::kShuffle:
+        shuffle();
+        break;
+    case ItemType::kHint:
+        enableHint(which);
+        break;
+    default:
+        break;
+    }
+}
+
+void GameEngine::shuffle()
+{
+    const int range = kPlayerSize >> 1;
+
+    // Cells that the players stand on, and the cells they cover, which are
+    // kept empty.
+    std::vector<Cell> standing;
+    std::vector<Cell> covered;
+    for (int i = 0; i < playerCount(); ++i) {
+        const PlayerState &player = players[i];
+        standing.push_back(cellOf(player));
+        for (const int x: { player.x - range, player.x + range - 1 }) {
+            for (const int y: { player.y - range, player.y + range - 1 }) {
+                const Cell corner = cellAt(x, y);
+                if (corner.r < kMaxRows && corner.c < kMaxCols) {
+                    covered.push_back(corner);
+                }
+            }
+        }
+    }
+    covered.insert(covered.end(), standing.begin(), standing.end());
+
+    // The shuffler already retries and repairs until the players have a pair
+    // to start with, if the map allows.
+    Board best = gameBoard;
+    const ShuffleResult shuffled = boardShuffler.shuffle(
+                &best, standing, covered, turns,
+                random.stream(kShuffleStream)());
+    const std::vector<Cell> &bestChanged = shuffled.changed;
+
+    // Only the cells whose contents have changed are told about. A choice
+    // does not survive a change of its block.
+    gameBoard.beginUpdate();
+    for (const Cell &cell: bestChanged) {
+        setCell(cell, best.type(cell.r, cell.c), best.content(cell.r, cell.c));
+    }
+    gameBoard.endUpdate();
+    for (int i = 0; i < playerCount(); ++i) {
+        Cell &chosen = players[i].chosen;
+        if (!isNone(chosen) &&
+            choosers[cellIndex(chosen)] == WhichPlayer::kNoPlayer) {
+            chosen = { -1, -1 };
+        }
+    }
+    rebuild();
+    changeBoard();
+
+    // Regenerate hint.
+    if (hint) {
+        generateHint();
+    }
+}
+
+void GameEngine::enableHint(const WhichPlayer which)
+{
+    this->hint = true;
+    this->hintFor = which;
+    this->hintTicks = kHintTicks;
+    generateHint();
+}
+
+void GameEngine::stopHint()
+{
+    this->hint = false;
+    this->hintFor = WhichPlayer::kNoPlayer;
+    this->hintPending = false;
+    removeCurrentHint();
+}
+
+void GameEngine::generateHint()
+{
+    // Remove current hint.
+    removeCurrentHint();
+
+    // Wait for the analysis of the current board.
+    if (analysis.version != boardVersion) {
+        hintPending = true;
+        return;
+    }
+    showHint();
+}
+
+void GameEngine::showHint()
+{
+    assert(analysis.version == boardVersion);
+    hintPending = false;
+
+    // Try the player the hint is for first. A board without any hint is
+    // stuck, which `applyAnalysis` takes care of.
+    for (int i = 0; i < playerCount(); ++i) {
+        const int which =
+                (!i && hintFor != WhichPlayer::kPlayer2) ||
+                (i && hintFor == WhichPlayer::kPlayer2) ? 0 : 1;
+        if (analysis.hasHint[which]) {
+            hintPair[0] = analysis.hints[which].first;
+            hintPair[1] = analysis.hints[which].second;
+            notify([this](GameListener *l) {
+                l->cellChanged(hintPair[0]);
+                l->cellChanged(hintPair[1]);
+            });
+            return;
+        }
+    }
+}
+
+void GameEngine::removeCurrentHint()
+{
+    const Cell old[2] = { hintPair[0], hintPair[1] };
+    hintPair[0] = hintPair[1] = { -1, -1 };
+    for (const Cell &cell: old) {
+        if (!isNone(cell)) {
+            notify([&cell](GameListener *l) { l->cellChanged(cell); });
+        }
+    }
+}
+
+void GameEngine::stepAutoWalk(const WhichPlayer which)
+{
+    AutoWalk &walk = autoWalks[slot(which)];
+    const PlayerState &player = players[slot(which)];
+    if (!walk.active) {
+        return;
+    }
+
+    // The walk is over once the pair is gone. Follow the hint if it moves on
+    // to another pair before that.
+    if (gameBoard.type(walk.targets[0].r, walk.targets[0].c) !=
+            BlockType::kBlock ||
+        gameBoard.type(walk.targets[1].r, walk.targets[1].c) !=
+            BlockType::kBlock) {
+        walk.active = false;
+        return;
+    }
+    if (!isNone(hintPair[0]) && !isNone(hintPair[1]) &&
+        (!isSame(hintPair[0], walk.targets[0]) ||
+         !isSame(hintPair[1], walk.targets[1]))) {
+        walk.targets[0] = hintPair[0];
+        walk.targets[1] = hintPair[1];
+        walk.route.clear();
+    }
+
+    // Go for the block the player has not chosen yet.
+    const Cell goal = isSame(player.chosen, walk.targets[0]) ?
+                walk.targets[1] : walk.targets[0];
+    const Cell here = cellOf(player);
+
+    // Plan again if the target has changed or the player has strayed from
+    // the route.
+    const int n = static_cast<int>(walk.route.size());
+    const auto isAt = [&here](const Cell &cell) {
+        return isSame(cell, here);
+    };
+    if (walk.route.empty() || !isSame(goal, walk.goal) ||
+        !walk.next || (!isAt(walk.route[walk.next - 1]) &&
+                       (walk.next == n || !isAt(walk.route[walk.next])))) {
+        walk.goal = goal;
+        walk.next = 1;
+        if (!pathFinder.findRoute(here, goal, &walk.route)) {
+            walk.active = false;
+            return;
+        }
+    }
+
+    if (walk.next < static_cast<int>(walk.route.size())) {
+        const Cell &from = walk.route[walk.next - 1];
+        const Cell &to = walk.route[walk.next];
+        if (!stepTowards(which, to, from.r == to.r, false)) {
+            ++walk.next;
+        }
+        return;
+    }
+
+    // Next to the target: line up with the cell, then walk into the block,
+    // which chooses it. Walking into it may take a few steps.
+    const Cell &last = walk.route.back();
+    const Direction d = goal.r < last.r ? Direction::kUp :
+                        goal.r > last.r ? Direction::kDown :
+                        goal.c < last.c ? Direction::kLeft :
+                                          Direction::kRight;
+    const bool horizontal = d == Direction::kLeft || d == Direction::kRight;
+    if (!stepTowards(which, last, horizontal, true)) {
+        move(which, d);
+    }
+}
+
+bool GameEngine::stepTowards(const WhichPlayer which, const Cell &cell,
+                             const bool horizontal, const bool lineUpOnly)
+{
+    const PlayerState &player = players[slot(which)];
+    const int dx = cell.c * kCellSize + (kCellSize >> 1) - player.x;
+    const int dy = cell.r * kCellSize + (kCellSize >> 1) - player.y;
+    const Direction vertical = dy < 0 ? Direction::kUp : Direction::kDown;
+    const Direction sideways = dx < 0 ? Direction::kLeft : Direction::kRight;
+
+    if (std::abs(horizontal ? dy : dx) >= kMoveStep) {
+        move(which, horizontal ? vertical : sideways);
+        return true;
+    }
+    if (!lineUpOnly && std::abs(horizontal ? dx : dy) >= kMoveStep) {
+        move(which, horizontal ? sideways : vertical);
+        return true;
+    }
+    return false;
+}
+
+Cell GameEngine::distinguishCollision(const PlayerState &player,
+                                      const Cell &a, const Cell &b,
+                                      const Direction d)
+{
+    // Centers of cells, rounded towards the top left as a widget's are.
+    const int center = (kCellSize - 1) >> 1;
+    const bool chooseX = (d == Direction::kUp || d == Direction::kDown);
+    const int playerPos = chooseX ? player.x : player.y;
+    const int aPos = (chooseX ? a.c : a.r) * kCellSize + center;
+    const int bPos = (chooseX ? b.c : b.r) * kCellSize + center;
+
+    const int distToA = std::abs(playerPos - aPos);
+    const int distToB = std::abs(playerPos - bPos);
+
+    return distToA < distToB ? a :
+                distToA > distToB ? b :
+                    Cell { -1, -1 };
+}
+
+bool GameEngine::checkCollision(const int x, const int y, Cell *cell) const
+{
+    *cell = { -1, -1 };
+
+    if (x >= kMaxCols * kCellSize || y >= kMaxRows * kCellSize) {
+        return true;
+    }
+
+    const Cell rc = cellAt(x, y);
+    if (gameBoard.isObstacle(gameBoard.index(rc))) {
+        *cell = rc;
+        return true;
+    }
+    return false;
+}
+
+bool GameEngine::checkItem(const int x, const int y, Cell *cell) const
+{
+    *cell = { -1, -1 };
+
+    if (x >= kMaxCols * kCellSize || y >= kMaxRows * kCellSize) {
+        return true;
+    }
+
+    // Items are drawn kItemSize to a side around the center of their cell.
+    const Cell rc = cellAt(x, y);
+    const int left = rc.c * kCellSize + ((kCellSize - 1) >> 1) -
+                     (kItemSize >> 1);
+    const int top = rc.r * kCellSize + ((kCellSize - 1) >> 1) -
+                    (kItemSize >> 1);
+    if (gameBoard.type(rc.r, rc.c) == BlockType::kItem &&
+        x >= left && x < left + kItemSize && y >= top && y < top + kItemSize) {
+        *cell = rc;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,528 @@
+#ifndef GAMEENGINE_H
+#define GAMEENGINE_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "board.h"
+#include "boardshuffler.h"
+#include "distancefield.h"
+#include "freecells.h"
+#include "gamerandom.h"
+#include "linkchecker.h"
+#include "mappool.h"
+#include "moveenumerator.h"
+#include "pairindex.h"
+#include "pathfinder.h"
+#include "regionindex.h"
+#include "types.h"
+
+class UnitTest;
+
+// Copy of the game state that an analysis needs. Never modified once it has
+// been submitted, so the worker thread can read it without locking.
+struct BoardSnapshot {
+    // Increases with every change of the board, see `BoardAnalysis`.
+    uint64_t version;
+
+    Board board;
+
+    // Links allowed by the rules of the game.
+    int maxTurns;
+
+    // Cells of player 1 and player 2, with a negative row for a player that
+    // is not in the game.
+    Cell players[2];
+};
+
+// Result of the analysis of a snapshot.
+struct BoardAnalysis {
+    // Version of the analyzed snapshot. Results for older versions are stale
+    // and must be dropped.
+    uint64_t version = 0;
+
+    // True if neither player can reach a pair of blocks that can be linked.
+    bool stuck = false;
+
+    // Whether each player has a hint, and the two blocks of the hint, the one
+    // nearer to the player first. The hint is the pair that the player can
+    // walk up to in the fewest steps, see `findCheapestPairs`.
+    bool hasHint[2] = { false, false };
+    std::pair<Cell, Cell> hints[2];
+};
+
+// A player of a game. Positions are in the units of `GameEngine`.
+struct PlayerState {
+    // Coordinates of the center of the player.
+    int x = 0;
+    int y = 0;
+
+    int score = 0;
+
+    // Cell of the block this player has chosen, with a negative row if none.
+    Cell chosen = { -1, -1 };
+};
+
+// State of a player walking to the hinted pair on its own, see
+// `GameEngine::stepAutoWalk`.
+struct AutoWalk {
+    bool active = false;
+
+    // The pair being walked to, the nearer block first.
+    Cell targets[2] = { { -1, -1 }, { -1, -1 } };
+
+    // Cell of the block that <route> leads up to.
+    Cell goal = { -1, -1 };
+
+    // Cells to walk along, and the index of the next one to step onto.
+    std::vector<Cell> route;
+    int next = 0;
+};
+
+// Receives the changes of a `GameEngine`. Every callback does nothing unless
+// overridden, so a listener only overrides what it shows.
+class GameListener {
+public:
+    virtual ~GameListener() {}
+
+    // A new game has been set up or a saved one loaded. Everything may have
+    // changed, and is read afresh from the engine.
+    virtual void gameReset() {}
+
+    // Type, content, choosing player or hint mark of a cell has changed.
+    virtual void cellChanged(const Cell &) {}
+
+    // A player has moved.
+    virtual void playerMoved(const WhichPlayer) {}
+
+    virtual void scoreChanged(const WhichPlayer, const int) {}
+    virtual void timeChanged(const int) {}
+
+    // A player has linked and eliminated the two blocks at the ends of a
+    // path.
+    virtual void linked(const WhichPlayer, const LinkPath &) {}
+
+    // The board has changed in a way that affects pairs or reachability.
+    // With external analysis, see `GameEngine::setExternalAnalysis`, this is
+    // the time to take a `GameEngine::snapshot`.
+    virtual void boardChanged() {}
+
+    virtual void gameOver(const GameOutcome) {}
+};
+
+// The rules of the game, without a user interface: the board, the players,
+// the clock, items, hints, scoring and saving. A user interface issues
+// commands, such as `move`, `choose` and `tick`, and shows what its listeners
+// are told.
+//
+// Time advances by ticks of kTickMsec milliseconds, which the caller issues
+// while the game is running, so that a game can be played as fast as the
+// machine allows. Positions are in units, kCellSize to a side of a cell,
+// which are pixels to the game window.
+class GameEngine {
+    friend class UnitTest;
+
+public:
+    // Number of groups all the blocks fall into. Blocks of the same group can
+    // eliminate one another.
+    static const int kTypeNum = 5;
+
+    // Initial remaining time when the game starts, in seconds.
+    static const int kInitialTime = 60;
+
+    // Number of rows in the map.
+    static const int kMaxRows = 15;
+
+    // Number of columns in the map.
+    static const int kMaxCols = 30;
+
+    // Number of blocks in the map.
+    static const int kBlockNum = 200;
+
+    // Number of blocks each group. Each group has equal number of blocks at the
+    // beginning.
+    static const int kBlocksPerType = kBlockNum / kTypeNum;
+
+    // The number of scores that a player gets each time a match is found.
+    static const int kScorePerMatch = 5;
+
+    // Maximum number of turns for a link that connects two blocks of the same
+    // type to eliminate them, unless a game asks for another limit.
+    static const int kDefaultMaxTurns = 2;
+
+    // Whether links may run around the outside of the map, unless a game asks
+    // otherwise.
+    static const bool kDefaultBorderRouting = false;
+
+    // The probability (percent) that a new item is spawned at a random position
+    // on the map each second.
+    static const int kSpawnItemProbability = 40;
+
+    // Seconds added to the clock by an extend item.
+    static const int kExtendSeconds = 30;
+
+    // Length of a tick in milliseconds, and ticks to a second.
+    static const int kTickMsec = 20;
+    static const int kTicksPerSecond = 1000 / kTickMsec;
+
+    // Number of ticks for which hints keep showing up. That means if a
+    // highlighted pair is eliminated, another pair is chosen and highlighted.
+    static const int kHintTicks = 10 * kTicksPerSecond;
+
+    // Side of a cell, of a player and of an item, in units.
+    static const int kCellSize = 40;
+    static const int kPlayerSize = 20;
+    static const int kItemSize = 20;
+
+    // Number of units that a player moves on each step.
+    static const int kMoveStep = 2;
+
+    GameEngine();
+
+    GameEngine(const GameEngine &) = delete;
+    GameEngine &operator=(const GameEngine &) = delete;
+
+    // Size and blocks of the maps of new games, for generating them ahead of
+    // time.
+    static GeneratorOptions mapOptions();
+
+    // Tell <listener> about every change from now on, or no longer.
+    void addListener(GameListener *listener);
+    void removeListener(GameListener *listener);
+
+    // Let dead ends and hints be found by whoever listens to `boardChanged`,
+    // and handed back through `setAnalysis`, rather than by the engine right
+    // after every change. A game window does so to keep dense boards from
+    // freezing it.
+    void setExternalAnalysis(const bool enabled);
+
+    // Set up a game of <mode> on <map>, with the turn limit, routing mode and
+    // seed <map> was generated for. The game is stopped until `start`.
+    void newGame(const GameMode mode, const PooledMap &map);
+
+    // Write the game to <out>, or set it up from <in>, stopped. Returns false,
+    // leaving the engine as it was, if <in> is malformed. Saves from before
+    // turn limits, routing modes or seeds were saved are read with the
+    // defaults.
+    void save(std::ostream &out) const;
+    bool load(std::istream &in);
+
+    // Let the commands below take effect, or ignore them while the game is
+    // paused. A dead end found while paused ends the game on `start`.
+    void start();
+    void pause();
+
+    // Advance the game by a tick: take a step of every auto-walk, count down
+    // the hint and the clock, and possibly spawn an item once a second.
+    void tick();
+
+    // Move player <which> kMoveStep units in direction <d>. Walking into a
+    // block chooses it, and walking over an item consumes it.
+    void move(const WhichPlayer which, const Direction d);
+
+    // Let player <which> choose the block at <cell>, as when walking into
+    // it. Choosing a second block links the two if they match, and takes
+    // both choices back otherwise. Does nothing if the block has been chosen
+    // by the other player.
+    void choose(const WhichPlayer which, const Cell &cell);
+
+    // Start walking player <which> to the hinted pair, or stop if it already
+    // is. Does nothing unless a hint is shown.
+    void toggleAutoWalk(const WhichPlayer which);
+    void stopAutoWalk(const WhichPlayer which);
+
+    // Take <analysis> of a snapshot, see `setExternalAnalysis`. Dropped if the
+    // board has changed since the snapshot was taken.
+    void setAnalysis(const BoardAnalysis &analysis);
+
+    // Copy of the current board and players, for analyzing elsewhere.
+    std::shared_ptr<BoardSnapshot> snapshot() const;
+
+    // Given two blocks, check if they can be matched. This includes checking
+    // block type, block content, their position, and choosing player.
+    // They they can be catched and <path> is not null, return the corners of
+    // the path that connects two blocks.
+    bool checkMatch(const Cell &a, const Cell &b, LinkPath *path);
+
+    // Check synchronously if there's still a pair of blocks that can be
+    // matched and reached by player. Returns true and populates <a> and <b>
+    // with the two blocks if such a pair exists. Pairs of the player the hint
+    // is for are favored, and among them the one that `cheapestPairs` ranks
+    // first.
+    // Define QLINK_VERIFY_PAIR_INDEX to cross-check every answer against
+    // `scanNextStep`, and every dead end found by an analysis against this
+    // function.
+    bool hasNextStep(Cell *a, Cell *b);
+
+    // The <k> pairs of blocks that can be matched and that player <which> can
+    // walk up to in the fewest steps, cheapest first, the nearer block of each
+    // pair first. Empty if there are none or the player is not in the game.
+    // Meant for hints, the UI and computer players.
+    std::vector<std::pair<Cell, Cell>> cheapestPairs(const WhichPlayer which,
+                                                     const int k);
+
+    // Same as `hasNextStep`, but searches all posibilities instead of using
+    // <pairIndex>, and favors the pair whose block comes first by
+    // `nearestRank` rather than by walking cost. Each candidate block costs a
+    // single `LinkChecker::connectAll` sweep, whose result is intersected with
+    // the blocks of the same content. Sweeps run on <moveEnumerator> in the
+    // order of `nearestRank`, and stop once a nearer block has found a
+    // partner.
+    bool scanNextStep(Cell *a, Cell *b);
+
+    const Board &board() const;
+    GameMode mode() const;
+    int maxTurns() const;
+    uint64_t seed() const;
+
+    // Number of players in the game, 1 or 2.
+    int playerCount() const;
+    const PlayerState &player(const WhichPlayer which) const;
+
+    // The player that has chosen the block at <cell>.
+    WhichPlayer chosenBy(const Cell &cell) const;
+
+    // Returns true if the block at <cell> is highlighted as hint.
+    bool isHint(const Cell &cell) const;
+
+    bool isRunning() const;
+    bool isOver() const;
+
+    // Number of blocks that has not been eliminated.
+    int blocksRemaining() const;
+
+    // The number of seconds remaining before time runs out.
+    int timeRemaining() const;
+
+    // Returns the cell at coordinates <x>, <y>, which may be one past the
+    // last row or column on the bottom and right edges of the map.
+    static Cell cellAt(const int x, const int y);
+
+private:
+    std::vector<GameListener *> listeners;
+
+    GameMode gameMode;
+
+    // Maximum number of turns for a link in the current game, from 0 to
+    // LinkChecker::kMaxTurnLimit.
+    int turns;
+
+    Board gameBoard;
+
+    // The player that has chosen each cell of <gameBoard>, by `cellIndex`.
+    std::vector<WhichPlayer> choosers;
+
+    // Connectivity engine that runs on <gameBoard>.
+    LinkChecker linkChecker;
+
+    // Runs sweeps over <gameBoard> on all cores, for `scanNextStep` and
+    // rebuilds of <pairIndex>.
+    MoveEnumerator moveEnumerator;
+
+    // Pairs of blocks on <gameBoard> that can currently be eliminated.
+    // Rebuilt by `rebuild` on <moveEnumerator>, updated incrementally on
+    // every elimination.
+    PairIndex pairIndex;
+
+    // Regions of <gameBoard> that players can walk in. Rebuilt by `rebuild`,
+    // merged on every elimination.
+    RegionIndex regionIndex;
+
+    // Empty cells of <gameBoard>, where items and players can be placed. Kept
+    // by `setCell`, rebuilt by `rebuild`.
+    FreeCells freeCells;
+
+    // Walking distances from player 1 and player 2, for `cheapestPairs`.
+    // Searched again only once a player steps onto another cell or the board
+    // is rebuilt, repaired on every elimination.
+    DistanceField distanceFields[2];
+
+    // Plans the routes of <autoWalks>.
+    PathFinder pathFinder;
+
+    // Auto-walks of player 1 and player 2.
+    AutoWalk autoWalks[2];
+
+    // Draws the candidate arrangements of `shuffle`.
+    BoardShuffler boardShuffler;
+
+    // Random numbers of the game. Reseeded for every new game, and saved
+    // along with it.
+    GameRandom random;
+
+    // Cells that the players of the current map start on, player 1 first.
+    std::vector<Cell> spawnPoints;
+
+    PlayerState players[2];
+
+    bool running;
+    bool over;
+
+    int nBlocksRemaining;
+    int nTimeRemaining;
+
+    // Ticks into the current second.
+    int secondTicks;
+
+    // Indicates whether the hint item has been activated, the player the
+    // hint is for, and the number of ticks before it expires.
+    bool hint;
+    WhichPlayer hintFor;
+    int hintTicks;
+
+    // The pair of blocks that are highlighted as hint, with negative rows if
+    // there is none.
+    Cell hintPair[2];
+
+    // True if a hint has been asked for before the current board has been
+    // analyzed. It is shown as soon as the analysis arrives.
+    bool hintPending;
+
+    // See `setExternalAnalysis`.
+    bool externalAnalysis;
+
+    // Incremented on every change of <gameBoard> that affects pairs or
+    // reachability, so that stale analyses can be told apart.
+    uint64_t boardVersion;
+
+    // The latest analysis. Only describes <gameBoard> if its version equals
+    // <boardVersion>.
+    BoardAnalysis analysis;
+
+    // Scratch space of `analyze`.
+    std::vector<std::pair<Cell, Cell>> cheapest;
+
+    // Call <f> with every listener.
+    template <typename F>
+    void notify(F f)
+    {
+        for (GameListener *listener: listeners) {
+            f(listener);
+        }
+    }
+
+    // Index of player <which> in <players>, <distanceFields> and <autoWalks>.
+    static int slot(const WhichPlayer which);
+
+    // Player <i> of <players>.
+    static WhichPlayer playerAt(const int i);
+
+    int cellIndex(const Cell &cell) const;
+
+    static bool isNone(const Cell &cell);
+    static bool isSame(const Cell &a, const Cell &b);
+
+    // Cell under the center of <player>.
+    static Cell cellOf(const PlayerState &player);
+
+    // Set the turn limit of the current game, which picks the link kernel of
+    // <linkChecker> once for the whole game.
+    void setMaxTurns(const int maxTurns);
+
+    // Set <cell> to <t>, <bc>, taking back any choice of it, and keep
+    // <freeCells> in sync.
+    void setCell(const Cell &cell, const BlockType t, const BlockContent bc);
+
+    // Rebuild <freeCells> and the indices from <gameBoard>. Must be called
+    // whenever blocks are replaced or moved as a whole, i.e. on new map,
+    // shuffle and load.
+    void rebuild();
+
+    // Eliminate the block at <cell>, and update <pairIndex>, <regionIndex>
+    // and <distanceFields>.
+    void eliminateBlock(const Cell &cell);
+
+    // Bump <boardVersion>, and have the board analyzed. Must be called after
+    // every change of <gameBoard> that affects pairs or reachability.
+    void changeBoard();
+
+    // Find the hints and dead ends of the current board, as an analysis of a
+    // snapshot would, on the indices of the engine.
+    BoardAnalysis analyze();
+
+    // Act on <analysis> if it is current: end a game that is stuck, or show a
+    // pending hint.
+    void applyAnalysis();
+
+    // End the game with <outcome>.
+    void finish(const GameOutcome outcome);
+
+    // Place player <which> at its spawn point, or at a random cell of
+    // <freeCells> if there is none. Returns true if there's a valid position
+    // for the character, i.e. an empty cell away from the edge that is not
+    // surrounded by four blocks. Player is always positioned at the center of
+    // the cell.
+    bool generatePlayer(const WhichPlayer which);
+
+    // Linked or not, a player is done with the two blocks it has chosen:
+    // eliminate them if they match, take the choices back otherwise.
+    void validate(const WhichPlayer which, const Cell &a, const Cell &b);
+
+    // Add <dsec> to the time remaining. The game ends once none is left.
+    void changeTime(const int dsec);
+
+    // Spawn an item of random type at a random empty cell that no player
+    // stands on.
+    void spawnItem();
+
+    // Invoked when player <which> has geometrically 'touched' the item at
+    // <cell>: remove the item, then take its effect.
+    void consumeItem(const WhichPlayer which, const Cell &cell);
+
+    // Shuffle the contents of all blocks and items on the map, keeping the
+    // cells under the players empty. Every arrangement has a pair that a
+    // player can walk up to and link if the map allows. Arrangements are not
+    // played out, which would take far longer than a frame. If hint is
+    // enabled, a new pair of hint will be generated.
+    void shuffle();
+
+    // Enable hint for kHintTicks, during which pairs of blocks will constantly
+    // be highlighted next to player <which>.
+    void enableHint(const WhichPlayer which);
+    void stopHint();
+
+    // Highlight a pair for the hint, taken from the analysis of the current
+    // board, or once that arrives, so this never searches.
+    void generateHint();
+
+    // Highlight the hint of <analysis>, which must be current.
+    void showHint();
+
+    // Remove current highlighted blocks.
+    void removeCurrentHint();
+
+    // Take one step of the auto-walk of <which>, if it is on one. The route
+    // to the next block of the pair is planned once, and only searched again
+    // if the hint, the player's cell or the board changes, so that a step
+    // costs next to nothing. Standing next to the block, the player walks
+    // into it to choose it. The walk ends once the pair is gone.
+    void stepAutoWalk(const WhichPlayer which);
+
+    // Move <which> one step towards the center of <cell>, lining it up with
+    // the center on the other axis first when going <horizontal>ly, so that
+    // it never clips a corner. If <lineUpOnly>, stops once lined up. Returns
+    // false if it is there already.
+    bool stepTowards(const WhichPlayer which, const Cell &cell,
+                     const bool horizontal, const bool lineUpOnly);
+
+    // Invoked when player hits two blocks at the same time. In the case, the
+    // player is considered to choose the block whose geometric center is
+    // closer to the player's geometric center. Returns a negative row if they
+    // are equally close.
+    static Cell distinguishCollision(const PlayerState &player,
+                                     const Cell &a, const Cell &b,
+                                     const Direction d);
+
+    // Returns true if point (<x>, <y>) is in a block or off the map. If in a
+    // block, <cell> is set to its cell, and to a negative row otherwise.
+    bool checkCollision(const int x, const int y, Cell *cell) const;
+
+    // Returns true if point (<x>, <y>) is in an item or off the map. If in an
+    // item, <cell> is set to its cell, and to a negative row otherwise.
+    bool checkItem(const int x, const int y, Cell *cell) const;
+};
+
+#endif // GAMEENGINE_H
@@ -0,0 +1,76 @@
+#include "gamerandom.h"
+
+#include <cassert>
+#include <random>
+
+GameRandom::GameRandom(const uint64_t seed)
+{
+    reseed(seed);
+}
+
+void GameRandom::reseed(const uint64_t seed)
+{
+    this->gameSeed = seed;
+    streams[0].seed(seed);
+    for (int i = 1; i < kStreams; ++i) {
+        streams[i] = streams[i - 1];
+        streams[i].jump();
+    }
+}
+
+uint64_t GameRandom::seed() const
+{
+    return this->gameSeed;
+}
+
+Xoshiro256 &GameRandom::stream(const RandomStream which)
+{
+    return streams[which];
+}
+
+int GameRandom::uniform(const RandomStream which, const int min,
+                        const int max)
+{
+    assert(min < max);
+    return min + static_cast<int>(streams[which].below(
+                                      static_cast<uint64_t>(max - min)));
+}
+
+std::array<uint64_t, 4 * GameRandom::kStreams> GameRandom::state() const
+{
+    std::array<uint64_t, 4 * kStreams> result;
+    for (int i = 0; i < kStreams; ++i) {
+        const std::array<uint64_t, 4> words = streams[i].state();
+        for (int j = 0; j < 4; ++j) {
+            result[4 * i + j] = words[j];
+        }
+    }
+    return result;
+}
+
+void GameRandom::setState(const uint64_t seed,
+                          const std::array<uint64_t, 4 * kStreams> &state)
+{
+    this->gameSeed = seed;
+    for (int i = 0; i < kStreams; ++i) {
+        streams[i].setState({ state[4 * i], state[4 * i + 1],
+                              state[4 * i + 2], state[4 * i + 3] });
+    }
+}
+
+bool GameRandom::isValidState(const std::array<uint64_t, 4 * kStreams> &state)
+{
+    for (int i = 0; i < kStreams; ++i) {
+        if (!state[4 * i] && !state[4 * i + 1] && !state[4 * i + 2] &&
+            !state[4 * i + 3]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t GameRandom::freshSeed()
+{
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+}
@@ -0,0 +1,51 @@
+#ifndef GAMERANDOM_H
+#define GAMERANDOM_H
+
+#include <array>
+#include <cstdint>
+
+#include "types.h"
+#include "xoshiro256.h"
+
+// The random numbers of one game, all derived from a single seed. Each
+// RandomStream draws from a generator of its own, jumped apart from the
+// others, so that drawing more numbers for one purpose, such as an extra item
+// spawn, leaves the numbers of the others as they are. A seed and the inputs
+// of the players therefore reproduce a game.
+class GameRandom {
+public:
+    // Number of streams.
+    static const int kStreams = kPlayerStream + 1;
+
+    explicit GameRandom(const uint64_t seed = 0);
+
+    // Restart all streams from <seed>.
+    void reseed(const uint64_t seed);
+
+    // The seed of the game.
+    uint64_t seed() const;
+
+    Xoshiro256 &stream(const RandomStream which);
+
+    // A uniformly random integer in [<min>, <max>) from stream <which>.
+    int uniform(const RandomStream which, const int min, const int max);
+
+    // State of all streams, stream by stream, for saving a game halfway.
+    // Only a valid state may be set, see `isValidState`.
+    std::array<uint64_t, 4 * kStreams> state() const;
+    void setState(const uint64_t seed,
+                  const std::array<uint64_t, 4 * kStreams> &state);
+
+    // Returns false if a stream of <state> is all zero, from which it would
+    // draw nothing but zeros. A state read from a file must be checked.
+    static bool isValidState(const std::array<uint64_t, 4 * kStreams> &state);
+
+    // A seed from the entropy source of the system, for new games.
+    static uint64_t freshSeed();
+
+private:
+    uint64_t gameSeed;
+    Xoshiro256 streams[kStreams];
+};
+
+#endif // GAMERANDOM_H
@@ -1,6 +1,14 @@
 #include "gamewindow.h"
+
+#include <fstream>
+
 #include "utils.h"
 
+const QMap<WhichPlayer, int> GameWindow::kAutoWalkKey = {
+    { WhichPlayer::kPlayer1, 'F' },
+    { WhichPlayer::kPlayer2, Qt::Key_Return }
+};
+
 const QMap<WhichPlayer, QMap<Direction, int>> GameWindow::kKeyMapping = {
     {
         WhichPlayer::kPlayer1, {
@@ -23,32 +31,29 @@ const QMap<WhichPlayer, QMap<Direction, int>> GameWindow::kKeyMapping = {
 GameWindow::GameWindow(const unique_ptr<UiConfig> &config, QWidget *parent):
     QWidget(parent),
     kWindowConfig(config),
-    kBlockHeight(kMapHeight / kMaxRows),
-    kBlockWidth(kMapWidth / kMaxCols),
+    kBlockHeight(GameEngine::kCellSize),
+    kBlockWidth(GameEngine::kCellSize),
+    scoreLbls(),
+    timeLbl(nullptr),
+    seedLbl(nullptr),
     gameEndShading(nullptr),
     status(GameStatus::kUnprepared),
-    blockMap(kMaxRows, QVector<Block *>(kMaxCols)),
-    countDownTimer(new QTimer(this)),
-    keyPressTimer(new QTimer(this)),
-    hintTimer(new QTimer(this))
+    blockMap(GameEngine::kMaxRows,
+             QVector<Block *>(GameEngine::kMaxCols, nullptr)),
+    analysisWorker(new AnalysisWorker()),
+    tickTimer(new QTimer(this))
 {
 
     // Check map size.
-    assert(kMapHeight + kStatusBarHeight == config->windowHeight());
-    assert(kMapWidth == config->windowWidth());
-
-    // Check the number of blocks and block types.
-    assert(kBlockNum < kMaxRows * kMaxCols - 1);
-    assert(kBlocksPerType * kTypeNum == kBlockNum);
-    assert(!(kBlocksPerType & 1));
+    assert(kMapHeight + 2 * kMapMargin + kStatusBarHeight ==
+           config->windowHeight());
+    assert(kMapWidth + 2 * kMapMargin == config->windowWidth());
 
-    // Check block and height must be even numbers.
-    assert(!(kBlockHeight & 1));
-    assert(!(kBlockWidth & 1));
-
-    // Check block size has not been rounded.
-    assert(kBlockHeight * kMaxRows == kMapHeight);
-    assert(kBlockWidth * kMaxCols == kMapWidth);
+    // Check block size has not been rounded, and the lane of the border fits
+    // in the margin.
+    assert(kBlockHeight * GameEngine::kMaxRows == kMapHeight);
+    assert(kBlockWidth * GameEngine::kMaxCols == kMapWidth);
+    assert(kMapMargin == kBlockHeight && kMapMargin == kBlockWidth);
 
     // Check player configuration.
     assert(kKeyMapping.contains(WhichPlayer::kPlayer1) &&
@@ -63,18 +68,29 @@ GameWindow::GameWindow(const unique_ptr<UiConfig> &config, QWidget *parent):
     // Draw layout.
     initLayout();
 
-    countDownTimer->setInterval(1000);
-    keyPressTimer->setInterval(kKeyPressIntervalMSec);
-    connect(countDownTimer, &QTimer::timeout,
-            this, &GameWindow::handleCountDown);
-    connect(keyPressTimer, &QTimer::timeout,
-            this, &GameWindow::handleKeyPress);
-    connect(hintTimer, &QTimer::timeout,
-            this, &GameWindow::handleStopHint);
+    // Boards are analyzed on <analysisThread> rather than by the engine.
+    engine.addListener(this);
+    engine.setExternalAnalysis(true);
+
+    // The worker is deleted on its own thread once that finishes.
+    qRegisterMetaType<BoardAnalysis>();
+    analysisWorker->moveToThread(&analysisThread);
+    connect(&analysisThread, &QThread::finished,
+            analysisWorker, &QObject::deleteLater);
+    connect(analysisWorker, &AnalysisWorker::sendAnalysis,
+            this, &GameWindow::handleAnalysis);
+    analysisThread.start();
 
-    hintPair.first = nullptr;
-    hintPair.second = nullptr;
+    tickTimer->setInterval(GameEngine::kTickMsec);
+    connect(tickTimer, &QTimer::timeout, this, &GameWindow::handleTick);
+
+}
 
+GameWindow::~GameWindow()
+{
+    engine.removeListener(this);
+    analysisThread.quit();
+    analysisThread.wait();
 }
 
 void GameWindow::initLayout()
@@ -174,6 +190,13 @@ void GameWindow::resetLayout()
     // Clear all widgets in status bar and map.
     Utils::removeAllWidgets(statusLayout);
     Utils::removeAllWidgets(mapLayout);
+    scoreLbls.clear();
+    timeLbl = nullptr;
+    seedLbl = nullptr;
+    players.clear();
+    for (auto &row: blockMap) {
+        row.fill(nullptr);
+    }
 }
 
 void GameWindow::drawStatusBar(const GameMode &mode)
@@ -181,7 +204,7 @@ void GameWindow::drawStatusBar(const GameMode &mode)
     for (int i = 0; i < (mode == GameMode::kSingle ? 1 : 2); ++i) {
         const WhichPlayer p = !i ? WhichPlayer::kPlayer1 : kPlayer2;
         QLabel *scoreLbl = new QLabel();
-        scoreLbl->setText(getScoreString(p, players[p]->score));
+        scoreLbl->setText(getScoreString(p, engine.player(p).score));
         Utils::setWidgetFontSize(scoreLbl, 30);
 
 
@@ -190,16 +213,22 @@ void GameWindow::drawStatusBar(const GameMode &mode)
     }
 
     timeLbl = new QLabel();
-    timeLbl->setText(getTimeString(timeRemaining));
+    timeLbl->setText(getTimeString(engine.timeRemaining()));
     Utils::setWidgetFontSize(timeLbl, 30);
 
     statusLayout->addWidget(timeLbl);
+
+    seedLbl = new QLabel();
+    seedLbl->setText(getSeedString(engine.seed()));
+    Utils::setWidgetFontSize(seedLbl, 15);
+
+    statusLayout->addWidget(seedLbl);
 }
 
 void GameWindow::drawMap()
 {
-    for (int row = 0; row < kMaxRows; ++row) {
-        for (int col = 0; col < kMaxCols; ++col) {
+    for (int row = 0; row < GameEngine::kMaxRows; ++row) {
+        for (int col = 0; col < GameEngine::kMaxCols; ++col) {
             Block *block = blockMap[row][col];
 
             // Just to ensure correctness, set the row and col of button.
@@ -207,8 +236,8 @@ void GameWindow::drawMap()
 
             block->setText(QString::number(
                                   blockMap[row][col]->content()));
-            block->setGeometry(col * kBlockWidth,
-                               row * kBlockHeight,
+            block->setGeometry(getLeft(col),
+                               getTop(row),
                                kBlockWidth,
                                kBlockHeight);
             block->show();
@@ -216,54 +245,21 @@ void GameWindow::drawMap()
     }
 }
 
-QUuid GameWindow::drawConnection(Block *const from,
-                                 const QList<Direction> &path,
+QUuid GameWindow::drawConnection(const LinkPath &path,
                                  const WhichPlayer which)
 {
-
-    static QMap<Direction, QPair<int, int>> dPos = {
-        { Direction::kUp, { 0, -kBlockHeight } },
-        { Direction::kDown, { 0, kBlockHeight } },
-        { Direction::kLeft, { -kBlockWidth, 0 } },
-        { Direction::kRight, { kBlockWidth, 0 } }
-    };
     QList<QLine> lines;
     QUuid uuid;
     QColor color = Block::kHighlightColor[which];
-    auto &fromG = from->geometry();
-    int startX = fromG.center().x();
-    int startY = fromG.center().y();
-    int endX = startX;
-    int endY = startY;
-    int dx;
-    int dy;
-    bool isFirstLine;
-    bool isLastLine;
-
-    for (auto it = path.begin(); it != path.end();) {
-        Direction d = *it;
-        dx = dPos[d].first;
-        dy = dPos[d].second;
-
-        while (*it == d && it != path.end()) {
-            endX += dx;
-            endY += dy;
-            ++it;
-        }
 
-        isFirstLine = lines.empty();
-        isLastLine = it == path.end();
-//        lines.emplaceBack(startX + isFirstLine * (dx >> 1),
-//                          startY + isFirstLine * (dy >> 1),
-//                          endX - isLastLine * (dx >> 1),
-//                          endY - isLastLine * (dy >> 1));
-        lines.emplaceBack(startX,
-                          startY,
-                          endX,
-                          endY);
-
-        startX = endX;
-        startY = endY;
+    // Connect the centers of each pair of consecutive corners.
+    for (size_t i = 1; i < path.size(); ++i) {
+        const Cell &start = path[i - 1];
+        const Cell &end = path[i];
+        lines.emplaceBack(getLeft(start.c) + (kBlockWidth >> 1),
+                          getTop(start.r) + (kBlockHeight >> 1),
+                          getLeft(end.c) + (kBlockWidth >> 1),
+                          getTop(end.r) + (kBlockHeight >> 1));
     }
 
     uuid = mapLayout->addLines(lines, color);
@@ -298,11 +294,11 @@ void GameWindow::promptSuccess()
 {
     QString title = "All blocks are matched!";
     QString subtitle;
-    if (mode == GameMode::kSingle) {
+    if (engine.mode() == GameMode::kSingle) {
         subtitle = "You have succeeded";
     } else {
-        int score1 = players[WhichPlayer::kPlayer1]->score;
-        int score2 = players[WhichPlayer::kPlayer2]->score;
+        int score1 = engine.player(WhichPlayer::kPlayer1).score;
+        int score2 = engine.player(WhichPlayer::kPlayer2).score;
         if (score1 > score2) {
             subtitle = "Player 1 wins";
         } else if (score1 < score2) {
@@ -312,15 +308,16 @@ void GameWindow::promptSuccess()
         }
     }
     promptGameEnd(title, subtitle);
+    emit sendGameOver(true, engine.timeRemaining());
 }
 
 void GameWindow::promptStuck()
 {
     QString title = "No more match available";
     QString subtitle;
-    if (mode == GameMode::kDouble) {
-        int score1 = players[WhichPlayer::kPlayer1]->score;
-        int score2 = players[WhichPlayer::kPlayer2]->score;
+    if (engine.mode() == GameMode::kDouble) {
+        int score1 = engine.player(WhichPlayer::kPlayer1).score;
+        int score2 = engine.player(WhichPlayer::kPlayer2).score;
         if (score1 > score2) {
             subtitle = "Player 1 wins";
         } else if (score1 < score2) {
@@ -330,18 +327,20 @@ void GameWindow::promptStuck()
         }
     } else {
         subtitle = "Your score is " +
-                   QString::number(players[WhichPlayer::kPlayer1]->score);
+                   QString::number(
+                       engine.player(WhichPlayer::kPlayer1).score);
     }
     promptGameEnd(title, subtitle);
+    emit sendGameOver(false, engine.timeRemaining());
 }
 
 void GameWindow::promptTimesUp()
 {
     QString title = "Times up";
     QString subtitle;
-    if (mode == GameMode::kDouble) {
-        int score1 = players[WhichPlayer::kPlayer1]->score;
-        int score2 = players[WhichPlayer::kPlayer2]->score;
+    if (engine.mode() == GameMode::kDouble) {
+        int score1 = engine.player(WhichPlayer::kPlayer1).score;
+        int score2 = engine.player(WhichPlayer::kPlayer2).score;
         if (score1 > score2) {
             subtitle = "Player 1 wins";
         } else if (score1 < score2) {
@@ -351,6 +350,7 @@ void GameWindow::promptTimesUp()
         }
     }
     promptGameEnd(title, subtitle);
+    emit sendGameOver(false, engine.timeRemaining());
 }
 
 void GameWindow::promptGameEnd(QString title, QString subtitle)
@@ -399,7 +399,7 @@ void GameWindow::promptGameEnd(QString title, QString subtitle)
 
 QString GameWindow::getScoreString(const WhichPlayer p, const int score)
 {
-    QString playerIndicator = (mode == GameMode::kSingle) ? "" :
+    QString playerIndicator = (engine.mode() == GameMode::kSingle) ? "" :
                                   (p == WhichPlayer::kPlayer1) ? "1" :
                                       "2";
     return "Player " + playerIndicator + " Score: " + QString::number(score);
@@ -410,81 +410,35 @@ QString GameWindow::getTimeString(const int sec)
     return "Time: " + QString::number(sec);
 }
 
-void GameWindow::generateMap()
+QString GameWindow::getSeedString(const uint64_t seed)
 {
-    // Generate a random sequence of one-dimensional indices.
-    QVector<int> pos(kMaxRows * kMaxCols);
-    std::iota(pos.begin(), pos.end(), 0);
-    Utils::shuffle(pos);
-
-    // Assign indices to ordered block.
-    for (int i = 0; i < kMaxRows * kMaxCols; ++i) {
-        // Set block status.
-        int idx = pos[i];
-        int row = idx / kMaxCols;
-        int col = idx % kMaxCols;
-        BlockType blockType = i < kBlockNum ?
-                    BlockType::kBlock :
-                    BlockType::kEmpty;
-        BlockContent blockContent = i < kBlockNum ?
-                    i / kBlocksPerType + 1 :
-                    Block::kEmptyBlock;
-        blockMap[row][col] = new Block(row, col, false, blockType, blockContent,
-                                       WhichPlayer::kNoPlayer, mapLayout);
-    }
+    return "Seed: " + QString::number(static_cast<quint64>(seed), 16);
 }
 
-bool GameWindow::generatePlayer(const WhichPlayer &which)
+void GameWindow::placeMap()
 {
-    for (int i = 0; i < kMaxGeneratePlayerTrials; ++i) {
-        players.remove(which);
-
-        int row = Utils::randomInt(0, kMaxRows);
-        int col = Utils::randomInt(0, kMaxCols);
-
-        // Check if current block is used.
-        if (!blockMap[row][col]->isEmpty()) {
-            continue;
-        }
-
-        // Check if current blocked is surrounded.
-        bool upBlocked = !row ||
-                !blockMap[row - 1][col]->isEmpty();
-        bool downBlocked = (row == kMaxRows - 1) ||
-                !blockMap[row + 1][col]->isEmpty();
-        bool leftBlocked = !col ||
-                !blockMap[row][col - 1]->isEmpty();
-        bool rightBlocked = (col == kMaxCols - 1) ||
-                !blockMap[row][col + 1]->isEmpty();
-
-        // Retry on failure. Else generate character in the middle of the block.
-        // Never generate player beside the edge.
-        if ((upBlocked && downBlocked && leftBlocked && rightBlocked) ||
-            !row || row == kMaxRows - 1 || !col || col == kMaxCols) {
-            continue;
-        } else {
-            int x = col * kBlockWidth + (kBlockWidth >> 1);
-            int y = row * kBlockHeight + (kBlockHeight >> 1);
-
-            Player *newPlayer = new Player(which, x, y, 0, mapLayout);
-            players.insert(which, newPlayer);
-
-            return true;
+    const Board &board = engine.board();
+    for (int row = 0; row < GameEngine::kMaxRows; ++row) {
+        for (int col = 0; col < GameEngine::kMaxCols; ++col) {
+            const Cell cell = { row, col };
+            blockMap[row][col] = new Block(row, col, engine.isHint(cell),
+                                           board.type(row, col),
+                                           board.content(row, col),
+                                           engine.chosenBy(cell), mapLayout);
         }
     }
-    return false;
 }
 
-void GameWindow::connectPlayerSignals(const GameMode mode)
+void GameWindow::placePlayers()
 {
-    for (int i = 0; i < (mode == GameMode::kSingle ? 1 : 2); ++i) {
-        WhichPlayer which = !i ? WhichPlayer::kPlayer1 : WhichPlayer::kPlayer2;
-        assert(players.contains(which) && players[which] != nullptr);
-        Player *player = players[which];
-        connect(player, &Player::sendValidateBlock,
-                this, &GameWindow::handleValidateBlock);
-        connect(player, &Player::sendScoreChanged,
-                this, &GameWindow::handleScoreChanged);
+    for (int i = 0; i < engine.playerCount(); ++i) {
+        const WhichPlayer which = !i ? WhichPlayer::kPlayer1 :
+                                       WhichPlayer::kPlayer2;
+        const PlayerState &player = engine.player(which);
+        players.insert(which, new Player(which, player.x + kMapMargin,
+                                         player.y + kMapMargin,
+                                         mapLayout));
+        players[which]->show();
     }
 }
 
@@ -494,9 +448,9 @@ void GameWindow::startGame()
            status == GameStatus::kPreparedNew ||
            status == GameStatus::kPaused);
     this->status = GameStatus::kPlaying;
-    countDownTimer->start();
-    keyPressTimer->start();
+    tickTimer->start();
     readyShading->hide();
+    engine.start();
 }
 
 void GameWindow::pauseGame()
@@ -504,13 +458,8 @@ void GameWindow::pauseGame()
     assert(status == GameStatus::kPlaying);
 
     this->status = GameStatus::kPaused;
-    countDownTimer->stop();
-    keyPressTimer->stop();
-
-    if (this->hint) {
-        this->hintTimeRemaining = hintTimer->remainingTime();
-        hintTimer->stop();
-    }
+    tickTimer->stop();
+    engine.pause();
 }
 
 void GameWindow::resumeGame()
@@ -518,855 +467,139 @@ void GameWindow::resumeGame()
     assert(status == GameStatus::kPaused ||
            status == GameStatus::kPreparedLoad);
     this->status = GameStatus::kPlaying;
-    countDownTimer->start();
-    keyPressTimer->start();
-
-    if (this->hint) {
-        hintTimer->start(hintTimeRemaining);
-    }
+    tickTimer->start();
+    engine.start();
 }
 
 void GameWindow::stopGame()
 {
     this->pressedKeys.clear();
     this->status = GameStatus::kStopped;
-    countDownTimer->stop();
-    keyPressTimer->stop();
-    hintTimer->stop();
-}
-
-void GameWindow::spawnItem()
-{
-    const int rand = Utils::randomInt(0, 3);
-    const ItemType t = (rand == 0) ? ItemType::kExtend30s :
-                            (rand == 1) ? ItemType::kShuffle :
-                                ItemType::kHint;
-    int row;
-    int col;
-
-    while (true) {
-        row = Utils::randomInt(0, kMaxRows);
-        col = Utils::randomInt(0, kMaxCols);
-        if (!blockMap[row][col]->isEmpty() || isPlayerAt(row, col)) {
-            continue;
-        }
-        blockMap[row][col]->spawnItem(t);
-        break;
-    }
-}
-
-void GameWindow::consumeItem(const WhichPlayer which, Block *const block) {
-    assert(block->type() == BlockType::kItem);
-    switch (block->content()) {
-    case ItemType::kExtend30s:
-        changeTime(30);
-        break;
-    case ItemType::kShuffle:
-        shuffle();
-        break;
-    case ItemType::kHint:
-        enableHint(which, kHintTimeMsec);
-        break;
-    default:
-        break;
-    }
-
-    block->consumeItem();
+    tickTimer->stop();
+    engine.pause();
 }
 
-void GameWindow::shuffle()
+void GameWindow::saveToFile()
 {
-    // Flatten 2D array to 1D array.
-    QVector<Block *> flattendMap;
-    QSet<int> playerBlocks;
-
-    for (const auto& it: blockMap) {
-        flattendMap.append(it);
-    }
-
-    // Shuffle 1D array. Has to shuffle twice. Otherwise the vector will become
-    // what it's like before shuffling.
-    Utils::shuffle(flattendMap);
-    Utils::shuffle(flattendMap);
-
-    // Swap the empty block with player's block, if it's not empty.
-    // Note that the axes of the blocks have not been changed.
-    // Need to acquire the block with row and col converted to 1D index.
-    // Need to use a set to avoid swapping a block twice.
-    const int maxIter = (mode == GameMode::kSingle) ? 1 : 2;
-    for (int i = 0; i < maxIter; ++i) {
-        const WhichPlayer which = !i ? WhichPlayer::kPlayer1 :
-                                       WhichPlayer::kPlayer2;
-        const auto &g = players[which]->geometry();
-        playerBlocks.insert(rc2Idx(getRC(g.topLeft())));
-        playerBlocks.insert(rc2Idx(getRC(g.topRight())));
-        playerBlocks.insert(rc2Idx(getRC(g.bottomLeft())));
-        playerBlocks.insert(rc2Idx(getRC(g.bottomRight())));
-    }
-
-    const int len = flattendMap.size();
-    for (const int idx: playerBlocks) {
-        Block *b = flattendMap[idx];
-        if (!b->isEmpty()) {
-            for (int i = 0; i < len; ++i) {
-                if (flattendMap[i]->isEmpty()) {
-                    flattendMap.swapItemsAt(idx, i);
-                }
-            }
-        }
-    }
-
-    // Convert flattend 1D array back to 2D array.
-    blockMap.clear();
-    for (int i = 0; i < kMaxRows; ++i) {
-        blockMap.push_back(QVector<Block *>(flattendMap.begin() + i * kMaxCols,
-                            flattendMap.begin() + (i + 1) * kMaxCols));
-    }
-
-    drawMap();
-
-    // Regenerate hint.
-    if (this->hint) {
-        generateHint();
-    }
+    std::ofstream file("save.txt");
+    engine.save(file);
 }
 
-void GameWindow::enableHint(const WhichPlayer which, const int t)
+int GameWindow::getTop(const int r)
 {
-    hintTimer->stop();
-    hintTimer->start(t);
-
-    this->hint = true;
-    this->hintFor = which;
-    generateHint();
+    return kMapMargin + r * kBlockHeight;
 }
 
-void GameWindow::generateHint()
+int GameWindow::getLeft(const int c)
 {
-    Block *b1;
-    Block *b2;
-
-    // Remove current hint.
-    removeCurrentHint();
-
-    // Generate new hint.
-    if (!hasNextStep(b1, b2)) {
-        stopGame();
-        promptStuck();
-        return;
-    }
-    hintPair.first = b1;
-    hintPair.second = b2;
-    b1->markAsHint();
-    b2->markAsHint();
+    return kMapMargin + c * kBlockWidth;
 }
 
-void GameWindow::removeCurrentHint()
+void GameWindow::prepareNewGame(const GameMode mode, const PooledMap &map)
 {
-    if (hintPair.first != nullptr) {
-        hintPair.first->unmarkAsHint();
-    }
-    if (hintPair.second != nullptr) {
-        hintPair.second->unmarkAsHint();
-    }
-    hintPair.first = hintPair.second = nullptr;
+    // Widgets are placed as the engine reports the new game.
+    engine.newGame(mode, map);
+    status = GameStatus::kPreparedNew;
 }
 
-void GameWindow::movePlayer(const WhichPlayer which,
-                            const Direction &d)
+bool GameWindow::prepareSavedGame()
 {
-    const int verticalRange = Player::SHAPE_SIZE >> 1;
-    const int horizontalRange = Player::SHAPE_SIZE >> 1;
-
-    Player *player = players[which];
-    assert(player);
-
-    int newX;
-    int newY;
-    bool collide1;
-    bool collide2;
-    QPair<int, int> rc;
-    auto &g = player->geometry();
-    Block *bBuffer1 = nullptr;
-    Block *bBuffer2 = nullptr;
-    Block *iBuffer1 = nullptr;
-    Block *iBuffer2 = nullptr;
-
-    // To make sure the character does not clip through blocks, need to check
-    // two points for each direction. For example, if the character is moving
-    // up, then top left and top right corner needs to be checked.
-    switch (d) {
-    case Direction::kUp:
-        newY = std::max(player->y - kMoveStep, verticalRange);
-        rc = getRC(player->x, newY - verticalRange);
-        collide1 = checkCollision(g.left(), newY - verticalRange, bBuffer1);
-        collide2 = checkCollision(g.right(), newY - verticalRange, bBuffer2);
-        checkItem(g.left(), newY - verticalRange, iBuffer1);
-        checkItem(g.right(), newY - verticalRange, iBuffer2);
-        if (collide1 || collide2) {
-            player->y = getBottom(rc.first) + verticalRange;
-        } else {
-            player->y = newY;
-        }
-        break;
-    case Direction::kDown:
-        newY = std::min(player->y + kMoveStep, kMapHeight - verticalRange);
-        rc = getRC(player->x, newY + verticalRange);
-        collide1 = checkCollision(g.left(), newY + verticalRange, bBuffer1);
-        collide2 = checkCollision(g.right(), newY + verticalRange, bBuffer2);
-        checkItem(g.left(), newY + verticalRange, iBuffer1);
-        checkItem(g.right(), newY + verticalRange, iBuffer2);
-        if (collide1 || collide2) {
-            player->y = getTop(rc.first) - verticalRange;
-        } else {
-            player->y = newY;
-        }
-        break;
-    case Direction::kLeft:
-        newX = std::max(player->x - kMoveStep, horizontalRange);
-        rc = getRC(newX - horizontalRange, player->y);
-        collide1 = checkCollision(newX - horizontalRange, g.top(), bBuffer1);
-        collide2 = checkCollision(newX - horizontalRange, g.bottom(), bBuffer2);
-        checkItem(newX - horizontalRange, g.top(), iBuffer1);
-        checkItem(newX - horizontalRange, g.bottom(), iBuffer2);
-        if (collide1 || collide2) {
-            player->x = getRight(rc.second) + horizontalRange;
-        } else {
-            player->x = newX;
-        }
-        break;
-    case Direction::kRight:
-        newX = std::min(player->x + kMoveStep, kMapWidth - horizontalRange);
-        rc = getRC(newX + horizontalRange, player->y);
-        collide1 = checkCollision(newX + horizontalRange, g.top(), bBuffer1);
-        collide2 = checkCollision(newX + horizontalRange, g.bottom(), bBuffer2);
-        checkItem(newX + horizontalRange, g.top(), iBuffer1);
-        checkItem(newX + horizontalRange, g.bottom(), iBuffer2);
-        if (collide1 || collide2) {
-            player->x = getLeft(rc.second) - horizontalRange;
-        } else {
-            player->x = newX;
-        }
-        break;
-    default:
-        break;
-    }
-
-    if (bBuffer1 && bBuffer2 && bBuffer1 != bBuffer2) {
-        auto whichBlock = distinguishCollision(player, bBuffer1, bBuffer2, d);
-        if (whichBlock != nullptr) {
-            player->chooseBlock(whichBlock);
-        }
-    } else if (bBuffer1) {
-        player->chooseBlock(bBuffer1);
-    } else if (bBuffer2) {
-        player->chooseBlock(bBuffer2);
+    std::ifstream file("save.txt");
+    if (!engine.load(file)) {
+        return false;
     }
+    stopGame();
 
-    if (iBuffer1) {
-        consumeItem(which, iBuffer1);
-    }
-    if (iBuffer2) {
-        consumeItem(which, iBuffer2);
-    }
+    // Status bar will be above the shading, so raise it again.
+    pauseShading->raise();
 
-    player->update();
+    status = GameStatus::kPreparedLoad;
+    return true;
 }
 
-Block * GameWindow::distinguishCollision(
-        Player *player,
-        Block *const block1,
-        Block *const block2,
-        const Direction d)
-{
-    bool chooseX = (d == Direction::kUp || d == Direction::kDown);
-    int playerPos = chooseX ? player->x : player->y;
-    int block1Pos = chooseX ? block1->geometry().center().x() :
-                              block1->geometry().center().y();
-    int block2Pos = chooseX ? block2->geometry().center().x() :
-                              block2->geometry().center().y();
-
-    int distToBlock1 = std::abs(playerPos - block1Pos);
-    int distToBlock2 = std::abs(playerPos - block2Pos);
-
-    return distToBlock1 < distToBlock2 ? block1 :
-                distToBlock1 > distToBlock2 ? block2 :
-                    nullptr;
-}
+// ============================================================
+//
+// Engine events
+//
+// ============================================================
 
-bool GameWindow::checkCollision(const int x, const int y,
-                                Block *&buffer)
+void GameWindow::gameReset()
 {
-    // Set the buffer to null, just in case it is not initially null.
-    buffer = nullptr;
-
-    if (x >= kMapWidth || y >= kMapHeight) {
-        return true;
-    }
+    resetLayout();
+    placeMap();
+    placePlayers();
+    drawStatusBar(engine.mode());
+    drawMap();
 
-    const auto rc = getRC(x, y);
-    const auto block = blockMap[rc.first][rc.second];
-    if (block->isBlock()) {
-        buffer = blockMap[rc.first][rc.second];
-        return true;
+    // Players walk over the blocks.
+    for (Player *player: players) {
+        player->raise();
     }
-    return false;
 }
 
-bool GameWindow::checkItem(const int x, const int y, Block *&buffer)
+void GameWindow::cellChanged(const Cell &cell)
 {
-    buffer = nullptr;
-
-    if (x >= kMapWidth || y >= kMapHeight) {
-        return true;
+    Block *block = blockMap[cell.r][cell.c];
+    if (block != nullptr) {
+        block->setState(engine.board().type(cell.r, cell.c),
+                        engine.board().content(cell.r, cell.c),
+                        engine.chosenBy(cell), engine.isHint(cell));
     }
-
-    const auto rc = getRC(x, y);
-    const auto block = blockMap[rc.first][rc.second];
-    if (block->isInItemRange(x, y)) {
-        buffer = blockMap[rc.first][rc.second];
-        return true;
-    }
-    return false;
-}
-
-bool GameWindow::checkMatch(Block *const b1, Block *const b2,
-                            QList<Direction> *path)
-{
-    return b1 != b2 &&
-           b1->type() == BlockType::kBlock &&
-           b2->type() == BlockType::kBlock &&
-           b1->content() == b2->content() &&
-           b1->chosenBy() == b2->chosenBy() &&
-           checkConnectivity(b1, b2, path);
 }
 
-bool GameWindow::checkConnectivity(Block *const from,
-                                   Block *const to,
-                                   QList<Direction> *path)
+void GameWindow::playerMoved(const WhichPlayer which)
 {
-    QVector<QVector<bool>> visited(kMaxRows, QVector<bool>(kMaxCols, false));
-    visited[from->row()][from->col()] = true;
-
-    // Recreate the path with DirectionNode, like a linked list.
-    auto lastDNode = dfs(0, from, to, visited, nullptr);
-    bool found = lastDNode != nullptr;
-
-    if (found && path != nullptr) {
-        path->clear();
-        while (lastDNode) {
-            path->push_front(lastDNode->d);
-            lastDNode = lastDNode->prev;
-        }
+    Player *player = players.value(which, nullptr);
+    if (player != nullptr) {
+        player->moveTo(engine.player(which).x + kMapMargin,
+                       engine.player(which).y + kMapMargin);
     }
-
-    return found;
 }
 
-shared_ptr<DirectionNode> GameWindow::dfs(const int turns,
-                                          Block *const current,
-                                          Block *const to,
-                                          QVector<QVector<bool>> &visited,
-                                          shared_ptr<DirectionNode> dNode)
+void GameWindow::scoreChanged(const WhichPlayer which, const int score)
 {
-    static const QMap<Direction, QPair<int, int>> move = {
-        { Direction::kUp, { -1, 0 } },
-        { Direction::kDown, { 1, 0 } },
-        { Direction::kLeft, { 0, -1 } },
-        { Direction::kRight, { 0, 1 } }
-    };
-
-    QVector<Direction> searchD;
-    sortSearchDirections(current->row(), current->col(),
-                         to->row(), to->col(),
-                         searchD);
-    for (auto it = searchD.begin(); it != searchD.end(); ++it) {
-        const Direction d = *it;
-        const int dr = move[d].first;
-        const int dc = move[d].second;
-        const int newR = current->row() + dr;
-        const int newC = current->col() + dc;
-        int newTurns = (dNode == nullptr) ? 0 : d == dNode->d ?
-                                turns : turns + 1;
-
-        // Check index out of bound or too many turns or circular visit.
-        if (newR < 0 || newR >= kMaxRows || newC < 0 || newC >= kMaxCols ||
-            newTurns > kMaxTurns ||
-            visited[newR][newC]) {
-            continue;
-        }
-
-        auto newBlockPtr = blockMap[newR][newC];
-
-        // Check correct answer.
-        if (newBlockPtr == to) {
-            return make_shared<DirectionNode>(d, dNode);
-        }
-
-        // Check block occupied.
-        if (newBlockPtr->isBlock()) {
-            continue;
-        }
-
-        visited[newR][newC] = true;
-
-        shared_ptr<DirectionNode> ret = dfs(newTurns,
-                                            blockMap[newR][newC],
-                                            to,
-                                            visited,
-                                            make_shared<DirectionNode>(d, dNode)
-                                            );
-        if (ret) {
-            return ret;
-        }
-
-        visited[newR][newC] = false;
+    if (scoreLbls.contains(which)) {
+        scoreLbls[which]->setText(getScoreString(which, score));
     }
-
-    return nullptr;
 }
 
-void GameWindow::sortSearchDirections(const int fromR, const int fromC,
-                                      const int toR, const int toC,
-                                      QVector<Direction> &directions) {
-    assert(fromR != toR || fromC != toC);
-    directions.clear();
-    // Up.
-    if (toR <  fromR) {
-        // Up left and straight up.
-        if (toC <= fromC) {
-            directions.append({ Direction::kUp, Direction::kLeft,
-                                Direction::kRight, Direction::kDown});
-        }
-        // Up right.
-        else {
-            directions.append({ Direction::kRight, Direction::kUp,
-                                Direction::kLeft, Direction::kDown});
-        }
-    }
-    // At the same row.
-    else if (toR == fromR) {
-        // Straight left.
-        if (toC < fromC) {
-            directions.append({ Direction::kLeft, Direction::kUp,
-                                Direction::kDown, Direction::kRight});
-        }
-        // Straight right.
-        else {
-            directions.append({ Direction::kRight, Direction::kUp,
-                                Direction::kDown, Direction::kLeft});
-        }
-    }
-    // Down.
-    else {
-        // Down left and straight down.
-        if (toC <= fromC) {
-            directions.append({ Direction::kDown, Direction::kLeft,
-                                Direction::kRight, Direction::kUp});
-        }
-        // Down right.
-        else {
-            directions.append({ Direction::kDown, Direction::kRight,
-                                Direction::kLeft, Direction::kUp});
-        }
-    }
-}
-
-
-bool GameWindow::hasNextStep(Block *&b1, Block *&b2)
-{
-    int maxIter = (mode == GameMode::kSingle) ? 1 : 2;
-    auto findAndCheck = [&](Block *const playerBlock,
-            const int playerR, const int playerC,
-            const int fromR, const int fromC) -> bool {
-
-        Block *fromBlock = blockMap[fromR][fromC];
-        BlockContent fromContent = fromBlock->content();
-        // Check if from block has content and can be reached by player.
-        if (!fromBlock->isBlock() ||
-            !checkConnectivity(playerBlock, fromBlock, nullptr) ||
-            (fromR == playerR && fromC == playerC)) {
-            return false;
-        }
-
-        for (int r = playerR; r >= 0; --r) {
-            for (int c = playerC; c >= 0; --c) {
-                if ((r == fromR && c == fromC) ||
-                    (playerR == r && playerC == c)) {
-                    continue;
-                }
-                Block *toBlock = blockMap[r][c];
-                if (toBlock->isBlock() && toBlock->content() == fromContent &&
-                    checkConnectivity(fromBlock, toBlock, nullptr) &&
-                    checkConnectivity(playerBlock, toBlock, nullptr)) {
-                    b1 = fromBlock;
-                    b2 = toBlock;
-                    return true;
-                }
-            }
-
-            for (int c = playerC + 1; c < kMaxCols ; ++c) {
-                if ((r == fromR && c == fromC) ||
-                    (playerR == r && playerC == c)) {
-                    continue;
-                }
-                Block *toBlock = blockMap[r][c];
-                if (toBlock->isBlock() && toBlock->content() == fromContent &&
-                    checkConnectivity(fromBlock, toBlock, nullptr) &&
-                    checkConnectivity(playerBlock, toBlock, nullptr)) {
-                    b1 = fromBlock;
-                    b2 = toBlock;
-                    return true;
-                }
-            }
-        }
-
-        for (int r = playerR + 1; r < kMaxRows; ++r) {
-            for (int c = playerC; c >= 0; --c) {
-                if ((r == fromR && c == fromC) ||
-                    (playerR == r && playerC == c)) {
-                    continue;
-                }
-                Block *toBlock = blockMap[r][c];
-                if (toBlock->isBlock() && toBlock->content() == fromContent &&
-                    checkConnectivity(fromBlock, toBlock, nullptr) &&
-                    checkConnectivity(playerBlock, toBlock, nullptr)) {
-                    b1 = fromBlock;
-                    b2 = toBlock;
-                    return true;
-                }
-            }
-
-            for (int c = playerC + 1; c < kMaxCols ; ++c) {
-                if ((r == fromR && c == fromC) ||
-                    (playerR == r && playerC == c)) {
-                    continue;
-                }
-                Block *toBlock = blockMap[r][c];
-                if (toBlock->isBlock() && toBlock->content() == fromContent &&
-                    checkConnectivity(fromBlock, toBlock, nullptr) &&
-                    checkConnectivity(playerBlock, toBlock, nullptr)) {
-                    b1 = fromBlock;
-                    b2 = toBlock;
-                    return true;
-                }
-            }
-        }
-
-        return false;
-    };
-
-    for (int i = 0; i < maxIter; ++i) {
-        const WhichPlayer which =
-                (!i && hintFor != WhichPlayer::kPlayer2) ||
-                (i && hintFor == WhichPlayer::kPlayer2) ?
-                    WhichPlayer::kPlayer1 :
-                    WhichPlayer::kPlayer2;
-        Player *player = players[which];
-        const auto &rc = getRC(player->geometry().center());
-        const int playerR = rc.first;
-        const int playerC = rc.second;
-        Block *playerBlock = blockMap[playerR][playerC];
-        for (int r = playerR; r >= 0; --r) {
-            for (int c = playerC; c >= 0; --c) {
-                if (findAndCheck(playerBlock, playerR, playerC, r, c)) {
-                     return true;
-                }
-            }
-
-            for (int c = playerC + 1; c < kMaxCols ; ++c) {
-                if (findAndCheck(playerBlock, playerR, playerC, r, c)) {
-                     return true;
-                }
-            }
-        }
-
-        for (int r = playerR + 1; r < kMaxRows; ++r) {
-            for (int c = playerC; c >= 0; --c) {
-                if (findAndCheck(playerBlock, playerR, playerC, r, c)) {
-                     return true;
-                }
-            }
-
-            for (int c = playerC + 1; c < kMaxCols ; ++c) {
-                if (findAndCheck(playerBlock,
-                                 playerR, playerC, r, c)) {
-                     return true;
-                }
-            }
-        }
-    }
-
-    return false;
-}
-
-bool GameWindow::hasNextStep()
+void GameWindow::timeChanged(const int timeRemaining)
 {
-    Block *b1;
-    Block *b2;
-    bool f = hasNextStep(b1, b2);
-    return f;
-}
-
-void GameWindow::saveToFile()
-{
-    QFile file("save.txt");
-    file.open(QIODevice::WriteOnly);
-    QTextStream s(&file);
-    int chosenR;
-    int chosenC;
-    Block *chosenBlk;
-
-    // Save mode.
-    s << mode << '\n';
-
-    // Save blockMap.
-    for (int r = 0; r < kMaxRows; ++r) {
-        for (int c = 0; c < kMaxCols; ++c) {
-            s << *blockMap[r][c] << ' ';
-        }
-        s << '\n';
-    }
-
-    // Save players
-    s << *players[WhichPlayer::kPlayer1] << '\n';
-    if (mode == GameMode::kDouble) {
-        s << *players[WhichPlayer::kPlayer2] << '\n';
-    }
-
-    // Save the blocks the player has chosen.
-    chosenBlk = players[WhichPlayer::kPlayer1]->chosenBlock;
-    chosenR = chosenBlk ? chosenBlk->row() : -1;
-    chosenC = chosenBlk ? chosenBlk->col() : -1;
-    s << chosenR << ' ' << chosenC << '\n';
-    if (mode == GameMode::kDouble) {
-        chosenBlk = players[WhichPlayer::kPlayer2]->chosenBlock;
-        chosenR = chosenBlk ? chosenBlk->row() : -1;
-        chosenC = chosenBlk ? chosenBlk->col() : -1;
-        s << chosenR << ' ' << chosenC << '\n';
-    }
-
-    // Save blocks remaining.
-    s << blocksRemaining << '\n';
-
-    // Save time remaining.
-    s << timeRemaining << '\n';
-
-    // Save hint status.
-    s << hint << '\n';
-
-    // Save hint for.
-    s << hintFor << '\n';
-
-    // Save remaining hint time.
-    s << hintTimeRemaining << '\n';
-
-    // Save hint pair.
-    if (hintPair.first) {
-        Block *b = hintPair.first;
-        s << b->row() << ' ' << b->col() << '\n';
-    } else {
-        s << "-1 -1\n";
-    }
-    if (hintPair.second) {
-        Block *b = hintPair.second;
-        s << b->row() << ' ' << b->col() << '\n';
-    } else {
-        s << "-1 -1\n";
+    if (timeLbl != nullptr) {
+        timeLbl->setText(getTimeString(timeRemaining));
     }
-
-    file.close();
-}
-
-
-QPair<int, int> GameWindow::getRC(const int x, const int y)
-{
-    assert(x >= 0 && x <= mapLayout->geometry().width() &&
-           y >= 0 && y <= mapLayout->geometry().height());
-    return qMakePair(y / kBlockHeight, x / kBlockWidth);
-}
-
-QPair<int, int> GameWindow::getRC(const QPoint &p)
-{
-    return getRC(p.x(), p.y());
 }
 
-int GameWindow::rc2Idx(const QPair<int, int> &p)
+void GameWindow::linked(const WhichPlayer which, const LinkPath &path)
 {
-    return p.first * kMaxCols + p.second;
+    // Draw connection for 1 sec.
+    const QUuid uuid = drawConnection(path, which);
+    QTimer::singleShot(kShowConnectionDurationMsec, this, [=](){
+        clearConnection(uuid);
+    });
 }
 
-int GameWindow::getTop(const int r)
+void GameWindow::boardChanged()
 {
-    return r * kBlockHeight;
+    analysisWorker->submit(engine.snapshot());
 }
 
-int GameWindow::getBottom(const int r)
-{
-    return r * kBlockHeight + kBlockHeight;
-}
-
-int GameWindow::getLeft(const int c)
+void GameWindow::gameOver(const GameOutcome outcome)
 {
-    return c * kBlockWidth;
-}
-
-int GameWindow::getRight(const int c)
-{
-    return c * kBlockWidth + kBlockWidth;
-}
-
-bool GameWindow::isPlayerAt(const int r, const int c) {
-    const int maxIter = (mode == GameMode::kSingle) ? 1 : 2;
-    for (int i = 0; i < maxIter; ++i) {
-        const WhichPlayer which = !i ? WhichPlayer::kPlayer1 :
-                                       WhichPlayer::kPlayer2;
-        const auto &rc = getRC(players[which]->x, players[which]->y);
-        if (rc.first == r && rc.second == c) {
-            return true;
-        }
-    }
-    return false;
-}
-
-void GameWindow::changeTime(const int dsec)
-{
-    assert(this->timeLbl);
-    this->timeRemaining += dsec;
-    this->timeLbl->setText(getTimeString(this->timeRemaining));
-
-    if (!timeRemaining) {
-        stopGame();
+    stopGame();
+    switch (outcome) {
+    case GameOutcome::kAllMatched:
+        promptSuccess();
+        break;
+    case GameOutcome::kNoMoreMatch:
+        promptStuck();
+        break;
+    case GameOutcome::kOutOfTime:
         promptTimesUp();
+        break;
     }
 }
 
-void GameWindow::prepareNewGame(const GameMode mode)
-{
-    resetLayout();
-
-    this->mode = mode;
-    // Generate map and player position.
-    // Players are drawn automatically.
-    while (true) {
-        generateMap();
-        if (generatePlayer(WhichPlayer::kPlayer1) &&
-            (mode == GameMode::kSingle || generatePlayer(WhichPlayer::kPlayer2))
-                ) {
-            break;
-        }
-    }
-
-    // Reset time.
-    this->timeRemaining = kInitialTime;
-    this->blocksRemaining = kBlockNum;
-
-    // Draw status bar.
-    drawStatusBar(mode);
-
-    // Draw map.
-    drawMap();
-
-    // Connect player logic with Ui.
-    connectPlayerSignals(mode);
-
-    hintPair.first = hintPair.second = nullptr;
-
-    status = GameStatus::kPreparedNew;
-}
-
-void GameWindow::prepareSavedGame()
-{
-    resetLayout();
-
-    QFile file("save.txt");
-    file.open(QIODevice::ReadOnly);
-    QTextStream s(&file);
-    int x;
-    int chosenR;
-    int chosenC;
-
-    // Load mode.
-    s >> x;
-    this->mode = static_cast<GameMode>(x);
-
-    // Load map.
-    for (int r = 0; r < kMaxRows; ++r) {
-        for (int c = 0; c < kMaxCols; ++c) {
-            Block *b = Block::fromTextStream(s);
-            b->setParent(mapLayout);
-            blockMap[r][c] = b;
-        }
-    }
-
-    // Load player.
-    Player *player1 = Player::fromTextStream(s);
-    players[WhichPlayer::kPlayer1] = player1;
-    player1->hide();
-    player1->setParent(mapLayout);
-    player1->show();
-    if (mode == GameMode::kDouble) {
-        Player *player2 = Player::fromTextStream(s);
-         players[WhichPlayer::kPlayer2] = player2;
-         player2->hide();
-         player2->setParent(mapLayout);
-         player2->show();
-    }
-
-    // Load chosen blocks of the player
-    s >> chosenR >> chosenC;
-    if (chosenR != -1) {
-        players[WhichPlayer::kPlayer1]->chosenBlock =
-                blockMap[chosenR][chosenC];
-    }
-    if (mode == GameMode::kDouble) {
-        s >> chosenR >> chosenC;
-        if (chosenR != -1) {
-            players[WhichPlayer::kPlayer2]->chosenBlock =
-                    blockMap[chosenR][chosenC];
-        }
-    }
-
-    // Load time.
-    s >> this->blocksRemaining;
-    s >> this->timeRemaining;
-    s >> x;
-    this->hint = static_cast<bool>(x);
-    s >> x;
-    this->hintFor = static_cast<WhichPlayer>(x);
-    s >> this->hintTimeRemaining;
-
-    // Load hint paaasair.
-    hintPair.first = hintPair.second = nullptr;
-    int r, c;
-    s >> r >> c;
-    if (r != -1 && c != -1) {
-        hintPair.first = blockMap[r][c];
-    }
-    s >> r >> c;
-    if (r != -1 && c != -1) {
-        hintPair.second = blockMap[r][c];
-    }
-
-    // Draw status bar.
-    drawStatusBar(mode);
-
-    // Status bar will be above the shading, so raise it again.
-    pauseShading->raise();
-
-
-    // Draw map.
-    drawMap();
-
-    file.close();
-
-    connectPlayerSignals(mode);
-
-    status = GameStatus::kPreparedLoad;
-
-
-}
-
 // ============================================================
 //
 // Events
@@ -1383,6 +616,11 @@ void GameWindow::keyPressEvent(QKeyEvent *event)
         if (key == kPauseKey) {
             promptPause();
             pauseGame();
+        } else if (key == kAutoWalkKey[WhichPlayer::kPlayer1]) {
+            engine.toggleAutoWalk(WhichPlayer::kPlayer1);
+        } else if (key == kAutoWalkKey[WhichPlayer::kPlayer2] &&
+                   engine.mode() == GameMode::kDouble) {
+            engine.toggleAutoWalk(WhichPlayer::kPlayer2);
         }
         break;
     }
@@ -1431,77 +669,13 @@ void GameWindow::showEvent(QShowEvent *event)
 // Slots
 //
 // ============================================================
-void GameWindow::handleValidateBlock(const WhichPlayer which,
-                                     Block *const b1,
-                                     Block *const b2)
-{
-    Player *player = players[which];
-    QList<Direction> path;
-    QUuid uuid;
-    assert(player);
-
-    if (b1 != b2 && b1->content() == b2->content() &&
-        checkConnectivity(b1, b2, &path)) {
-        // Draw connection for 1 sec.
-        uuid = drawConnection(b1, path, which);
-        QTimer::singleShot(kShowConnectionDurationMsec,
-                           this, [=](){
-            clearConnection(uuid);
-        });
-
-        player->addScore(kScorePerMatch);
-
-        b1->eliminateSelf();
-        b2->eliminateSelf();
-        this->blocksRemaining -= 2;
-        assert(!(this->blocksRemaining & 1) && blocksRemaining >= 0);
-
-        // Check for game end.
-        if (!blocksRemaining) {
-            stopGame();
-            promptSuccess();
-        } else if (!hasNextStep()) {
-            stopGame();
-            promptStuck();
-        }
-
-        // Check for hint.
-        if (hint && ((b1 == hintPair.first || b1 == hintPair.second) ||
-                (b2 == hintPair.first || b2 == hintPair.second))) {
-            generateHint();
-        }
-
-    } else {
-        b1->setChosenBy(WhichPlayer::kNoPlayer);
-        b2->setChosenBy(WhichPlayer::kNoPlayer);
-    }
-    player->removeChosenBlock();
-}
-
-void GameWindow::handleScoreChanged(const WhichPlayer which,
-                                    const int newScore) {
-    assert(scoreLbls.contains(which));
-    scoreLbls[which]->setText(getScoreString(which, newScore));
-}
 
-void GameWindow::handleCountDown()
-{
-    // Reduce time remaining.
-    changeTime(-1);
-
-    // Possibly generate new item.
-    if (Utils::randomInt(0, 101) <= kSpawnItemProbability) {
-        spawnItem();
-    }
-}
-
-void GameWindow::handleKeyPress() {
+void GameWindow::handleTick() {
     if (this->status != GameStatus::kPlaying) {
         return;
     }
 
-    int maxIter = (mode == GameMode::kSingle) ? 1 : 2;
-    for (int i = 0; i < maxIter; ++i) {
+    for (int i = 0; i < engine.playerCount(); ++i) {
         const WhichPlayer which = !i ?
                     WhichPlayer::kPlayer1 : WhichPlayer::kPlayer2;
         const auto &keyMapping = this->kKeyMapping[which];
@@ -1510,6 +684,13 @@ void GameWindow::handleKeyPress() {
         const int leftKey = keyMapping[Direction::kLeft];
         const int rightKey = keyMapping[Direction::kRight];
 
+        // Walking by hand ends an auto-walk, which the engine steps
+        // otherwise.
+        if (pressedKeys.contains(upKey) || pressedKeys.contains(downKey) ||
+            pressedKeys.contains(leftKey) || pressedKeys.contains(rightKey)) {
+            engine.stopAutoWalk(which);
+        }
+
         // If keys of opposite directions are pressed, do nothing.
         if ((pressedKeys.contains(downKey) &&
             pressedKeys.contains(upKey)) ||
@@ -1519,18 +700,25 @@ void GameWindow::handleKeyPress() {
         }
 
         if (pressedKeys.contains(upKey)) {
-            movePlayer(which, Direction::kUp);
+            engine.move(which, Direction::kUp);
         }
         if (pressedKeys.contains(downKey)) {
-            movePlayer(which, Direction::kDown);
+            engine.move(which, Direction::kDown);
         }
         if (pressedKeys.contains(leftKey)) {
-            movePlayer(which, Direction::kLeft);
+            engine.move(which, Direction::kLeft);
         }
         if (pressedKeys.contains(rightKey)) {
-            movePlayer(which, Direction::kRight);
+            engine.move(which, Direction::kRight);
         }
     }
+
+    engine.tick();
+}
+
+void GameWindow::handleAnalysis(const BoardAnalysis &result)
+{
+    engine.setAnalysis(result);
 }
 
 void GameWindow::handleResume() {
@@ -1543,7 +731,7 @@ void GameWindow::handleSave() {
 }
 
 void GameWindow::handleLoad() {
-    stopGame();
+    // The paused game goes on if there is no save to load.
     prepareSavedGame();
 }
 
@@ -1560,14 +748,3 @@ void GameWindow::handleBack() {
     stopGame();
     emit sendBackToMenu(this);
 }
-
-void GameWindow::handleStopHint()
-{
-    this->hint = false;
-    this->hintFor = WhichPlayer::kNoPlayer;
-
-    // If game stopps, just leave the hint highlight be.aaa
-    if (this->status != GameStatus::kStopped) {
-        removeCurrentHint();
-    }
-}
@@ -9,6 +9,8 @@
 #include <vector>
 
 #include <QApplication>
+#include <QCheckBox>
+#include <QComboBox>
 #include <QDebug>
 #include <QFile>
 #include <QFontDatabase>
@@ -16,15 +18,19 @@
 #include <QGuiApplication>
 #include <QKeyEvent>
 #include <QLabel>
+#include <QLineEdit>
 #include <QLineF>
 #include <QMap>
 #include <QMessageBox>
+#include <QMutex>
 #include <QObject>
 #include <QPainter>
 #include <QPaintEvent>
 #include <QPair>
+#include <QPointer>
 #include <QPushButton>
 #include <QScreen>
+#include <QSpinBox>
 #include <QStatusBar>
 #include <QtTest/QtTest>
 #include <QTimer>
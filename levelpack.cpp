@@ -0,0 +1,278 @@
+#include "levelpack.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "linkchecker.h"
+
+const char LevelPack::kMagic[4] = { 'Q', 'L', 'P', 'K' };
+
+#ifdef _WIN32
+LevelPack::LevelPack(): data(nullptr), size(0), levels(0), indexOffset(0),
+    file(INVALID_HANDLE_VALUE), mapping(nullptr)
+#else
+LevelPack::LevelPack(): data(nullptr), size(0), levels(0), indexOffset(0)
+#endif
+{
+
+}
+
+LevelPack::~LevelPack()
+{
+    close();
+}
+
+bool LevelPack::open(const std::string &path)
+{
+    close();
+
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                       OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < kHeaderSize) {
+        close();
+        return false;
+    }
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        return false;
+    }
+    data = static_cast<const uint8_t *>(
+                MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) || st.st_size < kHeaderSize) {
+        ::close(fd);
+        return false;
+    }
+    void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive.
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    data = static_cast<const uint8_t *>(mapped);
+    size = static_cast<size_t>(st.st_size);
+#endif
+    if (data == nullptr) {
+        close();
+        return false;
+    }
+
+    levels = static_cast<uint32_t>(readLe(data + 8, 4));
+    indexOffset = readLe(data + 16, 8);
+    if (std::memcmp(data, kMagic, 4) || readLe(data + 4, 2) != kVersion ||
+        readLe(data + 24, 8) != size || indexOffset < kHeaderSize ||
+        indexOffset > size || (size - indexOffset) / 8 <= levels) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void LevelPack::close()
+{
+#ifdef _WIN32
+    if (data != nullptr) {
+        UnmapViewOfFile(data);
+    }
+    if (mapping != nullptr) {
+        CloseHandle(mapping);
+    }
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+    mapping = nullptr;
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (data != nullptr) {
+        munmap(const_cast<uint8_t *>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+    levels = 0;
+    indexOffset = 0;
+}
+
+bool LevelPack::isOpen() const
+{
+    return data != nullptr;
+}
+
+int LevelPack::count() const
+{
+    return static_cast<int>(levels);
+}
+
+bool LevelPack::load(const int i, PackedLevel *level) const
+{
+    if (i < 0 || static_cast<uint32_t>(i) >= levels) {
+        return false;
+    }
+    const uint8_t *offset = data + indexOffset + uint64_t(i) * 8;
+    const uint64_t begin = readLe(offset, 8);
+    const uint64_t end = readLe(offset + 8, 8);
+    if (begin > end || end > size || end - begin < kLevelHeaderSize) {
+        return false;
+    }
+
+    const uint8_t *record = data + begin;
+    const int rows = record[0];
+    const int cols = record[1];
+    const int flags = record[3];
+    const int spawns = record[4];
+    const bool wide = flags & kWideCells;
+    const uint64_t cellBytes = wide ? rows * cols : (rows * cols + 1) / 2;
+    if (end - begin != kLevelHeaderSize + spawns * 2 + cellBytes ||
+        record[2] > LinkChecker::kMaxTurnLimit) {
+        return false;
+    }
+
+    level->maxTurns = record[2];
+    level->spawns.clear();
+    const uint8_t *p = record + kLevelHeaderSize;
+    for (int s = 0; s < spawns; ++s, p += 2) {
+        if (p[0] >= rows || p[1] >= cols) {
+            return false;
+        }
+        level->spawns.push_back({ p[0], p[1] });
+    }
+
+    Board &board = level->board;
+    board.setBorderRouting(flags & kBorderRouting);
+    board.beginUpdate();
+    board.reset(rows, cols);
+    for (int k = 0; k < rows * cols; ++k) {
+        const int content = wide ? p[k] : (p[k / 2] >> (k & 1) * 4) & 0xf;
+        if (content) {
+            board.setCell(k / cols, k % cols, BlockType::kBlock, content);
+        }
+    }
+    board.endUpdate();
+    return true;
+}
+
+std::string LevelPack::pack(const std::vector<PackedLevel> &levels)
+{
+    std::string records;
+    std::vector<uint64_t> offsets;
+    const uint64_t indexOffset = kHeaderSize;
+    const uint64_t recordsOffset = indexOffset + (levels.size() + 1) * 8;
+
+    for (const PackedLevel &level: levels) {
+        const Board &board = level.board;
+        const int rows = board.rows();
+        const int cols = board.cols();
+        if (rows > 255 || cols > 255 || level.spawns.size() > 255 ||
+            level.maxTurns < 0 ||
+            level.maxTurns > LinkChecker::kMaxTurnLimit) {
+            return std::string();
+        }
+
+        int maxContent = 0;
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                const BlockType t = board.type(r, c);
+                if (t == BlockType::kItem) {
+                    return std::string();
+                }
+                if (t == BlockType::kBlock) {
+                    const int content = board.content(r, c);
+                    if (content < 1 || content > 255) {
+                        return std::string();
+                    }
+                    maxContent = std::max(maxContent, content);
+                }
+            }
+        }
+        const bool wide = maxContent > 15;
+
+        offsets.push_back(recordsOffset + records.size());
+        records += static_cast<char>(rows);
+        records += static_cast<char>(cols);
+        records += static_cast<char>(level.maxTurns);
+        records += static_cast<char>((board.borderRouting() ?
+                                          kBorderRouting : 0) |
+                                     (wide ? kWideCells : 0));
+        records += static_cast<char>(level.spawns.size());
+        records.append(3, '\0');
+        for (const Cell &spawn: level.spawns) {
+            if (spawn.r < 0 || spawn.r >= rows ||
+                spawn.c < 0 || spawn.c >= cols) {
+                return std::string();
+            }
+            records += static_cast<char>(spawn.r);
+            records += static_cast<char>(spawn.c);
+        }
+
+        uint8_t nibbles = 0;
+        for (int k = 0; k < rows * cols; ++k) {
+            const int r = k / cols;
+            const int c = k % cols;
+            const int content = board.type(r, c) == BlockType::kBlock ?
+                        board.content(r, c) : 0;
+            if (wide) {
+                records += static_cast<char>(content);
+            } else if (k & 1) {
+                records += static_cast<char>(nibbles | content << 4);
+            } else {
+                nibbles = static_cast<uint8_t>(content);
+            }
+        }
+        if (!wide && (rows * cols) & 1) {
+            records += static_cast<char>(nibbles);
+        }
+    }
+    const uint64_t size = recordsOffset + records.size();
+    offsets.push_back(size);
+
+    std::string out(kMagic, 4);
+    writeLe(&out, kVersion, 2);
+    writeLe(&out, 0, 2);
+    writeLe(&out, levels.size(), 4);
+    writeLe(&out, 0, 4);
+    writeLe(&out, indexOffset, 8);
+    writeLe(&out, size, 8);
+    for (const uint64_t offset: offsets) {
+        writeLe(&out, offset, 8);
+    }
+    out += records;
+    return out;
+}
+
+uint64_t LevelPack::readLe(const uint8_t *p, const int bytes)
+{
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        value = value << 8 | p[i];
+    }
+    return value;
+}
+
+void LevelPack::writeLe(std::string *out, const uint64_t value,
+                        const int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        *out += static_cast<char>(value >> i * 8 & 0xff);
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef LEVELPACK_H
+#define LEVELPACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+// A curated level: a board in its routing mode, where the players start, and
+// the turn limit it is played with.
+struct PackedLevel {
+    Board board;
+
+    // Cells the players start on, player 1 first.
+    std::vector<Cell> spawns;
+
+    int maxTurns = 2;
+};
+
+// Read-only access to a level pack, a file of levels that is mapped into
+// memory rather than read. Opening a pack only checks its header, and loading
+// a level touches only its offset and its record, so that any level of a
+// pack of thousands loads in a page fault or two.
+//
+// All numbers are little endian. The file is laid out as follows:
+//
+//   header   "QLPK", u16 version, u16 0, u32 level count, u32 0,
+//            u64 index offset, u64 file size (32 bytes)
+//   index    u64 offset of each level, then the file size
+//   levels   u8 rows, u8 cols, u8 turn limit, u8 flags, u8 spawn count,
+//            3 zero bytes, u8 row and u8 column of each spawn point, then
+//            the cells in row order: 0 for empty, the content of a block
+//            otherwise
+//
+// Cells take 4 bits each, low nibble first, unless flag kWideCells is set and
+// they take a byte. Flag kBorderRouting sets the routing mode.
+class LevelPack {
+public:
+    // First bytes of every pack, and the version this code reads and writes.
+    static const char kMagic[4];
+    static const int kVersion = 1;
+
+    static const int kHeaderSize = 32;
+    static const int kLevelHeaderSize = 8;
+
+    // Flags of a level record.
+    static const int kBorderRouting = 1;
+    static const int kWideCells = 2;
+
+    LevelPack();
+    ~LevelPack();
+
+    LevelPack(const LevelPack &) = delete;
+    LevelPack &operator=(const LevelPack &) = delete;
+
+    // Map the pack at <path>, closing the one open before. Returns false if
+    // the file cannot be mapped or its header is malformed.
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const;
+
+    // Number of levels, 0 if no pack is open.
+    int count() const;
+
+    // Put level <i> into <level>. Returns false, leaving <level> in an
+    // unspecified state, if <i> is out of range or the record is malformed,
+    // which includes a turn limit over LinkChecker::kMaxTurnLimit.
+    bool load(const int i, PackedLevel *level) const;
+
+    // Returns the bytes of a pack of <levels>, or an empty string if one of
+    // them cannot be packed: a side over 255 cells, a content over 255, a
+    // turn limit over LinkChecker::kMaxTurnLimit, an item, or a spawn point
+    // off the map.
+    static std::string pack(const std::vector<PackedLevel> &levels);
+
+private:
+    const uint8_t *data;
+    size_t size;
+    uint32_t levels;
+    uint64_t indexOffset;
+
+#ifdef _WIN32
+    void *file;
+    void *mapping;
+#endif
+
+    static uint64_t readLe(const uint8_t *p, const int bytes);
+    static void writeLe(std::string *out, const uint64_t value,
+                        const int bytes);
+};
+
+#endif // LEVELPACK_H
@@ -0,0 +1,369 @@
+#include "linkchecker.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <initializer_list>
+
+namespace {
+
+// Write the corners of a path into <path>, skipping repeated points so that
+// degenerate corners of the line of sight engine do not show up.
+void setPath(LinkPath *path, std::initializer_list<Cell> corners)
+{
+    if (path == nullptr) {
+        return;
+    }
+    path->clear();
+    for (const Cell &cell: corners) {
+        if (path->empty() || path->back().r != cell.r ||
+            path->back().c != cell.c) {
+            path->push_back(cell);
+        }
+    }
+}
+
+// -1, 0 or 1 depending on the sign of <x>.
+int sign(const int x)
+{
+    return (x > 0) - (x < 0);
+}
+
+}
+
+LinkChecker::LinkChecker(const Board *board): board(board),
+    selectedEngine(LinkEngine::kLayeredBfs), maxTurnLimit(2),
+    linkKernel(&LinkChecker::connectWithin<2>), epoch(0)
+{
+
+}
+
+void LinkChecker::setBoard(const Board *board)
+{
+    this->board = board;
+}
+
+void LinkChecker::setEngine(const LinkEngine engine)
+{
+    this->selectedEngine = engine;
+}
+
+LinkEngine LinkChecker::engine() const
+{
+    return this->selectedEngine;
+}
+
+void LinkChecker::beginQuery()
+{
+    const size_t n = board->size();
+    if (stamps.size() != n) {
+        stamps.assign(n, 0);
+        segments.assign(n, 0);
+        parents.assign(n, -1);
+        queue.assign(n, 0);
+        epoch = 0;
+    }
+
+    // On wrap around, stale stamps could collide with new ones.
+    if (++epoch == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        epoch = 1;
+    }
+}
+
+void LinkChecker::reach(const int idx, const int segs, const int parent)
+{
+    stamps[idx] = epoch;
+    segments[idx] = segs;
+    parents[idx] = parent;
+}
+
+bool LinkChecker::found(const int corner, const int dst, LinkPath *path) const
+{
+    if (path != nullptr) {
+        path->clear();
+        path->push_back(board->cellAt(dst));
+        for (int p = corner; p != -1; p = parents[p]) {
+            path->push_back(board->cellAt(p));
+        }
+        std::reverse(path->begin(), path->end());
+    }
+    return true;
+}
+
+bool LinkChecker::connect(const Cell &from, const Cell &to,
+                          const int maxTurns, LinkPath *path)
+{
+    assert(board);
+    if (selectedEngine == LinkEngine::kLineOfSight && maxTurns <= 2) {
+        return connectLineOfSight(from, to, maxTurns, path);
+    }
+    const int src = board->index(from);
+    const int dst = board->index(to);
+    if (src == dst) {
+        return false;
+    }
+    return sweep(src, dst, maxTurns, path, nullptr);
+}
+
+void LinkChecker::connectAll(const Cell &from, const int maxTurns,
+                             std::vector<Cell> *blocks)
+{
+    assert(board);
+    if (blocks != nullptr) {
+        blocks->clear();
+    }
+    sweep(board->index(from), -1, maxTurns, nullptr, blocks);
+}
+
+bool LinkChecker::isReached(const Cell &cell) const
+{
+    return stamps[board->index(cell)] == epoch;
+}
+
+void LinkChecker::setTurnLimit(const int maxTurns)
+{
+    static bool (LinkChecker::*const kKernels[])(const Cell &, const Cell &,
+                                                 LinkPath *) = {
+        &LinkChecker::connectWithin<0>,
+        &LinkChecker::connectWithin<1>,
+        &LinkChecker::connectWithin<2>,
+        &LinkChecker::connectWithin<3>,
+        &LinkChecker::connectWithin<4>
+    };
+    static_assert(sizeof(kKernels) / sizeof(kKernels[0]) == kMaxTurnLimit + 1,
+                  "one kernel per turn limit");
+    assert(maxTurns >= 0 && maxTurns <= kMaxTurnLimit);
+    this->maxTurnLimit = maxTurns;
+    this->linkKernel = kKernels[maxTurns];
+}
+
+int LinkChecker::turnLimit() const
+{
+    return this->maxTurnLimit;
+}
+
+bool LinkChecker::link(const Cell &from, const Cell &to, LinkPath *path)
+{
+    assert(board);
+    return (this->*linkKernel)(from, to, path);
+}
+
+template <>
+bool LinkChecker::connectWithin<0>(const Cell &from, const Cell &to,
+                                   LinkPath *path)
+{
+    return (from.r != to.r || from.c != to.c) && linkStraight(from, to, path);
+}
+
+template <>
+bool LinkChecker::connectWithin<1>(const Cell &from, const Cell &to,
+                                   LinkPath *path)
+{
+    return (from.r != to.r || from.c != to.c) &&
+            (linkStraight(from, to, path) || linkOneCorner(from, to, path));
+}
+
+template <>
+bool LinkChecker::connectWithin<2>(const Cell &from, const Cell &to,
+                                   LinkPath *path)
+{
+    return (from.r != to.r || from.c != to.c) &&
+            (linkStraight(from, to, path) || linkOneCorner(from, to, path) ||
+             linkTwoCorners(from, to, path));
+}
+
+bool LinkChecker::sweep(const int src, const int dst, const int maxTurns,
+                        LinkPath *path, std::vector<Cell> *blocks)
+{
+    beginQuery();
+    const int steps[] = {
+        board->offset(Direction::kUp),
+        board->offset(Direction::kDown),
+        board->offset(Direction::kLeft),
+        board->offset(Direction::kRight)
+    };
+
+    int head = 0;
+    int tail = 0;
+    reach(src, 0, -1);
+    queue[tail++] = src;
+
+    // A path with <maxTurns> turns consists of <maxTurns> + 1 segments.
+    for (int segs = 1; segs <= maxTurns + 1 && head < tail; ++segs) {
+        const int layerEnd = tail;
+        for (; head < layerEnd; ++head) {
+            const int corner = queue[head];
+            for (int d = 0; d < 4; ++d) {
+                const int step = steps[d];
+
+                // The run ends at the nearest obstacle, which may be the
+                // destination block itself.
+                const int stop = corner + step *
+                        board->obstacleDistance(corner,
+                                                static_cast<Direction>(d));
+                for (int idx = corner + step; idx != stop; idx += step) {
+                    if (idx == dst) {
+                        return found(corner, dst, path);
+                    }
+                    if (stamps[idx] == epoch) {
+                        // A cell reached with fewer segments sweeps the rest
+                        // of this run itself.
+                        if (segments[idx] < segs) {
+                            break;
+                        }
+                        continue;
+                    }
+                    reach(idx, segs, corner);
+                    queue[tail++] = idx;
+                }
+                if (stop == dst) {
+                    return found(corner, dst, path);
+                }
+                if (stamps[stop] != epoch && board->isBlock(stop)) {
+                    reach(stop, segs, corner);
+                    if (blocks != nullptr) {
+                        blocks->push_back(board->cellAt(stop));
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+bool LinkChecker::connectLineOfSight(const Cell &from, const Cell &to,
+                                     const int maxTurns, LinkPath *path)
+{
+    if (from.r == to.r && from.c == to.c) {
+        return false;
+    }
+    return linkStraight(from, to, path) ||
+            (maxTurns >= 1 && linkOneCorner(from, to, path)) ||
+            (maxTurns >= 2 && linkTwoCorners(from, to, path));
+}
+
+bool LinkChecker::linkStraight(const Cell &from, const Cell &to,
+                               LinkPath *path)
+{
+    const BitBoard &bits = board->occupancy();
+    const int r1 = from.r;
+    const int c1 = from.c;
+    const int r2 = to.r;
+    const int c2 = to.c;
+    const int dr = sign(r2 - r1);
+    const int dc = sign(c2 - c1);
+
+    // The cells strictly between the two ends must be empty.
+    if (r1 == r2 &&
+        (std::abs(c2 - c1) == 1 || bits.rowClear(r1, c1 + dc, c2 - dc))) {
+        setPath(path, { from, to });
+        return true;
+    }
+    if (c1 == c2 &&
+        (std::abs(r2 - r1) == 1 || bits.colClear(c1, r1 + dr, r2 - dr))) {
+        setPath(path, { from, to });
+        return true;
+    }
+    return false;
+}
+
+bool LinkChecker::linkOneCorner(const Cell &from, const Cell &to,
+                                LinkPath *path)
+{
+    const BitBoard &bits = board->occupancy();
+    const int r1 = from.r;
+    const int c1 = from.c;
+    const int r2 = to.r;
+    const int c2 = to.c;
+    const int dr = sign(r2 - r1);
+    const int dc = sign(c2 - c1);
+
+    // The corner is either at (r1, c2) or at (r2, c1). The corner itself is
+    // covered by the first segment.
+    if (r1 == r2 || c1 == c2) {
+        return false;
+    }
+    if (bits.rowClear(r1, c1 + dc, c2) &&
+        (std::abs(r2 - r1) == 1 || bits.colClear(c2, r1 + dr, r2 - dr))) {
+        setPath(path, { from, { r1, c2 }, to });
+        return true;
+    }
+    if (bits.colClear(c1, r1 + dr, r2) &&
+        (std::abs(c2 - c1) == 1 || bits.rowClear(r2, c1 + dc, c2 - dc))) {
+        setPath(path, { from, { r2, c1 }, to });
+        return true;
+    }
+    return false;
+}
+
+bool LinkChecker::linkTwoCorners(const Cell &from, const Cell &to,
+                                 LinkPath *path)
+{
+    const BitBoard &bits = board->occupancy();
+    const int src = board->index(from);
+    const int dst = board->index(to);
+    const int r1 = from.r;
+    const int c1 = from.c;
+    const int r2 = to.r;
+    const int c2 = to.c;
+
+    // Candidate rows are those that both ends can reach by going straight up
+    // or down, and a row links the two ends if it is empty between the two
+    // columns. Candidate columns work the same way. Among all candidates,
+    // prefer the one that gives the shortest path. The obstacle distances only
+    // reach into the border lane in border routing mode, and the lane is
+    // always empty.
+    int bestLength = -1;
+    Cell corner1 = from;
+    Cell corner2 = to;
+
+    if (c1 != c2) {
+        const int lo = std::max(
+                    r1 - board->obstacleDistance(src, Direction::kUp),
+                    r2 - board->obstacleDistance(dst, Direction::kUp)) + 1;
+        const int hi = std::min(
+                    r1 + board->obstacleDistance(src, Direction::kDown),
+                    r2 + board->obstacleDistance(dst, Direction::kDown)) - 1;
+        for (int r = lo; r <= hi; ++r) {
+            const bool lane = r < 0 || r == board->rows();
+            if (r == r1 || r == r2 || (!lane && !bits.rowClear(r, c1, c2))) {
+                continue;
+            }
+            const int length = std::abs(r - r1) + std::abs(r - r2);
+            if (bestLength < 0 || length < bestLength) {
+                bestLength = length;
+                corner1 = { r, c1 };
+                corner2 = { r, c2 };
+            }
+        }
+    }
+
+    if (r1 != r2) {
+        const int lo = std::max(
+                    c1 - board->obstacleDistance(src, Direction::kLeft),
+                    c2 - board->obstacleDistance(dst, Direction::kLeft)) + 1;
+        const int hi = std::min(
+                    c1 + board->obstacleDistance(src, Direction::kRight),
+                    c2 + board->obstacleDistance(dst, Direction::kRight)) - 1;
+        for (int c = lo; c <= hi; ++c) {
+            const bool lane = c < 0 || c == board->cols();
+            if (c == c1 || c == c2 || (!lane && !bits.colClear(c, r1, r2))) {
+                continue;
+            }
+            const int length = std::abs(c - c1) + std::abs(c - c2);
+            if (bestLength < 0 || length < bestLength) {
+                bestLength = length;
+                corner1 = { r1, c };
+                corner2 = { r2, c };
+            }
+        }
+    }
+
+    if (bestLength < 0) {
+        return false;
+    }
+    setPath(path, { from, corner1, corner2, to });
+    return true;
+}
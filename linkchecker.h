@@ -0,0 +1,152 @@
+#ifndef LINKCHECKER_H
+#define LINKCHECKER_H
+
+#include "board.h"
+
+// Answers "can these two cells be linked with at most n turns" on a Board.
+//
+// The search is a breadth first search over (turns, cells): layer k holds the
+// cells that are reachable with k straight segments, and is built by sweeping
+// straight runs out of every cell of layer k - 1 until an obstacle is hit,
+// whose position is looked up in the obstacle table of the board. The cell a
+// run starts from is recorded as the parent of every cell it reaches, so
+// following parents from the destination yields exactly the corners of the
+// path.
+//
+// Scratch buffers are stamped with a per-query epoch instead of being cleared,
+// and are only reallocated when the size of the board changes, so a query does
+// not allocate. A LinkChecker is not thread safe, use one per thread.
+//
+// For links with at most two turns, the classic rules (straight, one corner,
+// two corners) can instead be answered by the line of sight engine, which only
+// tests whether row and column segments are empty on the occupancy bit sets of
+// the board. The engine is chosen at runtime, so both can be compared on the
+// same boards.
+//
+// Both engines follow the routing mode of the board: in border routing mode,
+// links may leave the map and run along the border lane around it, whose
+// cells then show up in paths with row or column -1, `rows()` or `cols()`.
+//
+// Games fix their turn limit once with `setTurnLimit`, and then query `link`.
+// It calls an instantiation of `connectWithin`, a template on the turn limit:
+// 0, 1 and 2 turns are specialized by hand on the line of sight tests, more
+// turns fall back to the breadth first search. Nothing branches on the turn
+// limit per query.
+class LinkChecker {
+public:
+    // Largest turn limit `setTurnLimit` accepts.
+    static const int kMaxTurnLimit = 4;
+
+    LinkChecker(const Board *board = nullptr);
+
+    // Sets the board that following queries run on.
+    void setBoard(const Board *board);
+
+    // Selects the algorithm that `connect` uses. Defaults to kLayeredBfs.
+    void setEngine(const LinkEngine engine);
+    LinkEngine engine() const;
+
+    // Returns true if <from> and <to> can be connected by a path of empty
+    // cells with at most <maxTurns> turns. If <path> is not null, it is
+    // overwritten with the corners of the path.
+    bool connect(const Cell &from, const Cell &to, const int maxTurns,
+                 LinkPath *path);
+
+    // Find every cell that can be connected to <from> with at most
+    // <maxTurns> turns, in a single sweep. If <blocks> is not null, it is
+    // overwritten with the blocks among them, i.e. the candidate partners of
+    // <from>. `isReached` answers for any other cell until the next query.
+    void connectAll(const Cell &from, const int maxTurns,
+                    std::vector<Cell> *blocks);
+
+    // Returns true if <cell> was found by the last `connectAll`.
+    bool isReached(const Cell &cell) const;
+
+    // Fixes the turn limit of `link` to <maxTurns>, from 0 to kMaxTurnLimit,
+    // by picking the matching instantiation of `connectWithin`. Defaults to 2.
+    void setTurnLimit(const int maxTurns);
+    int turnLimit() const;
+
+    // Same as `connect` with the turn limit set by `setTurnLimit`.
+    bool link(const Cell &from, const Cell &to, LinkPath *path);
+
+    // Same as `connect` with a turn limit of <kTurns>, known at compile time.
+    template <int kTurns>
+    bool connectWithin(const Cell &from, const Cell &to, LinkPath *path);
+
+private:
+    const Board *board;
+
+    LinkEngine selectedEngine;
+
+    // The instantiation of `connectWithin` that `link` calls.
+    int maxTurnLimit;
+    bool (LinkChecker::*linkKernel)(const Cell &, const Cell &, LinkPath *);
+
+    // Stamp of the current query. A cell has been reached by the current query
+    // only if its stamp equals this value.
+    uint32_t epoch;
+
+    std::vector<uint32_t> stamps;
+
+    // Number of straight segments needed to reach each cell.
+    std::vector<uint8_t> segments;
+
+    // The corner from which each cell was reached.
+    std::vector<int> parents;
+
+    // Cells in the order they are reached. Every cell is pushed at most once
+    // per query, so it never grows beyond the size of the board.
+    std::vector<int> queue;
+
+    // Invalidate results of the previous query, and resize buffers if the
+    // board has changed its size.
+    void beginQuery();
+
+    // Mark the cell <idx> as reached with <segs> segments from <parent>.
+    void reach(const int idx, const int segs, const int parent);
+
+    // Write the corners of the path that reaches <dst> from <corner> into
+    // <path> if it is not null. Always returns true.
+    bool found(const int corner, const int dst, LinkPath *path) const;
+
+    // Breadth first search over (turns, cells) from <src>. Stops and returns
+    // true as soon as <dst> is reached, writing its path into <path> if not
+    // null. Pass -1 as <dst> to sweep everything, and a non null <blocks> to
+    // collect the blocks that end a run.
+    bool sweep(const int src, const int dst, const int maxTurns,
+               LinkPath *path, std::vector<Cell> *blocks);
+
+    // `connect` implemented with row and column segment tests. Only handles
+    // up to two turns.
+    bool connectLineOfSight(const Cell &from, const Cell &to,
+                            const int maxTurns, LinkPath *path);
+
+    // The three cases of the line of sight engine: links without a turn, with
+    // exactly one turn, and with exactly two turns. <from> and <to> must
+    // differ.
+    bool linkStraight(const Cell &from, const Cell &to, LinkPath *path);
+    bool linkOneCorner(const Cell &from, const Cell &to, LinkPath *path);
+    bool linkTwoCorners(const Cell &from, const Cell &to, LinkPath *path);
+};
+
+template <int kTurns>
+bool LinkChecker::connectWithin(const Cell &from, const Cell &to,
+                                LinkPath *path)
+{
+    const int src = board->index(from);
+    const int dst = board->index(to);
+    return src != dst && sweep(src, dst, kTurns, path, nullptr);
+}
+
+template <>
+bool LinkChecker::connectWithin<0>(const Cell &from, const Cell &to,
+                                   LinkPath *path);
+template <>
+bool LinkChecker::connectWithin<1>(const Cell &from, const Cell &to,
+                                   LinkPath *path);
+template <>
+bool LinkChecker::connectWithin<2>(const Cell &from, const Cell &to,
+                                   LinkPath *path);
+
+#endif // LINKCHECKER_H
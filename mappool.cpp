@@ -0,0 +1,252 @@
+#include "mappool.h"
+
+#include <cassert>
+#include <chrono>
+
+#include "regionindex.h"
+
+MapPool::MapPool(const GeneratorOptions &options, const int depth,
+                 const int workers): options(options), stockDepth(depth),
+    stopping(false), seeds(GameRandom::freshSeed()), nHits(0), nMisses(0)
+{
+    assert(depth >= 0 && workers >= 0);
+    assert(options.rows > 0 && options.cols > 0);
+    assert(options.blocks >= 0 && !(options.blocks & 1));
+    assert(options.blocksPerType > 0 && !(options.blocksPerType & 1));
+    assert(options.blocks + 2 <= options.rows * options.cols);
+    for (int i = 0; i < kQueues; ++i) {
+        queues[i].spec.maxTurns = i / 12;
+        queues[i].spec.borderRouting = (i / 6) & 1;
+        queues[i].spec.players = (i / 3) % 2 + 1;
+        queues[i].spec.difficulty = static_cast<Difficulty>(i % 3);
+    }
+    for (int i = 0; i < workers; ++i) {
+        threads.emplace_back(&MapPool::loop, this);
+    }
+}
+
+MapPool::~MapPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &t: threads) {
+        t.join();
+    }
+}
+
+void MapPool::setDepth(const int depth)
+{
+    assert(depth >= 0);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stockDepth = depth;
+    }
+    wake.notify_all();
+}
+
+int MapPool::depth() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return stockDepth;
+}
+
+void MapPool::prefill(const MapSpec &spec)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        queues[queueOf(spec)].wanted = true;
+    }
+    wake.notify_all();
+}
+
+PooledMap MapPool::take(const MapSpec &spec)
+{
+    uint64_t seed;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        Queue &queue = queues[queueOf(spec)];
+        queue.wanted = true;
+        if (!queue.maps.empty()) {
+            PooledMap map = std::move(queue.maps.front());
+            queue.maps.pop_front();
+            ++nHits;
+            wake.notify_one();
+            return map;
+        }
+        ++nMisses;
+        seed = seeds();
+    }
+    wake.notify_all();
+    return generate(spec, seed, &search);
+}
+
+PooledMap MapPool::mapFor(const MapSpec &spec, const uint64_t seed)
+{
+    return generate(spec, seed, &search);
+}
+
+int MapPool::ready(const MapSpec &spec) const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return static_cast<int>(queues[queueOf(spec)].maps.size());
+}
+
+uint64_t MapPool::hits() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return this->nHits;
+}
+
+uint64_t MapPool::misses() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return this->nMisses;
+}
+
+int MapPool::queueOf(const MapSpec &spec)
+{
+    assert(spec.maxTurns >= 0 && spec.maxTurns <= LinkChecker::kMaxTurnLimit);
+    assert(spec.players == 1 || spec.players == 2);
+    assert(spec.difficulty >= kEasy && spec.difficulty <= kHard);
+    return spec.maxTurns * 12 + spec.borderRouting * 6 +
+            (spec.players - 1) * 3 + spec.difficulty;
+}
+
+int MapPool::nextQueue() const
+{
+    // Fill the emptiest queue first, so that every spec asked for gets a map
+    // before any gets a second one.
+    int best = -1;
+    int bestStock = stockDepth;
+    for (int i = 0; i < kQueues; ++i) {
+        const int stock = static_cast<int>(queues[i].maps.size()) +
+                queues[i].pending;
+        if (queues[i].wanted && stock < bestStock) {
+            best = i;
+            bestStock = stock;
+        }
+    }
+    return best;
+}
+
+void MapPool::loop()
+{
+    DifficultySearch workerSearch(1);
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        int next = -1;
+        wake.wait(guard, [&] {
+            return stopping || (next = nextQueue()) >= 0;
+        });
+        if (stopping) {
+            return;
+        }
+
+        Queue &queue = queues[next];
+        const MapSpec spec = queue.spec;
+        const uint64_t seed = seeds();
+        ++queue.pending;
+        guard.unlock();
+        PooledMap map = generate(spec, seed, &workerSearch);
+        guard.lock();
+        --queue.pending;
+        if (map.validated) {
+            queue.maps.push_back(std::move(map));
+        }
+    }
+}
+
+PooledMap MapPool::generate(const MapSpec &spec, const uint64_t seed,
+                            DifficultySearch *search) const
+{
+    GeneratorOptions specOptions = options;
+    specOptions.maxTurns = spec.maxTurns;
+    specOptions.players = spec.players;
+
+    const DifficultyTarget target = DifficultyTarget::forTier(
+                spec.difficulty, spec.maxTurns, spec.borderRouting,
+                options.blocks);
+
+    const auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::milliseconds(kBudgetMillis);
+    const auto millisLeft = [&] {
+        return static_cast<int>(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - std::chrono::steady_clock::now()).count());
+    };
+
+    GameRandom random(seed);
+    PooledMap map;
+    map.spec = spec;
+    map.seed = seed;
+    map.board.setBorderRouting(spec.borderRouting);
+    for (int i = 0; i < kMaxAttempts && !stopping && millisLeft() > 0; ++i) {
+        SearchResult result = search->search(
+                    &map.board, specOptions, target,
+                    &random.stream(kMapStream), millisLeft());
+        map.spawns = std::move(result.generated.spawns);
+        map.metrics = result.metrics;
+        map.onTarget = result.onTarget;
+        map.validated = result.generated.complete &&
+                validate(map, result.generated.order);
+        if (map.validated) {
+            return map;
+        }
+    }
+
+    // Plain maps are not measured while generated, and are rarely far off.
+    BoardGenerator generator;
+    map.onTarget = false;
+    for (int i = 0; i < kMaxAttempts && (i == 0 || millisLeft() > 0); ++i) {
+        const uint64_t fallbackSeed = random.stream(kMapStream)();
+        GeneratorResult generated = generator.generate(
+                    &map.board, fallbackSeed, specOptions);
+        map.spawns = std::move(generated.spawns);
+        map.validated = generated.complete &&
+                validate(map, generated.order);
+        if (map.validated) {
+            DifficultyMeter meter;
+            map.metrics = meter.measure(map.board, map.spawns[0],
+                                        spec.maxTurns, fallbackSeed);
+            break;
+        }
+    }
+    return map;
+}
+
+bool MapPool::validate(const PooledMap &map,
+                       const std::vector<std::pair<Cell, Cell>> &order) const
+{
+    Board board = map.board;
+    LinkChecker checker(&board);
+    checker.setTurnLimit(map.spec.maxTurns);
+    RegionIndex regions(&board);
+    regions.rebuild();
+
+    if (static_cast<int>(map.spawns.size()) != map.spec.players ||
+        static_cast<int>(order.size()) * 2 != options.blocks) {
+        return false;
+    }
+    for (const auto &move: order) {
+        const Cell &a = move.first;
+        const Cell &b = move.second;
+        if (!board.isBlock(board.index(a)) || !board.isBlock(board.index(b)) ||
+            board.content(a.r, a.c) != board.content(b.r, b.c) ||
+            !checker.link(a, b, nullptr)) {
+            return false;
+        }
+        for (const Cell &spawn: map.spawns) {
+            if (!regions.canReach(spawn, a) || !regions.canReach(spawn, b)) {
+                return false;
+            }
+        }
+        board.clearCell(a.r, a.c);
+        board.clearCell(b.r, b.c);
+        regions.removeBlock(a);
+        regions.removeBlock(b);
+    }
+    return true;
+}
@@ -0,0 +1,168 @@
+#ifndef MAPPOOL_H
+#define MAPPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "difficultysearch.h"
+#include "gamerandom.h"
+
+// Settings of a new game that its map depends on.
+struct MapSpec {
+    // Turns that a link may take.
+    int maxTurns = 2;
+
+    // True if links may run around the map.
+    bool borderRouting = false;
+
+    // Number of players, 1 or 2.
+    int players = 1;
+
+    // Difficulty that the map is searched for.
+    Difficulty difficulty = kNormal;
+};
+
+struct PooledMap {
+    MapSpec spec;
+
+    // Seed of the game the map is for. The map is generated from the
+    // kMapStream stream of a GameRandom with this seed.
+    uint64_t seed = 0;
+
+    // A board that can be cleared with <spec>, in the routing mode of <spec>.
+    Board board;
+
+    // Cells the players start on, player 1 first.
+    std::vector<Cell> spawns;
+
+    // Difficulty of the board as measured from the first spawn point, and
+    // whether it is within tolerance of the difficulty of <spec>.
+    BoardMetrics metrics;
+    bool onTarget = false;
+
+    // True if the clearing order of <board> has been replayed. A map that
+    // has not is not fit for a game, see `MapPool::generate`.
+    bool validated = false;
+};
+
+// Keeps maps for new games ready, so that starting a game does not wait for
+// one to be generated. Worker threads keep <depth> maps of every spec that
+// has been asked for in stock. A map only goes into stock once its clearing
+// order has been replayed, so a generator bug never reaches a game.
+//
+// Specs index a fixed table of queues, and maps are moved out of their queue,
+// so taking a ready map takes constant time. When none is ready, the map is
+// searched for on all hardware threads instead, within kBudgetMillis, and
+// counted as a miss.
+class MapPool {
+public:
+    // Keep <depth> maps of each spec ready, generated with the size and
+    // blocks of <options> by <workers> threads. <options> must describe maps
+    // that can be generated: a map of at least one cell, with room for the
+    // players, of blocks in even groups.
+    MapPool(const GeneratorOptions &options, const int depth,
+            const int workers = 1);
+    ~MapPool();
+
+    MapPool(const MapPool &) = delete;
+    MapPool &operator=(const MapPool &) = delete;
+
+    // Change the number of maps kept ready of each spec. Surplus maps are
+    // kept until taken.
+    void setDepth(const int depth);
+    int depth() const;
+
+    // Start keeping maps of <spec> ready before the first one is taken.
+    void prefill(const MapSpec &spec);
+
+    // Returns a map of <spec>, taken from stock if there is one. Not meant to
+    // be called from several threads at once. A map that could not be
+    // validated is returned with `PooledMap::validated` false.
+    PooledMap take(const MapSpec &spec);
+
+    // Returns the map of <spec> for the game with seed <seed>, generated on
+    // the calling thread, as when replaying a game. Validated as by `take`.
+    // Not meant to be called from several threads at once, nor along with
+    // `take`.
+    PooledMap mapFor(const MapSpec &spec, const uint64_t seed);
+
+    // Maps of <spec> that are ready.
+    int ready(const MapSpec &spec) const;
+
+    // Number of `take` calls that found a map ready, and that did not.
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+private:
+    // Maps of one spec, and the number being generated by workers.
+    struct Queue {
+        MapSpec spec;
+        std::deque<PooledMap> maps;
+        int pending = 0;
+        bool wanted = false;
+    };
+
+    // Number of queues: one per turn limit, routing mode, player count and
+    // difficulty.
+    static const int kQueues = (LinkChecker::kMaxTurnLimit + 1) * 2 * 2 * 3;
+
+    // Time budget of generating a map, searches and plain maps together.
+    static const int kBudgetMillis = 500;
+
+    // Difficulty searches made for a map before settling for one from a
+    // plain generator, and plain maps drawn before giving up.
+    static const int kMaxAttempts = 4;
+
+    const GeneratorOptions options;
+
+    std::vector<std::thread> threads;
+
+    mutable std::mutex lock;
+    std::condition_variable wake;
+
+    Queue queues[kQueues];
+    int stockDepth;
+
+    // Set under <lock>, read by `generate` between attempts as well.
+    std::atomic<bool> stopping;
+
+    // Draws the seeds of all games, so that workers never share one.
+    Xoshiro256 seeds;
+
+    uint64_t nHits;
+    uint64_t nMisses;
+
+    // Searches the maps of `take` misses and of `mapFor`.
+    DifficultySearch search;
+
+    static int queueOf(const MapSpec &spec);
+
+    // Returns a queue that needs another map, or -1. Requires <lock>.
+    int nextQueue() const;
+
+    void loop();
+
+    // Search a validated map of <spec> for the game with seed <seed> with
+    // <search>. Should an attempt fail, the next one draws on with the time
+    // left of kBudgetMillis. After kMaxAttempts failures, once the budget is
+    // spent or once the pool is stopping, maps are drawn from a plain
+    // generator instead, up to kMaxAttempts of them while the budget lasts,
+    // and at least one. If none of them validates either, which only happens
+    // with options that maps cannot be generated for, the last one is
+    // returned marked as not validated.
+    PooledMap generate(const MapSpec &spec, const uint64_t seed,
+                       DifficultySearch *search) const;
+
+    // Returns true if taking the pairs of <order> away one after another
+    // clears <map>, linking each pair and walking up to it from every spawn
+    // point.
+    bool validate(const PooledMap &map,
+                  const std::vector<std::pair<Cell, Cell>> &order) const;
+};
+
+#endif // MAPPOOL_H
@@ -0,0 +1,114 @@
+#include "moveenumerator.h"
+
+#include <atomic>
+
+MoveEnumerator::MoveEnumerator(const int workers): pool(workers),
+    checkers(pool.workerCount()),
+    partners(pool.workerCount()),
+    found(pool.workerCount()),
+    firsts(pool.workerCount())
+{
+
+}
+
+int MoveEnumerator::workerCount() const
+{
+    return pool.workerCount();
+}
+
+void MoveEnumerator::findAll(const Board &board, const int maxTurns,
+                             std::vector<Move> *moves)
+{
+    prepare(board);
+
+    // Only blocks of the same content pair up, so the sources are taken
+    // bucket by bucket.
+    std::vector<int> sources;
+    for (BlockContent bc = 1; bc < board.contentLimit(); ++bc) {
+        const std::vector<int> &blocks = board.blocksOf(bc);
+        sources.insert(sources.end(), blocks.begin(), blocks.end());
+    }
+
+    pool.run(static_cast<int>(sources.size()),
+             [&](const int task, const int worker) {
+        const int a = sources[task];
+        const Cell from = board.cellAt(a);
+        const BlockContent bc = board.content(from.r, from.c);
+        checkers[worker].connectAll(from, maxTurns, &partners[worker]);
+        for (const Cell &cell: partners[worker]) {
+            const int b = board.index(cell);
+            if (b > a && board.content(cell.r, cell.c) == bc) {
+                found[worker].emplace_back(a, b);
+            }
+        }
+    });
+
+    moves->clear();
+    for (auto &f: found) {
+        moves->insert(moves->end(), f.begin(), f.end());
+    }
+}
+
+void MoveEnumerator::prepare(const Board &board)
+{
+    for (int i = 0; i < workerCount(); ++i) {
+        checkers[i].setBoard(&board);
+        found[i].clear();
+        firsts[i] = { -1, -1 };
+    }
+}
+
+bool MoveEnumerator::findFirst(const Board &board, const int maxTurns,
+                               const std::vector<int> &sources,
+                               const std::vector<int> &ranks, Move *move)
+{
+    prepare(board);
+    const int n = static_cast<int>(sources.size());
+
+    // Position in <sources> of the best source with a partner found so far.
+    // Sources at or behind it are skipped.
+    std::atomic<int> bound(n);
+
+    pool.run(n, [&](const int task, const int worker) {
+        if (task >= bound.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        const Cell from = board.cellAt(sources[task]);
+        const BlockContent bc = board.content(from.r, from.c);
+        int partner = -1;
+        checkers[worker].connectAll(from, maxTurns, &partners[worker]);
+        for (const Cell &cell: partners[worker]) {
+            const int b = board.index(cell);
+            if (board.content(cell.r, cell.c) == bc && ranks[b] >= 0 &&
+                (partner < 0 || ranks[b] < ranks[partner])) {
+                partner = b;
+            }
+        }
+        if (partner < 0) {
+            return;
+        }
+
+        Move &first = firsts[worker];
+        if (first.first < 0 || task < first.first) {
+            first = { task, partner };
+        }
+        int current = bound.load(std::memory_order_relaxed);
+        while (task < current &&
+               !bound.compare_exchange_weak(current, task,
+                                            std::memory_order_relaxed)) {
+        }
+    });
+
+    Move best = { -1, -1 };
+    for (const Move &first: firsts) {
+        if (first.first >= 0 && (best.first < 0 || first.first < best.first)) {
+            best = first;
+        }
+    }
+    if (best.first < 0) {
+        return false;
+    }
+    *move = { sources[best.first], best.second };
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef MOVEENUMERATOR_H
+#define MOVEENUMERATOR_H
+
+#include <utility>
+#include <vector>
+
+#include "linkchecker.h"
+#include "taskpool.h"
+
+// Enumerates legal moves, i.e. pairs of blocks of the same content that can be
+// linked within a turn limit, by sweeping from candidate source blocks on the
+// workers of a TaskPool. Every worker owns its own LinkChecker, while the Board
+// is shared and must not change during a call.
+//
+// Sources are given in order of preference. Since the pool runs low task
+// numbers first, the preferred sources are swept early, and as soon as one of
+// them has a partner every source behind it is skipped.
+class MoveEnumerator {
+public:
+    // A legal move, as the flat indices of its two blocks.
+    typedef std::pair<int, int> Move;
+
+    // Use <workers> threads, or one per hardware thread if <workers> is 0.
+    MoveEnumerator(const int workers = 0);
+
+    int workerCount() const;
+
+    // Find the first block in <sources> that has a partner, and its partner
+    // with the lowest non-negative <ranks> entry. Blocks whose entry in
+    // <ranks>, indexed by flat index, is negative are not accepted as
+    // partners. Returns false if no source has a partner.
+    bool findFirst(const Board &board, const int maxTurns,
+                   const std::vector<int> &sources,
+                   const std::vector<int> &ranks, Move *move);
+
+    // Overwrite <moves> with every legal move on <board>, the smaller flat
+    // index first, in no particular order.
+    void findAll(const Board &board, const int maxTurns,
+                 std::vector<Move> *moves);
+
+private:
+    TaskPool pool;
+
+    // Per worker state.
+    std::vector<LinkChecker> checkers;
+    std::vector<std::vector<Cell>> partners;
+    std::vector<std::vector<Move>> found;
+
+    // Best find of each worker in `findFirst`, as the position of the source in
+    // the list of sources and the flat index of its partner, or -1.
+    std::vector<Move> firsts;
+
+    void prepare(const Board &board);
+};
+
+#endif // MOVEENUMERATOR_H
@@ -0,0 +1,53 @@
+#include "nextstep.h"
+
+#include <algorithm>
+#include <tuple>
+
+int nearestRank(const Board &board, const Cell &cell, const Cell &player)
+{
+    const int rowRank = cell.r <= player.r ? player.r - cell.r : cell.r;
+    const int colRank = cell.c <= player.c ? player.c - cell.c : cell.c;
+    return rowRank * board.cols() + colRank;
+}
+
+int pairCost(const DistanceField &field, const Cell &a, const Cell &b)
+{
+    const int first = field.reachCost(a);
+    const int second = field.reachCost(b);
+    return first < 0 || second < 0 ? -1 : first + second;
+}
+
+int findCheapestPairs(const Board &board, const PairIndex &pairs,
+                      const DistanceField &field, const int k,
+                      std::vector<std::pair<Cell, Cell>> *best)
+{
+    // Sort keys: cost of the pair, cost of the nearer block, and the flat
+    // indices of both blocks.
+    typedef std::tuple<int, int, int, int> Rank;
+    std::vector<Rank> ranks;
+
+    for (int i = 0; i < pairs.count(); ++i) {
+        const auto candidate = pairs.pairAt(i);
+        int first = field.reachCost(candidate.first);
+        int second = field.reachCost(candidate.second);
+        if (first < 0 || second < 0) {
+            continue;
+        }
+        int a = board.index(candidate.first);
+        int b = board.index(candidate.second);
+        if (first > second || (first == second && a > b)) {
+            std::swap(first, second);
+            std::swap(a, b);
+        }
+        ranks.emplace_back(first + second, first, a, b);
+    }
+
+    const int n = std::min(k, static_cast<int>(ranks.size()));
+    std::partial_sort(ranks.begin(), ranks.begin() + n, ranks.end());
+    best->clear();
+    for (int i = 0; i < n; ++i) {
+        best->emplace_back(board.cellAt(std::get<2>(ranks[i])),
+                           board.cellAt(std::get<3>(ranks[i])));
+    }
+    return n;
+}
@@ -0,0 +1,28 @@
+#ifndef NEXTSTEP_H
+#define NEXTSTEP_H
+
+#include <utility>
+#include <vector>
+
+#include "distancefield.h"
+#include "pairindex.h"
+
+// Rank of <cell> in the order in which blocks are swept around a player
+// standing at <player>: rows outward from the player, upwards first, and
+// within a row columns outward from the player, leftwards first.
+int nearestRank(const Board &board, const Cell &cell, const Cell &player);
+
+// Walking cost of the pair <a>, <b> for the player of <field>: steps to walk up
+// to <a>, back, and up to <b>, i.e. the sum of their `reachCost`s. -1 if the
+// player cannot walk up to one of them.
+int pairCost(const DistanceField &field, const Cell &a, const Cell &b);
+
+// Fill <best> with the <k> pairs in <pairs> that the player of <field> can walk
+// up to at the lowest `pairCost`, cheapest first. Ties are broken by the cost
+// of the nearer block, which comes first in each pair, then by flat indices.
+// <field> must be fresh. Returns the number of pairs found.
+int findCheapestPairs(const Board &board, const PairIndex &pairs,
+                      const DistanceField &field, const int k,
+                      std::vector<std::pair<Cell, Cell>> *best);
+
+#endif // NEXTSTEP_H
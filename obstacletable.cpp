@@ -0,0 +1,59 @@
+#include "obstacletable.h"
+
+#include "board.h"
+
+ObstacleTable::ObstacleTable()
+{
+
+}
+
+void ObstacleTable::rebuild(const Board &board)
+{
+    for (auto &d: distances) {
+        d.assign(board.size(), 0);
+    }
+    for (int r = -1; r <= board.rows(); ++r) {
+        updateRow(board, r);
+    }
+    for (int c = -1; c <= board.cols(); ++c) {
+        updateCol(board, c);
+    }
+}
+
+void ObstacleTable::update(const Board &board, const int r, const int c)
+{
+    updateRow(board, r);
+    updateCol(board, c);
+}
+
+void ObstacleTable::updateRow(const Board &board, const int r)
+{
+    const int first = board.index(r, -1);
+    const int last = board.index(r, board.cols());
+    std::vector<int> &left = distances[Direction::kLeft];
+    std::vector<int> &right = distances[Direction::kRight];
+
+    for (int idx = first; idx <= last; ++idx) {
+        left[idx] = board.isLinkObstacle(idx - 1) ? 1 : left[idx - 1] + 1;
+    }
+    for (int idx = last; idx >= first; --idx) {
+        right[idx] = board.isLinkObstacle(idx + 1) ? 1 : right[idx + 1] + 1;
+    }
+}
+
+void ObstacleTable::updateCol(const Board &board, const int c)
+{
+    const int stride = board.stride();
+    const int first = board.index(-1, c);
+    const int last = board.index(board.rows(), c);
+    std::vector<int> &up = distances[Direction::kUp];
+    std::vector<int> &down = distances[Direction::kDown];
+
+    for (int idx = first; idx <= last; idx += stride) {
+        up[idx] = board.isLinkObstacle(idx - stride) ? 1 : up[idx - stride] + 1;
+    }
+    for (int idx = last; idx >= first; idx -= stride) {
+        down[idx] = board.isLinkObstacle(idx + stride) ? 1 :
+                                                     down[idx + stride] + 1;
+    }
+}
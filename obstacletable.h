@@ -0,0 +1,45 @@
+#ifndef OBSTACLETABLE_H
+#define OBSTACLETABLE_H
+
+#include <vector>
+
+#include "types.h"
+
+class Board;
+
+// For every cell of a Board and of its border lane, the number of steps to the
+// nearest cell that links cannot pass through in each of the four directions,
+// the wall ring included. A distance of 1 means the neighbour is such a cell,
+// so "can I go <n> cells straight from here" is a single comparison.
+//
+// Changing one cell only affects distances along its row and column, which is
+// all that `update` recomputes.
+class ObstacleTable {
+public:
+    ObstacleTable();
+
+    // Recompute all distances of <board>.
+    void rebuild(const Board &board);
+
+    // Recompute the distances that depend on the cell at row <r>, column <c>
+    // of <board>, after that cell has changed.
+    void update(const Board &board, const int r, const int c);
+
+    // Steps from the cell with flat index <idx> to the nearest obstacle in
+    // direction <d>.
+    int distance(const int idx, const Direction d) const;
+
+private:
+    // Indexed by Direction, then by flat index.
+    std::vector<int> distances[4];
+
+    void updateRow(const Board &board, const int r);
+    void updateCol(const Board &board, const int c);
+};
+
+inline int ObstacleTable::distance(const int idx, const Direction d) const
+{
+    return distances[d][idx];
+}
+
+#endif // OBSTACLETABLE_H
@@ -0,0 +1,191 @@
+#include "pairindex.h"
+
+#include <algorithm>
+#include <cassert>
+
+PairIndex::PairIndex(const Board *board): board(board), maxTurns(0),
+    enumerator(nullptr), checker(board), verifier(board)
+{
+
+}
+
+void PairIndex::setBoard(const Board *board)
+{
+    this->board = board;
+    checker.setBoard(board);
+    verifier.setBoard(board);
+}
+
+void PairIndex::setEnumerator(MoveEnumerator *enumerator)
+{
+    this->enumerator = enumerator;
+}
+
+void PairIndex::rebuild(const int maxTurns)
+{
+    assert(board);
+    this->maxTurns = maxTurns;
+    pairList.clear();
+    positions.clear();
+    partnersOf.assign(board->size(), std::vector<int>());
+
+    if (enumerator) {
+        enumerator->findAll(*board, maxTurns, &moves);
+        for (const auto &m: moves) {
+            add(m.first, m.second);
+        }
+        return;
+    }
+
+    // Only blocks of the same content can pair up, so walk the content
+    // buckets and sweep once per block.
+    for (BlockContent bc = 1; bc < board->contentLimit(); ++bc) {
+        for (const int a: board->blocksOf(bc)) {
+            checker.connectAll(board->cellAt(a), maxTurns, &candidates);
+            for (const Cell &cell: candidates) {
+                const int b = board->index(cell);
+                if (b > a && board->content(cell.r, cell.c) == bc) {
+                    add(a, b);
+                }
+            }
+        }
+    }
+}
+
+void PairIndex::removeBlock(const Cell &cell)
+{
+    const int x = board->index(cell);
+    assert(!board->isBlock(x));
+
+    // Pairs with the removed block are gone.
+    const std::vector<int> partners = partnersOf[x];
+    for (const int y: partners) {
+        erase(x, y);
+    }
+
+    findNewPairs(cell, &moves);
+    for (const auto &m: moves) {
+        add(m.first, m.second);
+    }
+}
+
+int PairIndex::countAfterRemoving(const Cell &a, const Cell &b)
+{
+    const int x = board->index(a);
+    const int y = board->index(b);
+    assert(!board->isBlock(x) && !board->isBlock(y));
+
+    const int lost = static_cast<int>(partnersOf[x].size()) +
+            static_cast<int>(partnersOf[y].size()) -
+            static_cast<int>(positions.count(key(x, y)));
+
+    // A pair that routes through both cells is found from either of them.
+    gained.clear();
+    for (const Cell &cell: { a, b }) {
+        findNewPairs(cell, &moves);
+        for (const auto &m: moves) {
+            gained.insert(key(m.first, m.second));
+        }
+    }
+    return count() - lost + static_cast<int>(gained.size());
+}
+
+int PairIndex::count() const
+{
+    return static_cast<int>(pairList.size());
+}
+
+std::pair<Cell, Cell> PairIndex::pairAt(const int i) const
+{
+    return { board->cellAt(pairList[i].first),
+             board->cellAt(pairList[i].second) };
+}
+
+bool PairIndex::contains(const Cell &a, const Cell &b) const
+{
+    return positions.count(key(board->index(a), board->index(b)));
+}
+
+int PairIndex::partnerCount(const Cell &cell) const
+{
+    return static_cast<int>(partnersOf[board->index(cell)].size());
+}
+
+bool PairIndex::isConsistent()
+{
+    PairIndex fresh(board);
+    fresh.rebuild(maxTurns);
+    if (fresh.count() != count()) {
+        return false;
+    }
+    for (const auto &p: fresh.pairList) {
+        if (!positions.count(key(p.first, p.second))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t PairIndex::key(const int a, const int b)
+{
+    const uint64_t lo = static_cast<uint32_t>(std::min(a, b));
+    const uint64_t hi = static_cast<uint32_t>(std::max(a, b));
+    return (hi << 32) | lo;
+}
+
+void PairIndex::add(const int a, const int b)
+{
+    positions[key(a, b)] = static_cast<int>(pairList.size());
+    pairList.emplace_back(std::min(a, b), std::max(a, b));
+    partnersOf[a].push_back(b);
+    partnersOf[b].push_back(a);
+}
+
+void PairIndex::erase(const int a, const int b)
+{
+    const auto it = positions.find(key(a, b));
+    assert(it != positions.end());
+
+    // Move the last pair into the hole.
+    const int pos = it->second;
+    positions.erase(it);
+    if (pos != count() - 1) {
+        pairList[pos] = pairList.back();
+        positions[key(pairList[pos].first, pairList[pos].second)] = pos;
+    }
+    pairList.pop_back();
+
+    auto &pa = partnersOf[a];
+    auto &pb = partnersOf[b];
+    pa.erase(std::find(pa.begin(), pa.end(), b));
+    pb.erase(std::find(pb.begin(), pb.end(), a));
+}
+
+void PairIndex::findNewPairs(const Cell &cell,
+                             std::vector<MoveEnumerator::Move> *pairs)
+{
+    // Group the blocks the cell can see by content, so that only blocks of the
+    // same content are tried against each other.
+    pairs->clear();
+    checker.connectAll(cell, maxTurns, &candidates);
+    std::sort(candidates.begin(), candidates.end(),
+              [this](const Cell &a, const Cell &b) {
+        return board->content(a.r, a.c) < board->content(b.r, b.c);
+    });
+
+    const int n = static_cast<int>(candidates.size());
+    for (int i = 0; i < n; ++i) {
+        const Cell &a = candidates[i];
+        const BlockContent bc = board->content(a.r, a.c);
+        for (int j = i + 1;
+             j < n && board->content(candidates[j].r, candidates[j].c) == bc;
+             ++j) {
+            const Cell &b = candidates[j];
+            if (!contains(a, b) && verifier.connect(a, b, maxTurns, nullptr)) {
+                const int x = board->index(a);
+                const int y = board->index(b);
+                pairs->emplace_back(std::min(x, y), std::max(x, y));
+            }
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef PAIRINDEX_H
+#define PAIRINDEX_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "linkchecker.h"
+#include "moveenumerator.h"
+
+// Index of the pairs of blocks that can be eliminated right now, i.e. blocks of
+// the same content that can be linked within the turn limit. Positions of the
+// players are not taken into account.
+//
+// Eliminations only ever free cells, so a pair that is linkable stays linkable
+// until one of its blocks goes away. A pair that becomes linkable has to route
+// through a freed cell, so both of its blocks are reachable from that cell
+// within the turn limit, and only those pairs are evaluated again.
+class PairIndex {
+public:
+    PairIndex(const Board *board = nullptr);
+
+    // Sets the board that the index is built on. Must be followed by a
+    // `rebuild`, unless <board> is a copy of the board the index was built on,
+    // as when copying an index along with its board.
+    void setBoard(const Board *board);
+
+    // Sets the enumerator that `rebuild` spreads its sweeps over, or null to
+    // sweep on the calling thread.
+    void setEnumerator(MoveEnumerator *enumerator);
+
+    // Discard the index and build it from scratch, with links of at most
+    // <maxTurns> turns. Costs one sweep per block.
+    void rebuild(const int maxTurns);
+
+    // Update the index after the block at <cell> has been removed from the
+    // board.
+    void removeBlock(const Cell &cell);
+
+    // Number of pairs that the index would hold after removing the blocks at
+    // <a> and <b>, which have already been cleared on the board but not yet
+    // removed from the index. Leaves the index untouched, so that the moves
+    // of a position can be scored without copying it.
+    int countAfterRemoving(const Cell &a, const Cell &b);
+
+    // Number of linkable pairs. The board is stuck when it is 0.
+    int count() const;
+
+    // The <i>-th linkable pair, in no particular order.
+    std::pair<Cell, Cell> pairAt(const int i) const;
+
+    // Returns true if the blocks at <a> and <b> are indexed as a linkable pair.
+    bool contains(const Cell &a, const Cell &b) const;
+
+    // Number of indexed pairs that the block at <cell> is part of.
+    int partnerCount(const Cell &cell) const;
+
+    // Returns true if the index holds exactly the pairs that a rebuild would
+    // find. Expensive, only meant for debugging and tests.
+    bool isConsistent();
+
+private:
+    const Board *board;
+
+    int maxTurns;
+
+    MoveEnumerator *enumerator;
+
+    // Sweeps for candidates.
+    LinkChecker checker;
+
+    // Confirms candidates found by <checker>, without destroying its result.
+    LinkChecker verifier;
+
+    // Pairs of flat indices, the smaller index first.
+    std::vector<std::pair<int, int>> pairList;
+
+    // Position of each pair in <pairList>, keyed by `key`.
+    std::unordered_map<uint64_t, int> positions;
+
+    // The blocks that each block currently forms a pair with, by flat index.
+    std::vector<std::vector<int>> partnersOf;
+
+    // Scratch buffers for sweep results.
+    std::vector<Cell> candidates;
+    std::vector<MoveEnumerator::Move> moves;
+    std::unordered_set<uint64_t> gained;
+
+    static uint64_t key(const int a, const int b);
+
+    void add(const int a, const int b);
+    void erase(const int a, const int b);
+
+    // Overwrite <pairs> with the linkable pairs that route through the empty
+    // <cell> and are not in the index yet. Both of their blocks are reachable
+    // from <cell> within the turn limit, so one sweep finds the candidates.
+    void findNewPairs(const Cell &cell,
+                      std::vector<MoveEnumerator::Move> *pairs);
+};
+
+#endif // PAIRINDEX_H
@@ -0,0 +1,145 @@
+#include "pathfinder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+
+PathFinder::PathFinder(const Board *board): board(board), stamp(0),
+    nExpanded(0)
+{
+
+}
+
+void PathFinder::setBoard(const Board *board)
+{
+    this->board = board;
+}
+
+bool PathFinder::findRoute(const Cell &from, const Cell &target,
+                           std::vector<Cell> *route)
+{
+    route->clear();
+    if (!search(board->index(from), board->index(target), true)) {
+        return false;
+    }
+    for (const int idx: path) {
+        route->push_back(board->cellAt(idx));
+    }
+    return true;
+}
+
+bool PathFinder::repair(std::vector<Cell> *route, const int at,
+                        const Cell &target)
+{
+    assert(at >= 0 && at < static_cast<int>(route->size()));
+    route->erase(route->begin(), route->begin() + at);
+    const Cell from = route->front();
+    if (board->isObstacle(board->index(from))) {
+        route->clear();
+        return false;
+    }
+
+    for (size_t i = 1; i < route->size(); ++i) {
+        if (!board->isObstacle(board->index((*route)[i]))) {
+            continue;
+        }
+
+        // Walk around the obstructed stretch, from the cell before it to the
+        // first walkable cell after it.
+        size_t j = i + 1;
+        while (j < route->size() &&
+               board->isObstacle(board->index((*route)[j]))) {
+            ++j;
+        }
+        if (j == route->size() ||
+            !search(board->index((*route)[i - 1]),
+                    board->index((*route)[j]), false)) {
+            return findRoute(from, target, route);
+        }
+
+        std::vector<Cell> detour;
+        for (size_t k = 1; k + 1 < path.size(); ++k) {
+            detour.push_back(board->cellAt(path[k]));
+        }
+        route->erase(route->begin() + i, route->begin() + j);
+        route->insert(route->begin() + i, detour.begin(), detour.end());
+        i += detour.size();
+    }
+    return true;
+}
+
+uint64_t PathFinder::expanded() const
+{
+    return this->nExpanded;
+}
+
+bool PathFinder::search(const int from, const int goal, const bool adjacent)
+{
+    const int n = board->size();
+    if (static_cast<int>(visited.size()) != n) {
+        costs.assign(n, 0);
+        parents.assign(n, -1);
+        visited.assign(n, 0);
+        stamp = 0;
+    }
+
+    // Stamps save clearing the arrays on every search.
+    if (!++stamp) {
+        std::fill(visited.begin(), visited.end(), 0);
+        stamp = 1;
+    }
+
+    const Cell g = board->cellAt(goal);
+    auto estimate = [&](const int idx) {
+        const Cell cell = board->cellAt(idx);
+        const int dist = std::abs(cell.r - g.r) + std::abs(cell.c - g.c);
+        return adjacent ? std::max(dist - 1, 0) : dist;
+    };
+    auto isGoal = [&](const int idx) {
+        const Cell cell = board->cellAt(idx);
+        const int dist = std::abs(cell.r - g.r) + std::abs(cell.c - g.c);
+        return adjacent ? dist == 1 : !dist;
+    };
+
+    path.clear();
+    open.clear();
+    costs[from] = 0;
+    parents[from] = -1;
+    visited[from] = stamp;
+    open.emplace_back(estimate(from), 0, from);
+
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), std::greater<>());
+        const int idx = std::get<2>(open.back());
+        const int cost = -std::get<1>(open.back());
+        open.pop_back();
+        if (cost > costs[idx]) {
+            continue;
+        }
+        ++nExpanded;
+
+        if (isGoal(idx)) {
+            for (int i = idx; i >= 0; i = parents[i]) {
+                path.push_back(i);
+            }
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+
+        for (const Direction d: { Direction::kUp, Direction::kDown,
+                                  Direction::kLeft, Direction::kRight }) {
+            const int next = idx + board->offset(d);
+            if (board->isObstacle(next) ||
+                (visited[next] == stamp && costs[next] <= cost + 1)) {
+                continue;
+            }
+            visited[next] = stamp;
+            costs[next] = cost + 1;
+            parents[next] = idx;
+            open.emplace_back(cost + 1 + estimate(next), -(cost + 1), next);
+            std::push_heap(open.begin(), open.end(), std::greater<>());
+        }
+    }
+    return false;
+}
@@ -0,0 +1,63 @@
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include "board.h"
+
+// Shortest walks over the cells a player can walk on, by A* search with the
+// Manhattan distance as heuristic. Like in RegionIndex, blocks and the wall
+// ring cannot be walked on, items can.
+//
+// Eliminations only ever free cells, so they never break a route. Only moving
+// blocks around can put one on a route, in which case `repair` searches a
+// detour around the obstructed stretch, and falls back to a full search if
+// there is none.
+class PathFinder {
+public:
+    PathFinder(const Board *board = nullptr);
+
+    void setBoard(const Board *board);
+
+    // Fill <route> with a shortest walk from <from> to a cell next to
+    // <target>, <from> first. Returns false, leaving <route> empty, if the
+    // player cannot walk up to <target>.
+    bool findRoute(const Cell &from, const Cell &target,
+                   std::vector<Cell> *route);
+
+    // Make <route>, a walk up to <target> along which the player has reached
+    // position <at>, walkable again. The cells before <at> are dropped, so the
+    // route starts where the player stands. Returns false, leaving <route>
+    // empty, if the player cannot walk up to <target> anymore.
+    bool repair(std::vector<Cell> *route, const int at, const Cell &target);
+
+    // Cells expanded by all searches so far.
+    uint64_t expanded() const;
+
+private:
+    const Board *board;
+
+    // Cost from the start and predecessor of each flat index, valid if its
+    // entry in <visited> equals <stamp>.
+    std::vector<int> costs;
+    std::vector<int> parents;
+    std::vector<unsigned> visited;
+    unsigned stamp;
+
+    // Open cells as (estimated total cost, negated cost, flat index), a min
+    // heap. Deeper cells win ties, which heads straight for the goal.
+    std::vector<std::tuple<int, int, int>> open;
+
+    // Scratch path of flat indices.
+    std::vector<int> path;
+
+    uint64_t nExpanded;
+
+    // A* from <from> to <goal>, or to any cell next to <goal> if <adjacent>.
+    // On success, <path> holds the walk from <from> to the goal.
+    bool search(const int from, const int goal, const bool adjacent);
+};
+
+#endif // PATHFINDER_H
@@ -1,68 +1,28 @@
 #include "player.h"
 
-Player::Player(const WhichPlayer &which, const int x, const int y, const int s,
+Player::Player(const WhichPlayer &which, const int x, const int y,
                QWidget *parent):
-    QWidget(parent), kId(which), x(x), y(y), score(s),
-    color(Block::kHighlightColor[which]), chosenBlock(nullptr)
+    QWidget(parent), kId(which), x(x), y(y),
+    color(Block::kHighlightColor[which])
 {
     setFixedSize(SHAPE_SIZE, SHAPE_SIZE);
+    move(x - (SHAPE_SIZE >> 1), y - (SHAPE_SIZE >> 1));
 }
 
 void Player::paintEvent(QPaintEvent *)
 {
     // TODO: change to something nicer.
-    this->move(x - (SHAPE_SIZE >> 1), y - (SHAPE_SIZE >> 1));
     QPainter painter(this);
     painter.setBrush(this->color);
     painter.setPen(this->color);
     painter.drawRect(0, 0, SHAPE_SIZE, SHAPE_SIZE);
 }
 
-Player * Player::fromTextStream(QTextStream &s)
+void Player::moveTo(const int x, const int y)
 {
-    int id;
-    int x;
-    int y;
-    int score;
-
-    Player *p;
-    s >> id >> x >> y >> score;
-    p = new Player(static_cast<WhichPlayer>(id), x, y, score);
-    return p;
-}
-
-void Player::chooseBlock(Block *const b)
-{
-    // Check if the block is already chosen by another player.
-    if (b->isChosen() && b->chosenBy() != kId) {
-        return;
-    }
-
-    b->setChosenBy(this->kId);
-    if (chosenBlock == nullptr) {
-        chosenBlock = b;
-        chosenBlock->setChosenBy(this->kId);
-    } else if (b != chosenBlock) {
-        emit sendValidateBlock(kId, chosenBlock, b);
-        removeChosenBlock();
-    }
-}
-
-void Player::removeChosenBlock()
-{
-    chosenBlock = nullptr;
-}
-
-void Player::addScore(const int dscore)
-{
-    this->score += dscore;
-    emit sendScoreChanged(this->kId, this->score);
-}
-
-void Player::setScore(const int score)
-{
-    this->score = score;
-    emit sendScoreChanged(this->kId, this->score);
+    this->x = x;
+    this->y = y;
+    move(x - (SHAPE_SIZE >> 1), y - (SHAPE_SIZE >> 1));
 }
 
 QDebug operator<<(QDebug dbg, const Player &s)
@@ -70,10 +30,3 @@ QDebug operator<<(QDebug dbg, const Player &s)
     dbg.nospace() << "x: " << s.x << ", y: " << s.y;
     return dbg;
 }
-
-QTextStream & operator<<(QTextStream &ds, const Player &p)
-{
-    ds << p.kId << ' ' << p.x << ' ' << p.y << ' ' << p.score;
-    return ds;
-}
-
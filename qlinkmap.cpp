@@ -1,5 +1,21 @@
 #include "qlinkmap.h"
 
+QLinkOverlay::QLinkOverlay(QLinkMap *map): QWidget(map), map(map)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+}
+
+void QLinkOverlay::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    for (const auto &coloredLines: map->linesMap) {
+        QPen pen = QPen(coloredLines.color);
+        pen.setWidth(QLinkMap::kLineWidth);
+        painter.setPen(pen);
+        painter.drawLines(coloredLines.linesList);
+    }
+}
+
 QLinkMap::QLinkMap() {
 
 }
@@ -8,6 +24,15 @@ QUuid QLinkMap::addLines(const QList<QLine> &lines, const QColor &color)
 {
     QUuid uuid = QUuid::createUuid();
     this->linesMap.insert(uuid, QColoredLineList(color, lines));
+
+    // Blocks are added after the overlay, so raise it above them again.
+    if (!overlay) {
+        overlay = new QLinkOverlay(this);
+    }
+    overlay->setGeometry(rect());
+    overlay->raise();
+    overlay->show();
+    overlay->update();
     return uuid;
 }
 
@@ -15,15 +40,7 @@ void QLinkMap::removeLines(const QUuid &uuid)
 {
     assert(linesMap.contains(uuid));
     this->linesMap.remove(uuid);
-}
-
-void QLinkMap::paintEvent(QPaintEvent *)
-{
-    QPainter painter(this);
-    for (auto &coloredLines: linesMap) {
-        QPen pen = QPen(coloredLines.color);
-        pen.setWidth(5);
-        painter.setPen(pen);
-        painter.drawLines(coloredLines.linesList);
+    if (overlay) {
+        overlay->update();
     }
 }
@@ -14,23 +14,43 @@ struct QColoredLineList {
     }
 };
 
-// Extends QFrame to override paintEvent and draw connections between blocks.
+class QLinkMap;
+
+// Transparent widget on top of the blocks of a QLinkMap that paints its
+// connections, so that links are not hidden by the blocks they pass by.
+class QLinkOverlay : public QWidget {
+private:
+    const QLinkMap *map;
+
+public:
+    QLinkOverlay(QLinkMap *map);
+protected:
+    void paintEvent(QPaintEvent *event) override;
+};
+
+// Extends QFrame to draw connections between blocks.
 class QLinkMap : public QFrame {
+    friend class QLinkOverlay;
 private:
     // Each connection is represented with a list of QLine, associated with a
     // uuid. The uuid is used to remove a connection.
     QMap<QUuid, QColoredLineList> linesMap;
 
+    // Created on demand, as clearing the map deletes all of its children.
+    QPointer<QLinkOverlay> overlay;
+
 public:
+    // Width of the pen that connections are drawn with.
+    static const int kLineWidth = 5;
+
     QLinkMap();
 
-    // Add a connection.
+    // Add a connection. Links around the board are drawn in the margin that
+    // the owner of the map leaves around its blocks.
     QUuid addLines(const QList<QLine> &lines, const QColor &color);
 
     // Remove a connection.
     void removeLines(const QUuid &uuid);
-protected:
-    void paintEvent(QPaintEvent *event) override;
 };
 
 #endif // QLINKMAP_H
@@ -0,0 +1,186 @@
+#include "regionindex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <utility>
+
+RegionIndex::RegionIndex(const Board *board): board(board), nRegions(0)
+{
+
+}
+
+void RegionIndex::setBoard(const Board *board)
+{
+    this->board = board;
+}
+
+void RegionIndex::rebuild()
+{
+    assert(board);
+    const int n = board->size();
+    parents.assign(n, -1);
+    sizes.assign(n, 1);
+    nRegions = 0;
+
+    for (int idx = 0; idx < n; ++idx) {
+        if (!board->isObstacle(idx)) {
+            parents[idx] = idx;
+            ++nRegions;
+        }
+    }
+
+    // The wall ring guarantees that the right and lower neighbours of a cell
+    // inside the map exist.
+    const int right = board->offset(Direction::kRight);
+    const int down = board->offset(Direction::kDown);
+    for (int r = 0; r < board->rows(); ++r) {
+        for (int c = 0; c < board->cols(); ++c) {
+            const int idx = board->index(r, c);
+            if (parents[idx] < 0) {
+                continue;
+            }
+            if (parents[idx + right] >= 0) {
+                unite(idx, idx + right);
+            }
+            if (parents[idx + down] >= 0) {
+                unite(idx, idx + down);
+            }
+        }
+    }
+}
+
+void RegionIndex::removeBlock(const Cell &cell)
+{
+    const int idx = board->index(cell);
+    assert(!board->isObstacle(idx));
+    assert(parents[idx] < 0);
+
+    parents[idx] = idx;
+    sizes[idx] = 1;
+    ++nRegions;
+    for (const Direction d: { Direction::kUp, Direction::kDown,
+                              Direction::kLeft, Direction::kRight }) {
+        const int next = idx + board->offset(d);
+        if (parents[next] >= 0) {
+            unite(idx, next);
+        }
+    }
+}
+
+int RegionIndex::regionOf(const Cell &cell) const
+{
+    const int idx = board->index(cell);
+    return parents[idx] < 0 ? -1 : find(idx);
+}
+
+bool RegionIndex::touches(const Cell &cell, const int region) const
+{
+    if (region < 0) {
+        return false;
+    }
+    const int idx = board->index(cell);
+    for (const Direction d: { Direction::kUp, Direction::kDown,
+                              Direction::kLeft, Direction::kRight }) {
+        const int next = idx + board->offset(d);
+        if (parents[next] >= 0 && find(next) == region) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RegionIndex::canReach(const Cell &from, const Cell &cell) const
+{
+    return touches(cell, regionOf(from));
+}
+
+int RegionIndex::count() const
+{
+    return this->nRegions;
+}
+
+int RegionIndex::countAfterRemoving(const Cell &a, const Cell &b) const
+{
+    const int x = board->index(a);
+    const int y = board->index(b);
+    assert(parents[x] < 0 && parents[y] < 0);
+
+    // Distinct regions next to each cell. A freed cell joins all of them into
+    // one.
+    int roots[2][4];
+    int n[2] = { 0, 0 };
+    for (int i = 0; i < 2; ++i) {
+        const int idx = i ? y : x;
+        for (const Direction d: { Direction::kUp, Direction::kDown,
+                                  Direction::kLeft, Direction::kRight }) {
+            const int next = idx + board->offset(d);
+            if (parents[next] < 0) {
+                continue;
+            }
+            const int root = find(next);
+            if (std::find(roots[i], roots[i] + n[i], root) == roots[i] + n[i]) {
+                roots[i][n[i]++] = root;
+            }
+        }
+    }
+
+    // The two freed cells end up in the same region if they are neighbours or
+    // share a neighbouring region.
+    int shared = 0;
+    for (int i = 0; i < n[1]; ++i) {
+        shared += std::find(roots[0], roots[0] + n[0], roots[1][i]) !=
+                roots[0] + n[0];
+    }
+    const int dist = std::abs(x - y);
+    if (shared || dist == 1 || dist == board->stride()) {
+        return nRegions + 1 - (n[0] + n[1] - shared);
+    }
+    return nRegions + 2 - n[0] - n[1];
+}
+
+bool RegionIndex::isConsistent() const
+{
+    RegionIndex fresh(board);
+    fresh.rebuild();
+    if (fresh.count() != count()) {
+        return false;
+    }
+
+    // Same number of regions, so it suffices that cells in the same region
+    // here are also in the same region there.
+    for (int idx = 0; idx < board->size(); ++idx) {
+        if ((parents[idx] < 0) != (fresh.parents[idx] < 0)) {
+            return false;
+        }
+        if (parents[idx] >= 0 && fresh.find(find(idx)) != fresh.find(idx)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int RegionIndex::find(int idx) const
+{
+    // Path halving.
+    while (parents[idx] != idx) {
+        parents[idx] = parents[parents[idx]];
+        idx = parents[idx];
+    }
+    return idx;
+}
+
+void RegionIndex::unite(const int a, const int b)
+{
+    int ra = find(a);
+    int rb = find(b);
+    if (ra == rb) {
+        return;
+    }
+    if (sizes[ra] < sizes[rb]) {
+        std::swap(ra, rb);
+    }
+    parents[rb] = ra;
+    sizes[ra] += sizes[rb];
+    --nRegions;
+}
@@ -0,0 +1,67 @@
+#ifndef REGIONINDEX_H
+#define REGIONINDEX_H
+
+#include <vector>
+
+#include "board.h"
+
+// Partition of the cells that a player can walk on into connected regions.
+// Blocks and the wall ring cannot be walked on, items can.
+//
+// Eliminations only ever turn blocks into empty cells, so regions only ever
+// merge, which a union-find handles in near-constant time. Anything that can
+// split a region, such as a shuffle, has to be followed by a `rebuild`.
+class RegionIndex {
+public:
+    RegionIndex(const Board *board = nullptr);
+
+    // Sets the board that the index is built on. Must be followed by a
+    // `rebuild`, unless <board> is a copy of the board the index was built on.
+    void setBoard(const Board *board);
+
+    // Discard the index and build it from scratch.
+    void rebuild();
+
+    // Update the index after the block at <cell> has been removed from the
+    // board, merging the regions around it.
+    void removeBlock(const Cell &cell);
+
+    // Id of the region that contains <cell>, or -1 if <cell> cannot be walked
+    // on. Ids stay valid until the next change of the board.
+    int regionOf(const Cell &cell) const;
+
+    // Returns true if <cell> is next to a cell of region <region>, i.e. a
+    // player in that region can walk up to it.
+    bool touches(const Cell &cell, const int region) const;
+
+    // Returns true if a player standing at <from> can walk up to <cell>.
+    bool canReach(const Cell &from, const Cell &cell) const;
+
+    // Number of regions.
+    int count() const;
+
+    // Number of regions there would be after removing the blocks at <a> and
+    // <b>. Leaves the index untouched.
+    int countAfterRemoving(const Cell &a, const Cell &b) const;
+
+    // Returns true if the index describes the same regions that a rebuild
+    // would. Expensive, only meant for debugging and tests.
+    bool isConsistent() const;
+
+private:
+    const Board *board;
+
+    // Union-find forest over flat indices, -1 for cells that cannot be walked
+    // on. Paths are compressed on lookup, hence mutable.
+    mutable std::vector<int> parents;
+
+    // Number of cells in the tree below each root.
+    std::vector<int> sizes;
+
+    int nRegions;
+
+    int find(int idx) const;
+    void unite(const int a, const int b);
+};
+
+#endif // REGIONINDEX_H
@@ -0,0 +1,204 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <random>
+
+double SolverResult::nodesPerSecond() const
+{
+    return seconds > 0 ? nodes / seconds : 0;
+}
+
+Solver::Solver(const int tableBits): checker(&board), maxTurns(0),
+    blocksLeft(0), maxContent(0), hash(0),
+    table(static_cast<size_t>(1) << tableBits),
+    tableMask((static_cast<uint64_t>(1) << tableBits) - 1),
+    nodes(0), tableHits(0), outOfBudget(false)
+{
+
+}
+
+SolverResult Solver::solve(const Board &board, const int maxTurns,
+                           const SolverBudget &budget)
+{
+    const auto start = std::chrono::steady_clock::now();
+    this->board = board;
+    this->maxTurns = maxTurns;
+    this->budget = budget;
+    this->deadline = start + std::chrono::milliseconds(budget.maxMillis);
+    nodes = 0;
+    tableHits = 0;
+    outOfBudget = false;
+    line.clear();
+    std::fill(table.begin(), table.end(), 0);
+
+    // Fixed keys, so that runs on the same board are repeatable.
+    std::mt19937_64 rng(0);
+    keys.resize(board.size());
+    for (auto &key: keys) {
+        key = rng();
+    }
+
+    hash = 0;
+    blocksLeft = 0;
+    maxContent = 0;
+    for (BlockContent bc = 1; bc < board.contentLimit(); ++bc) {
+        for (const int idx: board.blocksOf(bc)) {
+            hash ^= keys[idx];
+            ++blocksLeft;
+            maxContent = bc;
+        }
+    }
+
+    SolverResult result;
+    if (search(0)) {
+        result.status = SolveStatus::kSolved;
+        for (const Move &m: line) {
+            result.moves.emplace_back(board.cellAt(m.first),
+                                      board.cellAt(m.second));
+        }
+    } else {
+        result.status = outOfBudget ? SolveStatus::kOutOfBudget :
+                                      SolveStatus::kUnsolvable;
+    }
+    result.nodes = nodes;
+    result.tableHits = tableHits;
+    result.seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+bool Solver::search(const int depth)
+{
+    if (!blocksLeft) {
+        return true;
+    }
+    if (!checkBudget()) {
+        return false;
+    }
+    ++nodes;
+
+    uint64_t &entry = table[hash & tableMask];
+    if (entry == hash) {
+        ++tableHits;
+        return false;
+    }
+
+    Move move;
+    if (findSafeMove(&move)) {
+        const BlockContent bc = board.content(board.cellAt(move.first).r,
+                                              board.cellAt(move.first).c);
+        play(move);
+        if (search(depth + 1)) {
+            return true;
+        }
+        undo(move, bc);
+    } else {
+        if (static_cast<int>(movesAt.size()) <= depth) {
+            movesAt.resize(depth + 1);
+            contentsAt.resize(depth + 1);
+        }
+        orderContents(contentsAt[depth]);
+
+        // Moves are generated one content at a time, so that a position whose
+        // first moves lead to a solution never pays for the rest. <movesAt>
+        // may grow during the recursion, so it is indexed every time.
+        for (size_t i = 0; i < contentsAt[depth].size(); ++i) {
+            const BlockContent bc = contentsAt[depth][i].second;
+            generate(bc, movesAt[depth]);
+            for (size_t j = 0; j < movesAt[depth].size(); ++j) {
+                const Move m = movesAt[depth][j];
+                play(m);
+                if (search(depth + 1)) {
+                    return true;
+                }
+                undo(m, bc);
+                if (outOfBudget) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    // Only a position that has been searched completely is known to be dead.
+    if (!outOfBudget) {
+        entry = hash;
+    }
+    return false;
+}
+
+void Solver::orderContents(std::vector<std::pair<int, BlockContent>> &order)
+{
+    order.clear();
+    for (BlockContent bc = 1; bc <= maxContent; ++bc) {
+        const int n = static_cast<int>(board.blocksOf(bc).size());
+        if (n) {
+            order.emplace_back(n, bc);
+        }
+    }
+    std::sort(order.begin(), order.end());
+}
+
+void Solver::generate(const BlockContent bc, std::vector<Move> &moves)
+{
+    moves.clear();
+    for (const int a: board.blocksOf(bc)) {
+        checker.connectAll(board.cellAt(a), maxTurns, &partners);
+        for (const Cell &cell: partners) {
+            const int b = board.index(cell);
+            if (b > a && board.content(cell.r, cell.c) == bc) {
+                moves.emplace_back(a, b);
+            }
+        }
+    }
+}
+
+bool Solver::findSafeMove(Move *move)
+{
+    for (BlockContent bc = 1; bc <= maxContent; ++bc) {
+        const std::vector<int> &blocks = board.blocksOf(bc);
+        if (blocks.size() == 2 &&
+            checker.connect(board.cellAt(blocks[0]), board.cellAt(blocks[1]),
+                            maxTurns, nullptr)) {
+            *move = { blocks[0], blocks[1] };
+            return true;
+        }
+    }
+    return false;
+}
+
+void Solver::play(const Move &move)
+{
+    for (const int idx: { move.first, move.second }) {
+        const Cell cell = board.cellAt(idx);
+        board.clearCell(cell.r, cell.c);
+        hash ^= keys[idx];
+    }
+    blocksLeft -= 2;
+    line.push_back(move);
+}
+
+void Solver::undo(const Move &move, const BlockContent bc)
+{
+    for (const int idx: { move.first, move.second }) {
+        const Cell cell = board.cellAt(idx);
+        board.setCell(cell.r, cell.c, BlockType::kBlock, bc);
+        hash ^= keys[idx];
+    }
+    blocksLeft += 2;
+    line.pop_back();
+}
+
+bool Solver::checkBudget()
+{
+    if (outOfBudget) {
+        return false;
+    }
+    if (budget.maxNodes && nodes >= budget.maxNodes) {
+        outOfBudget = true;
+    }
+
+    if (budget.maxMillis && std::chrono::steady_clock::now() >= deadline) {
+        outOfBudget = true;
+    }
+    return !outOfBudget;
+}
@@ -0,0 +1,118 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "linkchecker.h"
+
+// Limits of a solver run. 0 means no limit.
+struct SolverBudget {
+    uint64_t maxNodes = 0;
+    int maxMillis = 0;
+};
+
+struct SolverResult {
+    SolveStatus status = SolveStatus::kOutOfBudget;
+
+    // If solved, pairs of blocks whose elimination in this order clears the
+    // board.
+    std::vector<std::pair<Cell, Cell>> moves;
+
+    // Positions expanded, and positions cut off because the transposition
+    // table knew them to be dead ends.
+    uint64_t nodes = 0;
+    uint64_t tableHits = 0;
+
+    double seconds = 0;
+
+    double nodesPerSecond() const;
+};
+
+// Decides whether a board can be cleared completely, by depth first search
+// over elimination orders. Only the link rules are taken into account: items
+// do not obstruct links, and players are assumed to reach every block.
+//
+// Positions are identified by a Zobrist hash, the XOR of one random key per
+// remaining block. Eliminations only ever remove blocks, so a position is
+// determined by its set of remaining blocks, and positions proven to be dead
+// ends are kept in a direct-mapped transposition table.
+//
+// Moves are generated lazily, content by content, contents with the fewest
+// blocks left first. When the last two blocks of a content can be linked,
+// removing them is always safe: it only frees cells, and those blocks cannot
+// pair with anything else. Such a move is played without trying any
+// alternative.
+class Solver {
+public:
+    // Use a transposition table of 2 ^ <tableBits> entries.
+    Solver(const int tableBits = 20);
+
+    // Search for a way to clear <board> with links of at most <maxTurns>
+    // turns, within <budget>.
+    SolverResult solve(const Board &board, const int maxTurns,
+                       const SolverBudget &budget = SolverBudget());
+
+private:
+    // A pair of blocks by flat index.
+    typedef std::pair<int, int> Move;
+
+    // Copy of the board being searched, changed by every move and restored
+    // on the way back.
+    Board board;
+    LinkChecker checker;
+    int maxTurns;
+
+    int blocksLeft;
+    BlockContent maxContent;
+
+    // Zobrist key of each flat index, and the hash of the current position.
+    std::vector<uint64_t> keys;
+    uint64_t hash;
+
+    // Hashes of dead positions, indexed by their low bits. 0 marks an empty
+    // entry.
+    std::vector<uint64_t> table;
+    uint64_t tableMask;
+
+    // Contents in the order they are tried and moves of the content being
+    // tried, at each depth of the search.
+    std::vector<std::vector<std::pair<int, BlockContent>>> contentsAt;
+    std::vector<std::vector<Move>> movesAt;
+
+    // The moves that led to the current position.
+    std::vector<Move> line;
+
+    // Candidate partners of a block.
+    std::vector<Cell> partners;
+
+    SolverBudget budget;
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t nodes;
+    uint64_t tableHits;
+    bool outOfBudget;
+
+    // Returns true if the current position can be cleared. On success, <line>
+    // holds the moves to get there.
+    bool search(const int depth);
+
+    // Fill <order> with the contents that have blocks left, as pairs of the
+    // number of blocks and the content, fewest blocks first.
+    void orderContents(std::vector<std::pair<int, BlockContent>> &order);
+
+    // Fill <moves> with every legal move between blocks of content <bc>.
+    void generate(const BlockContent bc, std::vector<Move> &moves);
+
+    // Returns true if the last two blocks of some content can be linked, and
+    // stores them in <move>.
+    bool findSafeMove(Move *move);
+
+    void play(const Move &move);
+    void undo(const Move &move, const BlockContent bc);
+
+    bool checkBudget();
+};
+
+#endif // SOLVER_H
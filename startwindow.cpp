@@ -1,8 +1,10 @@
 #include "startwindow.h"
+#include "linkchecker.h"
 #include "utils.h"
 
 StartWindow::StartWindow(const unique_ptr<UiConfig> &config, QWidget *parent):
-QWidget(parent), config(config)
+QWidget(parent), config(config), turnsBox(nullptr), borderBox(nullptr),
+    difficultyBox(nullptr), seedEdit(nullptr)
 {
     // Set fixed window size.
     setFixedSize(config->windowWidth(), config->windowHeight());
@@ -59,20 +61,90 @@ void StartWindow::initLayout()
     btnLayout->addWidget(loadBtn);
     btnLayout->addWidget(quitBtn);
 
+    // Turn limit of new games, fewer turns make an easier game.
+    QHBoxLayout *turnsLayout = new QHBoxLayout();
+    QLabel *turnsLbl = new QLabel("Max turns per link:");
+    turnsBox = new QSpinBox();
+    turnsBox->setRange(0, LinkChecker::kMaxTurnLimit);
+    turnsBox->setValue(kDefaultMaxTurns);
+    turnsLayout->addStretch();
+    turnsLayout->addWidget(turnsLbl);
+    turnsLayout->addWidget(turnsBox);
+    turnsLayout->addStretch();
+
+    // Routing mode of new games, links around the map make an easier game.
+    QHBoxLayout *borderLayout = new QHBoxLayout();
+    borderBox = new QCheckBox("Links may run around the map");
+    borderLayout->addStretch();
+    borderLayout->addWidget(borderBox);
+    borderLayout->addStretch();
+
+    // Difficulty of new games, from the number of pairs on offer.
+    QHBoxLayout *difficultyLayout = new QHBoxLayout();
+    QLabel *difficultyLbl = new QLabel("Difficulty:");
+    difficultyBox = new QComboBox();
+    difficultyBox->addItem("Easy");
+    difficultyBox->addItem("Normal");
+    difficultyBox->addItem("Hard");
+    difficultyBox->addItem("Adaptive");
+    difficultyBox->setCurrentIndex(kNormal);
+    difficultyLayout->addStretch();
+    difficultyLayout->addWidget(difficultyLbl);
+    difficultyLayout->addWidget(difficultyBox);
+    difficultyLayout->addStretch();
+
+    // Seed of new games, to replay a game.
+    QHBoxLayout *seedLayout = new QHBoxLayout();
+    QLabel *seedLbl = new QLabel("Seed (empty for random):");
+    seedEdit = new QLineEdit();
+    seedLayout->addStretch();
+    seedLayout->addWidget(seedLbl);
+    seedLayout->addWidget(seedEdit);
+    seedLayout->addStretch();
+
+    // Have the maps of the selected settings made ready while the user
+    // looks on.
+    connect(turnsBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &StartWindow::onSettingsChanged);
+    connect(borderBox, &QCheckBox::toggled,
+            this, &StartWindow::onSettingsChanged);
+    connect(difficultyBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &StartWindow::onSettingsChanged);
+
     // Set layout relations.
+    outmostLayout->addLayout(turnsLayout);
+    outmostLayout->addLayout(borderLayout);
+    outmostLayout->addLayout(difficultyLayout);
+    outmostLayout->addLayout(seedLayout);
     outmostLayout->addLayout(btnLayout);
 
     this->setLayout(outmostLayout);
 }
 
+void StartWindow::startGame(const GameMode mode)
+{
+    // Text that is not a hexadecimal number counts as empty.
+    bool seeded = false;
+    const quint64 seed = seedEdit->text().trimmed().toULongLong(&seeded, 16);
+    emit sendStartGame(this, mode, turnsBox->value(), borderBox->isChecked(),
+                       seeded, seed, selectedTier(),
+                       difficultyBox->currentIndex() == kAdaptive);
+}
+
+Difficulty StartWindow::selectedTier() const
+{
+    const int tier = difficultyBox->currentIndex();
+    return tier == kAdaptive ? kNormal : static_cast<Difficulty>(tier);
+}
+
 void StartWindow::onClickSinglePlayer()
 {
-    emit sendStartGame(this, GameMode::kSingle);
+    startGame(GameMode::kSingle);
 }
 
 void StartWindow::onClickMultiPlayer()
 {
-    emit sendStartGame(this, GameMode::kDouble);
+    startGame(GameMode::kDouble);
 }
 
 void StartWindow::onClickLoad()
@@ -84,3 +156,10 @@ void StartWindow::onClickQuit()
 {
     QApplication::exit();
 }
+
+void StartWindow::onSettingsChanged()
+{
+    emit sendSettingsChanged(turnsBox->value(), borderBox->isChecked(),
+                             selectedTier(),
+                             difficultyBox->currentIndex() == kAdaptive);
+}
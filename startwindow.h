@@ -9,8 +9,35 @@ class StartWindow : public QWidget
 {
     Q_OBJECT
 private:
+    // Turn limit selected when the window first shows up, that of the classic
+    // rules.
+    static const int kDefaultMaxTurns = 2;
+
+    // Entry of <difficultyBox> that adapts the difficulty, after the tiers.
+    static const int kAdaptive = kHard + 1;
+
     const unique_ptr<UiConfig> &config;
 
+    // Selects the maximum number of turns of a link in new games.
+    QSpinBox *turnsBox;
+
+    // Selects whether links of new games may run around the map.
+    QCheckBox *borderBox;
+
+    // Selects the difficulty of new games: a fixed tier, or kAdaptive to
+    // follow the results of previous games.
+    QComboBox *difficultyBox;
+
+    // Seed of new games in hexadecimal, as shown during a game. Empty for a
+    // random seed.
+    QLineEdit *seedEdit;
+
+    // Emit `sendStartGame` for a game of <mode> with the selected settings.
+    void startGame(const GameMode mode);
+
+    // Difficulty selected in <difficultyBox>, kNormal if it is kAdaptive.
+    Difficulty selectedTier() const;
+
 public:
     StartWindow(const unique_ptr<UiConfig> &config, QWidget *parent = nullptr);
     void initLayout();
@@ -21,8 +48,23 @@ private slots:
     void onClickLoad();
     void onClickQuit();
 
+    // Emit `sendSettingsChanged` with the selected settings.
+    void onSettingsChanged();
+
 signals:
-    void sendStartGame(QWidget *const sender, const GameMode mode);
+    // <seeded> tells whether the game is to be played with <seed>, or with
+    // a random one. <adaptive> tells whether <difficulty> is left to follow
+    // the results of previous games.
+    void sendStartGame(QWidget *const sender, const GameMode mode,
+                       const int maxTurns, const bool borderRouting,
+                       const bool seeded, const quint64 seed,
+                       const Difficulty difficulty, const bool adaptive);
     void sendLoadGame(QWidget *const sender);
+
+    // The settings of new games were changed to these, as sent by
+    // `sendStartGame`, so that their maps can be made ready.
+    void sendSettingsChanged(const int maxTurns, const bool borderRouting,
+                             const Difficulty difficulty,
+                             const bool adaptive);
 };
 #endif // STARTWINDOW_H
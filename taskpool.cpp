@@ -0,0 +1,147 @@
+#include "taskpool.h"
+
+#include <algorithm>
+#include <cassert>
+
+TaskPool::TaskPool(const int workers): current(nullptr), generation(0),
+    busy(0), stopping(false)
+{
+    int n = workers;
+    if (n <= 0) {
+        n = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    for (int i = 0; i < n; ++i) {
+        ranges.emplace_back(new Range());
+    }
+    for (int i = 1; i < n; ++i) {
+        threads.emplace_back(&TaskPool::loop, this, i);
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &t: threads) {
+        t.join();
+    }
+}
+
+int TaskPool::workerCount() const
+{
+    return static_cast<int>(ranges.size());
+}
+
+void TaskPool::run(const int n, const Task &task)
+{
+    assert(current == nullptr);
+    if (n <= 0) {
+        return;
+    }
+
+    const int workers = workerCount();
+    for (int i = 0; i < workers; ++i) {
+        std::lock_guard<std::mutex> guard(ranges[i]->lock);
+        ranges[i]->begin = static_cast<int>(
+                    static_cast<long long>(n) * i / workers);
+        ranges[i]->end = static_cast<int>(
+                    static_cast<long long>(n) * (i + 1) / workers);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        current = &task;
+        busy = workers - 1;
+        ++generation;
+    }
+    wake.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> guard(lock);
+    done.wait(guard, [this]() { return !busy; });
+    current = nullptr;
+}
+
+void TaskPool::loop(const int worker)
+{
+    unsigned seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this, seen]() {
+                return stopping || generation != seen;
+            });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        work(worker);
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (!--busy) {
+            done.notify_one();
+        }
+    }
+}
+
+void TaskPool::work(const int worker)
+{
+    for (int task = next(worker); task >= 0; task = next(worker)) {
+        (*current)(task, worker);
+    }
+}
+
+int TaskPool::next(const int worker)
+{
+    Range &own = *ranges[worker];
+    while (true) {
+        {
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (own.begin < own.end) {
+                return own.begin++;
+            }
+        }
+
+        // Steal the back half of the largest range.
+        int victim = -1;
+        int most = 0;
+        for (int i = 0; i < workerCount(); ++i) {
+            std::lock_guard<std::mutex> guard(ranges[i]->lock);
+            const int left = ranges[i]->end - ranges[i]->begin;
+            if (i != worker && left > most) {
+                victim = i;
+                most = left;
+            }
+        }
+        if (victim < 0) {
+            return -1;
+        }
+
+        // Only one range is locked at a time, so that two workers stealing
+        // from each other cannot deadlock. Nobody steals from <own> while it
+        // is empty.
+        int begin;
+        int end;
+        {
+            Range &other = *ranges[victim];
+            std::lock_guard<std::mutex> guard(other.lock);
+            const int left = other.end - other.begin;
+            if (left <= 0) {
+                // Drained in the meantime, look again.
+                continue;
+            }
+            begin = other.end - (left + 1) / 2;
+            end = other.end;
+            other.end = begin;
+        }
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.begin = begin;
+        own.end = end;
+    }
+}
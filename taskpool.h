@@ -0,0 +1,73 @@
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads that runs batches of numbered tasks with work
+// stealing. Tasks 0 to n - 1 of a batch are split into one contiguous range
+// per worker. A worker takes tasks from the front of its own range, in
+// increasing order, and once it runs dry steals the back half of the largest
+// range left. Low numbers are therefore run early, which lets callers put
+// the most promising tasks first and skip the rest once they are done.
+//
+// The thread that calls `run` takes part as worker 0, so a pool with a single
+// worker runs everything inline.
+class TaskPool {
+public:
+    // Function that runs task <task> on worker <worker>.
+    typedef std::function<void(const int task, const int worker)> Task;
+
+    // Start a pool of <workers> workers, or one per hardware thread if
+    // <workers> is 0.
+    TaskPool(const int workers = 0);
+    ~TaskPool();
+
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+
+    int workerCount() const;
+
+    // Run tasks 0 to <n> - 1 and return once all of them have finished. Calls
+    // on different workers may run concurrently, calls on the same worker
+    // never do. Not reentrant.
+    void run(const int n, const Task &task);
+
+private:
+    // Remaining tasks [begin, end) of one worker.
+    struct Range {
+        std::mutex lock;
+        int begin = 0;
+        int end = 0;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Range>> ranges;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // The batch being run, counted by <generation> so that a worker runs each
+    // batch once.
+    const Task *current;
+    unsigned generation;
+
+    // Background workers that have not finished the current batch.
+    int busy;
+
+    bool stopping;
+
+    void loop(const int worker);
+    void work(const int worker);
+
+    // Take the next task of <worker>, stealing if needed. Returns -1 when the
+    // batch has run out of tasks.
+    int next(const int worker);
+};
+
+#endif // TASKPOOL_H
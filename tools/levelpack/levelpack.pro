@@ -0,0 +1,10 @@
+# Packs curated boards into a level pack, proving each one clearable.
+
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= app_bundle qt
+
+include(../../core.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,200 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "beamsolver.h"
+#include "levelpack.h"
+#include "solver.h"
+
+namespace {
+
+void printUsage()
+{
+    std::fprintf(stderr,
+                 "usage: levelpack [options] pack.qlp board.txt...\n"
+                 "       levelpack --list pack.qlp\n"
+                 "\n"
+                 "Packs boards into a level pack, leaving out those that\n"
+                 "cannot be proven clearable. A board is read in the form of\n"
+                 "Board::toAscii, after lines of settings:\n"
+                 "\n"
+                 "  # turns N       turns a link may take (--turns)\n"
+                 "  # border        let links run around the board\n"
+                 "  # spawn R C     a player starts at row R, column C\n"
+                 "\n"
+                 "  --turns N       default turn limit (2)\n"
+                 "  --millis N      time to prove a board clearable (10000)\n"
+                 "  --table-bits N  2^N transposition table entries (22)\n"
+                 "  --list          print the levels of a pack\n");
+}
+
+// Read the board file at <path> into <level>. Returns an error message, empty
+// on success.
+std::string readLevel(const char *path, const int defaultTurns,
+                      PackedLevel *level)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return "cannot open";
+    }
+    level->maxTurns = defaultTurns;
+    level->spawns.clear();
+    bool border = false;
+    std::string rows;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] != '#') {
+            rows += line + '\n';
+            continue;
+        }
+        std::istringstream setting(line.substr(1));
+        std::string key;
+        setting >> key;
+        Cell spawn;
+        if (key == "turns" && setting >> level->maxTurns) {
+            continue;
+        } else if (key == "border") {
+            border = true;
+        } else if (key == "spawn" && setting >> spawn.r >> spawn.c) {
+            level->spawns.push_back(spawn);
+        } else {
+            return "bad setting: " + line;
+        }
+    }
+
+    level->board.setBorderRouting(border);
+    if (!level->board.fromAscii(rows)) {
+        return "malformed board";
+    }
+    if (level->maxTurns < 0 || level->maxTurns > LinkChecker::kMaxTurnLimit) {
+        return "bad turn limit";
+    }
+    if (level->spawns.empty()) {
+        return "no spawn point";
+    }
+    for (const Cell &spawn: level->spawns) {
+        if (spawn.r < 0 || spawn.r >= level->board.rows() ||
+            spawn.c < 0 || spawn.c >= level->board.cols() ||
+            level->board.type(spawn.r, spawn.c) != BlockType::kEmpty) {
+            return "spawn point not on an empty cell";
+        }
+    }
+    return std::string();
+}
+
+// Returns an error message if <level> cannot be proven clearable within
+// <millis> milliseconds. The exact solver runs first, and the beam solver
+// gets the rest of the time on boards too large for it: a clearing it finds
+// is as good a proof.
+std::string prove(const PackedLevel &level, const int millis,
+                  const int tableBits)
+{
+    Solver solver(tableBits);
+    SolverBudget budget;
+    budget.maxMillis = millis / 2;
+    const SolverResult exact = solver.solve(level.board, level.maxTurns,
+                                            budget);
+    if (exact.status == SolveStatus::kSolved) {
+        return std::string();
+    }
+    if (exact.status == SolveStatus::kUnsolvable) {
+        return "cannot be cleared";
+    }
+
+    BeamSolver beam;
+    BeamOptions options;
+    options.maxMillis = millis - budget.maxMillis;
+    if (beam.solve(level.board, level.maxTurns, options).cleared) {
+        return std::string();
+    }
+    return "not proven clearable in time";
+}
+
+int list(const char *path)
+{
+    LevelPack pack;
+    if (!pack.open(path)) {
+        std::fprintf(stderr, "levelpack: cannot open %s as a pack\n", path);
+        return 2;
+    }
+    std::printf("levels: %d\n", pack.count());
+    PackedLevel level;
+    for (int i = 0; i < pack.count(); ++i) {
+        if (!pack.load(i, &level)) {
+            std::printf("%d: malformed\n", i);
+            continue;
+        }
+        std::printf("%d: %d x %d, %d turns%s, %d spawn points\n", i,
+                    level.board.rows(), level.board.cols(), level.maxTurns,
+                    level.board.borderRouting() ? ", border routing" : "",
+                    static_cast<int>(level.spawns.size()));
+    }
+    return 0;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    int maxTurns = 2;
+    int millis = 10000;
+    int tableBits = 22;
+    std::vector<const char *> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--list") && hasValue && argc == 3) {
+            return list(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--turns") && hasValue) {
+            maxTurns = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--millis") && hasValue) {
+            millis = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--table-bits") && hasValue) {
+            tableBits = std::atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            paths.push_back(argv[i]);
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (paths.size() < 2) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<PackedLevel> levels;
+    int rejected = 0;
+    for (size_t i = 1; i < paths.size(); ++i) {
+        PackedLevel level;
+        std::string error = readLevel(paths[i], maxTurns, &level);
+        if (error.empty()) {
+            error = prove(level, millis, tableBits);
+        }
+        if (!error.empty()) {
+            std::fprintf(stderr, "levelpack: %s: %s\n", paths[i],
+                         error.c_str());
+            ++rejected;
+            continue;
+        }
+        levels.push_back(level);
+    }
+
+    const std::string bytes = LevelPack::pack(levels);
+    if (bytes.empty()) {
+        std::fprintf(stderr, "levelpack: boards do not fit the format\n");
+        return 2;
+    }
+    std::ofstream out(paths[0], std::ios::binary);
+    if (!out.write(bytes.data(), bytes.size())) {
+        std::fprintf(stderr, "levelpack: cannot write %s\n", paths[0]);
+        return 2;
+    }
+    std::printf("packed %d levels, rejected %d\n",
+                static_cast<int>(levels.size()), rejected);
+    return rejected ? 1 : 0;
+}
@@ -0,0 +1,442 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "boardgenerator.h"
+#include "boardshuffler.h"
+#include "difficultysearch.h"
+#include "gameengine.h"
+#include "gamerandom.h"
+#include "pairindex.h"
+#include "regionindex.h"
+#include "taskpool.h"
+
+namespace {
+
+// Defaults of the game, as set by GameEngine.
+const int kDefaultRows = GameEngine::kMaxRows;
+const int kDefaultCols = GameEngine::kMaxCols;
+const int kDefaultTypes = GameEngine::kTypeNum;
+const int kDefaultBlocks = GameEngine::kBlockNum;
+const int kDefaultMaxTurns = GameEngine::kDefaultMaxTurns;
+const int kDefaultItemProbability = GameEngine::kSpawnItemProbability;
+const int kInitialTime = GameEngine::kInitialTime;
+const int kExtendSeconds = GameEngine::kExtendSeconds;
+
+// Time budget of a difficulty search, that of a whole map in MapPool.
+const int kSearchMillis = 500;
+
+// Tier searched for, or none to generate with the given number of types.
+const int kNoDifficulty = -1;
+
+void printUsage()
+{
+    std::fprintf(stderr,
+                 "usage: montecarlo [options]\n"
+                 "\n"
+                 "Plays generated boards at random and greedily, and prints\n"
+                 "how the games end as CSV, one line per parameter set and\n"
+                 "policy. Options taking a LIST take numbers separated by\n"
+                 "commas, and every combination of them is played.\n"
+                 "\n"
+                 "  --rows LIST         rows of the map (15)\n"
+                 "  --cols LIST         columns of the map (30)\n"
+                 "  --types LIST        contents the blocks are split into (5)\n"
+                 "  --blocks LIST       blocks on the map (200)\n"
+                 "  --turns LIST        turns a link may take (2)\n"
+                 "  --items LIST        chance of an item per second, rolled\n"
+                 "                      like the game: N + 1 in 101 (40)\n"
+                 "  --difficulty LIST   search maps for tiers easy, normal or\n"
+                 "                      hard, overriding --types\n"
+                 "  --border            let links run around the map\n"
+                 "  --games N           games per parameter set and policy\n"
+                 "                      (1000)\n"
+                 "  --move-seconds X    seconds a move takes the player (1)\n"
+                 "  --seed N            seed of the first game (0)\n"
+                 "  --threads N         worker threads, 0 for one per\n"
+                 "                      hardware thread (0)\n");
+}
+
+bool parseList(const char *text, std::vector<int> *values)
+{
+    values->clear();
+    const char *p = text;
+    while (*p) {
+        char *end;
+        const long value = std::strtol(p, &end, 10);
+        if (end == p || (*end && *end != ',')) {
+            return false;
+        }
+        values->push_back(static_cast<int>(value));
+        p = *end ? end + 1 : end;
+    }
+    return !values->empty();
+}
+
+bool parseDifficulties(const char *text, std::vector<int> *values)
+{
+    values->clear();
+    std::string rest = text;
+    while (!rest.empty()) {
+        const size_t comma = rest.find(',');
+        const std::string name = rest.substr(0, comma);
+        if (name == "easy") {
+            values->push_back(kEasy);
+        } else if (name == "normal") {
+            values->push_back(kNormal);
+        } else if (name == "hard") {
+            values->push_back(kHard);
+        } else {
+            return false;
+        }
+        rest = comma == std::string::npos ? "" : rest.substr(comma + 1);
+    }
+    return !values->empty();
+}
+
+const char *difficultyName(const int difficulty)
+{
+    switch (difficulty) {
+    case kEasy:
+        return "easy";
+    case kNormal:
+        return "normal";
+    case kHard:
+        return "hard";
+    default:
+        return "none";
+    }
+}
+
+typedef enum {
+    kRandomPolicy, kGreedyPolicy
+} Policy;
+
+const char *policyName(const Policy policy)
+{
+    return policy == kRandomPolicy ? "random" : "greedy";
+}
+
+struct ParameterSet {
+    GeneratorOptions options;
+    int types = kDefaultTypes;
+    int itemProbability = kDefaultItemProbability;
+    int difficulty = kNoDifficulty;
+    bool borderRouting = false;
+};
+
+typedef enum {
+    kCleared, kStuck, kTimesUp, kNoMap
+} Outcome;
+
+struct GameResult {
+    Outcome outcome = kNoMap;
+    int moves = 0;
+    int shuffles = 0;
+};
+
+// Plays games on one worker, with the game's own generator, link checks and
+// shuffler. The player's region grows from the spawn point as pairs are
+// taken away, and the player can link any pair next to it.
+//
+// The clock runs as in the game: every second takes one off it and spawns an
+// item with the given chance. Items are taken to be picked up right away: an
+// extension adds 30 seconds and a shuffle shuffles the board. Hints do not
+// change how the policies play.
+class Simulator {
+public:
+    Simulator(): search(1), pairs(&board), regions(&board)
+    {
+
+    }
+
+    GameResult play(const ParameterSet &set, const Policy policy,
+                    const double moveSeconds, const uint64_t seed)
+    {
+        GameResult result;
+        GameRandom random(seed);
+        if (!generate(set, &random)) {
+            return result;
+        }
+        pairs.rebuild(set.options.maxTurns);
+        regions.rebuild();
+        int blocks = set.options.blocks;
+
+        int timeRemaining = kInitialTime;
+        double clock = 0;
+        while (true) {
+            if (!blocks) {
+                result.outcome = kCleared;
+                return result;
+            }
+            if (!collectLive()) {
+                result.outcome = kStuck;
+                return result;
+            }
+
+            const std::pair<Cell, Cell> move =
+                    policy == kRandomPolicy ? live[random.uniform(
+                        kPlayerStream, 0, static_cast<int>(live.size()))] :
+                    greedyMove(&random);
+            board.clearCell(move.first.r, move.first.c);
+            board.clearCell(move.second.r, move.second.c);
+            pairs.removeBlock(move.first);
+            pairs.removeBlock(move.second);
+            regions.removeBlock(move.first);
+            regions.removeBlock(move.second);
+            blocks -= 2;
+            ++result.moves;
+
+            for (clock += moveSeconds; clock >= 1; clock -= 1) {
+                if (!--timeRemaining) {
+                    result.outcome = blocks ? kTimesUp : kCleared;
+                    return result;
+                }
+                // The roll of `GameEngine::tick`, which is not quite a
+                // percentage: <itemProbability> + 1 in 101.
+                if (random.uniform(kItemStream, 0, 101) <=
+                        set.itemProbability) {
+                    const int item = random.uniform(kItemStream, 0, 3);
+                    if (item == kExtend30s) {
+                        timeRemaining += kExtendSeconds;
+                    } else if (item == kShuffle && blocks) {
+                        shuffler.shuffle(&board, { spawn }, { spawn },
+                                         set.options.maxTurns,
+                                         random.stream(kShuffleStream)());
+                        pairs.rebuild(set.options.maxTurns);
+                        regions.rebuild();
+                        ++result.shuffles;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    BoardGenerator generator;
+    DifficultySearch search;
+    BoardShuffler shuffler;
+
+    Board board;
+    PairIndex pairs;
+    RegionIndex regions;
+    Cell spawn;
+
+    // Pairs the player can walk up to, and the best of them so far.
+    std::vector<std::pair<Cell, Cell>> live;
+    std::vector<std::pair<Cell, Cell>> best;
+
+    bool generate(const ParameterSet &set, GameRandom *random)
+    {
+        board.setBorderRouting(set.borderRouting);
+        GeneratorResult generated;
+        if (set.difficulty == kNoDifficulty) {
+            GeneratorOptions options = set.options;
+            options.blocksPerType = set.options.blocks / set.types;
+            generated = generator.generate(
+                        &board, random->stream(kMapStream)(), options);
+        } else {
+            const Difficulty tier = static_cast<Difficulty>(set.difficulty);
+            generated = search.search(
+                        &board, set.options,
+                        DifficultyTarget::forTier(tier, set.options.maxTurns,
+                                                  set.borderRouting,
+                                                  set.options.blocks),
+                        &random->stream(kMapStream), kSearchMillis).generated;
+        }
+        if (!generated.complete) {
+            return false;
+        }
+        spawn = generated.spawns.front();
+        return true;
+    }
+
+    int collectLive()
+    {
+        live.clear();
+        for (int i = 0; i < pairs.count(); ++i) {
+            const std::pair<Cell, Cell> pair = pairs.pairAt(i);
+            if (regions.canReach(spawn, pair.first) &&
+                regions.canReach(spawn, pair.second)) {
+                live.push_back(pair);
+            }
+        }
+        return static_cast<int>(live.size());
+    }
+
+    // The move that breaks up the fewest other pairs, ties broken at
+    // random, the way BeamSolver ranks moves before scoring them.
+    std::pair<Cell, Cell> greedyMove(GameRandom *random)
+    {
+        int fewest = -1;
+        best.clear();
+        for (const auto &move: live) {
+            const int broken = pairs.partnerCount(move.first) +
+                    pairs.partnerCount(move.second) - 2;
+            if (fewest < 0 || broken < fewest) {
+                fewest = broken;
+                best.clear();
+            }
+            if (broken == fewest) {
+                best.push_back(move);
+            }
+        }
+        return best[random->uniform(kPlayerStream, 0,
+                                    static_cast<int>(best.size()))];
+    }
+};
+
+bool validSet(const ParameterSet &set)
+{
+    const GeneratorOptions &o = set.options;
+    return o.rows > 0 && o.cols > 0 && o.blocks > 0 && o.blocks % 2 == 0 &&
+            o.blocks < o.rows * o.cols && set.types > 0 &&
+            o.blocks % set.types == 0 && (o.blocks / set.types) % 2 == 0 &&
+            o.maxTurns >= 0 && o.maxTurns <= LinkChecker::kMaxTurnLimit &&
+            set.itemProbability >= 0 && set.itemProbability <= 100;
+}
+
+void printRow(const ParameterSet &set, const Policy policy,
+              const std::vector<GameResult> &results)
+{
+    int counts[4] = { 0 };
+    long long stuckMoves = 0;
+    long long shuffles = 0;
+    for (const GameResult &result: results) {
+        ++counts[result.outcome];
+        if (result.outcome == kStuck) {
+            stuckMoves += result.moves;
+        }
+        shuffles += result.shuffles;
+    }
+    const int played = static_cast<int>(results.size()) - counts[kNoMap];
+    const double games = played ? played : 1;
+    std::printf("%d,%d,%d,%d,%d,%d,%d,%s,%s,%d,%.4f,%.4f,%.4f,",
+                set.options.rows, set.options.cols, set.types,
+                set.options.blocks, set.options.maxTurns, set.borderRouting,
+                set.itemProbability, difficultyName(set.difficulty),
+                policyName(policy), played, counts[kCleared] / games,
+                counts[kStuck] / games, counts[kTimesUp] / games);
+    if (counts[kStuck]) {
+        std::printf("%.2f", double(stuckMoves) / counts[kStuck]);
+    }
+    std::printf(",%.3f,%d\n", shuffles / games, counts[kNoMap]);
+    std::fflush(stdout);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<int> rows = { kDefaultRows };
+    std::vector<int> cols = { kDefaultCols };
+    std::vector<int> types = { kDefaultTypes };
+    std::vector<int> blocks = { kDefaultBlocks };
+    std::vector<int> turns = { kDefaultMaxTurns };
+    std::vector<int> items = { kDefaultItemProbability };
+    std::vector<int> difficulties = { kNoDifficulty };
+    bool borderRouting = false;
+    int games = 1000;
+    double moveSeconds = 1;
+    uint64_t seed = 0;
+    int threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        bool ok = hasValue;
+        if (!std::strcmp(argv[i], "--rows") && hasValue) {
+            ok = parseList(argv[++i], &rows);
+        } else if (!std::strcmp(argv[i], "--cols") && hasValue) {
+            ok = parseList(argv[++i], &cols);
+        } else if (!std::strcmp(argv[i], "--types") && hasValue) {
+            ok = parseList(argv[++i], &types);
+        } else if (!std::strcmp(argv[i], "--blocks") && hasValue) {
+            ok = parseList(argv[++i], &blocks);
+        } else if (!std::strcmp(argv[i], "--turns") && hasValue) {
+            ok = parseList(argv[++i], &turns);
+        } else if (!std::strcmp(argv[i], "--items") && hasValue) {
+            ok = parseList(argv[++i], &items);
+        } else if (!std::strcmp(argv[i], "--difficulty") && hasValue) {
+            ok = parseDifficulties(argv[++i], &difficulties);
+        } else if (!std::strcmp(argv[i], "--games") && hasValue) {
+            games = std::atoi(argv[++i]);
+            ok = games > 0;
+        } else if (!std::strcmp(argv[i], "--move-seconds") && hasValue) {
+            moveSeconds = std::atof(argv[++i]);
+            ok = moveSeconds > 0;
+        } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--threads") && hasValue) {
+            threads = std::atoi(argv[++i]);
+            ok = threads >= 0;
+        } else if (!std::strcmp(argv[i], "--border")) {
+            borderRouting = true;
+            ok = true;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            printUsage();
+            return 2;
+        }
+    }
+
+    std::vector<ParameterSet> sets;
+    for (const int r: rows) {
+        for (const int c: cols) {
+            for (const int t: types) {
+                for (const int b: blocks) {
+                    for (const int m: turns) {
+                        for (const int p: items) {
+                            for (const int d: difficulties) {
+                                ParameterSet set;
+                                set.options.rows = r;
+                                set.options.cols = c;
+                                set.options.blocks = b;
+                                set.options.maxTurns = m;
+                                set.types = t;
+                                set.itemProbability = p;
+                                set.difficulty = d;
+                                set.borderRouting = borderRouting;
+                                if (!validSet(set)) {
+                                    std::fprintf(stderr, "montecarlo: bad "
+                                                 "parameters %dx%d, %d types, "
+                                                 "%d blocks\n", r, c, t, b);
+                                    return 2;
+                                }
+                                sets.push_back(set);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    TaskPool pool(threads);
+    std::vector<std::unique_ptr<Simulator>> simulators;
+    for (int i = 0; i < pool.workerCount(); ++i) {
+        simulators.emplace_back(new Simulator());
+    }
+
+    std::printf("rows,cols,types,blocks,turns,border,item_probability,"
+                "difficulty,policy,games,clear_rate,stuck_rate,times_up_rate,"
+                "moves_to_stuck,shuffles,failed_maps\n");
+    std::vector<GameResult> results(games);
+    for (const ParameterSet &set: sets) {
+        // Both policies play the same maps, and the same seeds give the same
+        // games in every run.
+        for (const Policy policy: { kRandomPolicy, kGreedyPolicy }) {
+            pool.run(games, [&](const int task, const int worker) {
+                results[task] = simulators[worker]->play(
+                            set, policy, moveSeconds, seed + task);
+            });
+            printRow(set, policy, results);
+        }
+    }
+    return 0;
+}
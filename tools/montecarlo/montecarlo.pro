@@ -0,0 +1,10 @@
+# Headless Monte-Carlo estimate of how generator parameters play.
+
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= app_bundle qt
+
+include(../../core.pri)
+
+SOURCES += \
+    main.cpp
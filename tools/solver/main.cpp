@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "solver.h"
+
+namespace {
+
+void printUsage()
+{
+    std::fprintf(stderr,
+                 "usage: solver [options] [board.txt]\n"
+                 "\n"
+                 "Decides whether a board can be cleared. The board is read\n"
+                 "from the file, or from stdin, in the form of\n"
+                 "Board::toAscii.\n"
+                 "\n"
+                 "  --random ROWS COLS TYPES BLOCKS  solve a random board\n"
+                 "                                   instead\n"
+                 "  --seed N        seed of the random board (0)\n"
+                 "  --turns N       turns a link may take (2)\n"
+                 "  --border        let links run around the board\n"
+                 "  --nodes N       give up after N nodes\n"
+                 "  --millis N      give up after N milliseconds\n"
+                 "  --table-bits N  2^N transposition table entries (22)\n"
+                 "  --moves         print the clearing sequence\n");
+}
+
+// Fill <board> with <blocks> blocks of <types> contents in equal numbers, at
+// random cells, the way the game does.
+bool randomBoard(Board &board, const int rows, const int cols,
+                 const int types, const int blocks, const unsigned seed)
+{
+    if (rows <= 0 || cols <= 0 || types <= 0 || blocks > rows * cols ||
+        types > Board::kMaxAsciiContent || blocks % (2 * types)) {
+        return false;
+    }
+    std::mt19937 rng(seed);
+    std::vector<int> pos(rows * cols);
+    std::iota(pos.begin(), pos.end(), 0);
+    std::shuffle(pos.begin(), pos.end(), rng);
+
+    const int perType = blocks / types;
+    board.beginUpdate();
+    board.reset(rows, cols);
+    for (int i = 0; i < blocks; ++i) {
+        board.setCell(pos[i] / cols, pos[i] % cols, BlockType::kBlock,
+                      i / perType + 1);
+    }
+    board.endUpdate();
+    return true;
+}
+
+const char *statusName(const SolveStatus status)
+{
+    switch (status) {
+    case SolveStatus::kSolved:
+        return "solved";
+    case SolveStatus::kUnsolvable:
+        return "unsolvable";
+    default:
+        return "out of budget";
+    }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    Board board;
+    SolverBudget budget;
+    int maxTurns = 2;
+    int tableBits = 22;
+    bool printMoves = false;
+    bool random = false;
+    int rows = 0;
+    int cols = 0;
+    int types = 0;
+    int blocks = 0;
+    unsigned seed = 0;
+    const char *path = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--random") && i + 4 < argc) {
+            random = true;
+            rows = std::atoi(argv[++i]);
+            cols = std::atoi(argv[++i]);
+            types = std::atoi(argv[++i]);
+            blocks = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--turns") && hasValue) {
+            maxTurns = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--nodes") && hasValue) {
+            budget.maxNodes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--millis") && hasValue) {
+            budget.maxMillis = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--table-bits") && hasValue) {
+            tableBits = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--border")) {
+            board.setBorderRouting(true);
+        } else if (!std::strcmp(argv[i], "--moves")) {
+            printMoves = true;
+        } else if (argv[i][0] != '-' && path == nullptr) {
+            path = argv[i];
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (random) {
+        if (!randomBoard(board, rows, cols, types, blocks, seed)) {
+            std::fprintf(stderr, "solver: bad random board parameters\n");
+            return 2;
+        }
+    } else {
+        std::stringstream text;
+        if (path != nullptr) {
+            std::ifstream file(path);
+            if (!file) {
+                std::fprintf(stderr, "solver: cannot open %s\n", path);
+                return 2;
+            }
+            text << file.rdbuf();
+        } else {
+            text << std::cin.rdbuf();
+        }
+        if (!board.fromAscii(text.str())) {
+            std::fprintf(stderr, "solver: malformed board\n");
+            return 2;
+        }
+    }
+
+    Solver solver(tableBits);
+    const SolverResult result = solver.solve(board, maxTurns, budget);
+
+    std::printf("board: %d x %d\n", board.rows(), board.cols());
+    std::printf("status: %s\n", statusName(result.status));
+    std::printf("nodes: %llu\n",
+                static_cast<unsigned long long>(result.nodes));
+    std::printf("table hits: %llu\n",
+                static_cast<unsigned long long>(result.tableHits));
+    std::printf("seconds: %.3f\n", result.seconds);
+    std::printf("nodes/sec: %.0f\n", result.nodesPerSecond());
+    if (printMoves) {
+        for (const auto &m: result.moves) {
+            std::printf("%d %d %d %d\n", m.first.r, m.first.c,
+                        m.second.r, m.second.c);
+        }
+    }
+
+    return result.status == SolveStatus::kOutOfBudget ? 1 : 0;
+}
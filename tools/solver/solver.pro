@@ -0,0 +1,10 @@
+# Headless command line front end of the exact solver.
+
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= app_bundle qt
+
+include(../../core.pri)
+
+SOURCES += \
+    main.cpp
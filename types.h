@@ -25,5 +25,25 @@ typedef enum {
     kExtend30s, kShuffle, kHint
 } ItemType;
 
+typedef enum {
+    kLayeredBfs, kLineOfSight
+} LinkEngine;
+
+typedef enum {
+    kSolved, kUnsolvable, kOutOfBudget
+} SolveStatus;
+
+typedef enum {
+    kMapStream, kShuffleStream, kItemStream, kPlayerStream
+} RandomStream;
+
+typedef enum {
+    kEasy, kNormal, kHard
+} Difficulty;
+
+typedef enum {
+    kAllMatched, kNoMoreMatch, kOutOfTime
+} GameOutcome;
+
 typedef int BlockContent;
 #endif // TYPES_H
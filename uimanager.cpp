@@ -4,14 +4,24 @@ const unique_ptr<UiConfig> UiManager::kUiConfig =
         UiConfigBuilder::windowSize(kWindowHeight, kWindowWidth)
         ->build();
 
-UiManager::UiManager(): startWindow(kUiConfig), gameWindow(kUiConfig)
+UiManager::UiManager(): startWindow(kUiConfig), gameWindow(kUiConfig),
+    mapPool(GameEngine::mapOptions(), kMapPoolDepth, kMapPoolWorkers),
+    adaptiveTier(kNormal), adaptiveGame(false), selectedAdaptive(false)
 {
+    // Have maps ready for the default settings of both modes, and for the
+    // settings selected later on.
+    prefillSelected();
+
     connect(&startWindow, &StartWindow::sendStartGame,
             this, &UiManager::switchToNewGame);
     connect(&startWindow, &StartWindow::sendLoadGame,
             this, &UiManager::switchToLoadedGame);
+    connect(&startWindow, &StartWindow::sendSettingsChanged,
+            this, &UiManager::selectSettings);
     connect(&gameWindow, &GameWindow::sendBackToMenu,
             this, &UiManager::switchToStartWindow);
+    connect(&gameWindow, &GameWindow::sendGameOver,
+            this, &UiManager::adaptDifficulty);
 }
 
 void UiManager::switchToWindow(QWidget *const sender, QWidget *const receiver)
@@ -21,24 +31,97 @@ void UiManager::switchToWindow(QWidget *const sender, QWidget *const receiver)
     receiver->show();
 }
 
+void UiManager::prefillSelected()
+{
+    MapSpec spec = selectedSpec;
+    if (selectedAdaptive) {
+        spec.difficulty = adaptiveTier;
+    }
+    spec.players = 1;
+    mapPool.prefill(spec);
+    spec.players = 2;
+    mapPool.prefill(spec);
+}
+
 void UiManager::showDefaultWindow()
 {
     startWindow.show();
 }
 
+uint64_t UiManager::mapPoolHits() const
+{
+    return mapPool.hits();
+}
+
+uint64_t UiManager::mapPoolMisses() const
+{
+    return mapPool.misses();
+}
+
 void UiManager::switchToStartWindow(QWidget *const sender)
 {
     switchToWindow(sender, &startWindow);
 }
 
-void UiManager::switchToNewGame(QWidget *const sender, const GameMode mode)
+void UiManager::switchToNewGame(QWidget *const sender, const GameMode mode,
+                                const int maxTurns, const bool borderRouting,
+                                const bool seeded, const quint64 seed,
+                                const Difficulty difficulty,
+                                const bool adaptive)
 {
-    gameWindow.prepareNewGame(mode);
+    MapSpec spec;
+    spec.maxTurns = maxTurns;
+    spec.borderRouting = borderRouting;
+    spec.players = mode == GameMode::kSingle ? 1 : 2;
+    spec.difficulty = adaptive ? adaptiveTier : difficulty;
+    // Games with a given seed are generated on the spot, as pooled maps come
+    // with seeds of their own. Stay where the user is if no map fit for a
+    // game could be made.
+    const PooledMap map = seeded ? mapPool.mapFor(spec, seed) :
+                                   mapPool.take(spec);
+    if (!map.validated) {
+        return;
+    }
+    adaptiveGame = adaptive;
+    gameWindow.prepareNewGame(mode, map);
     switchToWindow(sender, &gameWindow);
 }
 
 void UiManager::switchToLoadedGame(QWidget *const sender)
 {
-    gameWindow.prepareSavedGame();
+    // Stay where the user is if there is no game to load.
+    if (!gameWindow.prepareSavedGame()) {
+        return;
+    }
+    adaptiveGame = false;
     switchToWindow(sender, &gameWindow);
 }
+
+void UiManager::selectSettings(const int maxTurns, const bool borderRouting,
+                               const Difficulty difficulty,
+                               const bool adaptive)
+{
+    selectedSpec.maxTurns = maxTurns;
+    selectedSpec.borderRouting = borderRouting;
+    selectedSpec.difficulty = difficulty;
+    selectedAdaptive = adaptive;
+    prefillSelected();
+}
+
+void UiManager::adaptDifficulty(const bool cleared, const int timeRemaining)
+{
+    if (!adaptiveGame) {
+        return;
+    }
+    adaptiveGame = false;
+    if (cleared && timeRemaining >= kFastClearSeconds) {
+        adaptiveTier = static_cast<Difficulty>(std::min(adaptiveTier + 1,
+                                                        int(kHard)));
+    } else if (!cleared) {
+        adaptiveTier = static_cast<Difficulty>(std::max(adaptiveTier - 1,
+                                                        int(kEasy)));
+    }
+
+    // The next adaptive game may want maps of another tier.
+    prefillSelected();
+}
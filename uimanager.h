@@ -10,12 +10,38 @@
 class UiManager: public QObject {
     Q_OBJECT
 private:
-    static const int kWindowWidth = 1200;
-    static const int kWindowHeight = 650;
+    static const int kWindowWidth = 1280;
+    static const int kWindowHeight = 730;
+
+    // Maps of each game setting kept ready for new games, and the threads
+    // that generate them.
+    static const int kMapPoolDepth = 2;
+    static const int kMapPoolWorkers = 1;
 
     StartWindow startWindow;
     GameWindow gameWindow;
 
+    // Seconds that must be left on the clock when a game is cleared for
+    // adaptive games to get harder, half of the time a game starts with.
+    static const int kFastClearSeconds = 30;
+
+    // Maps for new games, generated in the background.
+    MapPool mapPool;
+
+    // Difficulty of the next adaptive game, and whether the game being
+    // played is one.
+    Difficulty adaptiveTier;
+    bool adaptiveGame;
+
+    // Settings selected in <startWindow>, of one player, and whether their
+    // difficulty is left to adapt. The maps of these settings are kept ready.
+    MapSpec selectedSpec;
+    bool selectedAdaptive;
+
+    // Start keeping maps of <selectedSpec> ready for both modes, with the
+    // difficulty of the next adaptive game if <selectedAdaptive>.
+    void prefillSelected();
+
     // A general function that hides <sender> and displays <receiver> at the
     // same screen position.
     void switchToWindow(QWidget *const sender, QWidget *const receiver);
@@ -27,10 +53,26 @@ public:
     // Defualt window is StartWindow.
     void showDefaultWindow();
 
+    // Number of new games whose map was ready in <mapPool>, and that had to
+    // wait for one to be generated.
+    uint64_t mapPoolHits() const;
+    uint64_t mapPoolMisses() const;
+
 private slots:
     void switchToStartWindow(QWidget *const sender);
-    void switchToNewGame(QWidget *const sender, const GameMode mode);
+    void switchToNewGame(QWidget *const sender, const GameMode mode,
+                         const int maxTurns, const bool borderRouting,
+                         const bool seeded, const quint64 seed,
+                         const Difficulty difficulty, const bool adaptive);
     void switchToLoadedGame(QWidget *const sender);
+
+    // Keep maps of the settings selected in <startWindow> ready.
+    void selectSettings(const int maxTurns, const bool borderRouting,
+                        const Difficulty difficulty, const bool adaptive);
+
+    // Make the next adaptive game harder if this one was cleared quickly,
+    // and easier if it was lost.
+    void adaptDifficulty(const bool cleared, const int timeRemaining);
 };
 
 #endif // UIMANAGER_H
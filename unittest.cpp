@@ -1,113 +1,1763 @@
 #include "unittest.h"
 
+#include <fstream>
+#include <sstream>
+
 UnitTest::UnitTest()
 {
 
 }
 
-void UnitTest::clearBlockMap(GameWindow &w) {
-    for (int r = 0; r < GameWindow::kMaxRows; ++r) {
-        for (int c = 0; c < GameWindow::kMaxCols; ++c) {
-            w.blockMap[r][c] = new Block(r, c, false, BlockType::kEmpty,
-                                         Block::kEmptyBlock,
-                                         WhichPlayer::kNoPlayer,
-                                         &w);
-        }
-    }
+void UnitTest::clearGame(GameEngine &engine)
+{
+    engine.gameBoard.beginUpdate();
+    engine.gameBoard.reset(GameEngine::kMaxRows, GameEngine::kMaxCols);
+    engine.gameBoard.endUpdate();
+    engine.choosers.assign(engine.choosers.size(), WhichPlayer::kNoPlayer);
+    engine.rebuild();
 }
 
-void UnitTest::generateBlock(GameWindow &w, const int r, const int c,
+void UnitTest::generateBlock(GameEngine &engine, const int r, const int c,
                              const BlockType t,
                              const BlockContent bc,
                              const WhichPlayer which)
 {
-    Block *b = w.blockMap[r][c];
-    b->t = t;
-    b->bc = bc;
-    b->p = which;
+    engine.setCell({ r, c }, t, bc);
+    engine.choosers[engine.cellIndex({ r, c })] = which;
+}
+
+void UnitTest::generateBoard(Board &board, const unsigned seed)
+{
+    const int rows = GameEngine::kMaxRows;
+    const int cols = GameEngine::kMaxCols;
+    std::mt19937 rng(seed);
+    QVector<int> pos(rows * cols);
+    std::iota(pos.begin(), pos.end(), 0);
+    std::shuffle(pos.begin(), pos.end(), rng);
+
+    board.beginUpdate();
+    board.reset(rows, cols);
+    for (int i = 0; i < GameEngine::kBlockNum; ++i) {
+        board.setCell(pos[i] / cols, pos[i] % cols, BlockType::kBlock,
+                      i / GameEngine::kBlocksPerType + 1);
+    }
+    board.endUpdate();
+}
+
+bool UnitTest::referenceConnect(const Board &board, const Cell &from,
+                                const Cell &to, const int maxTurns)
+{
+    if (from.r == to.r && from.c == to.c) {
+        return false;
+    }
+    referenceVisited.assign((board.rows() + 2) * (board.cols() + 2), 0);
+    referenceVisited[(from.r + 1) * (board.cols() + 2) + from.c + 1] = 1;
+    return referenceSearch(board, from, to, 0, maxTurns, -1);
+}
+
+bool UnitTest::referenceSearch(const Board &board, const Cell &current,
+                               const Cell &to, const int turns,
+                               const int maxTurns, const int prevD)
+{
+    static const int dr[] = { -1, 1, 0, 0 };
+    static const int dc[] = { 0, 0, -1, 1 };
+    const int margin = board.borderRouting() ? 1 : 0;
+
+    // Try the directions that head for <to> first.
+    int order[] = { Direction::kUp, Direction::kDown,
+                    Direction::kLeft, Direction::kRight };
+    auto distance = [&](const int d) {
+        return std::abs(current.r + dr[d] - to.r) +
+                std::abs(current.c + dc[d] - to.c);
+    };
+    std::stable_sort(std::begin(order), std::end(order),
+                     [&](const int a, const int b) {
+        return distance(a) < distance(b);
+    });
+
+    for (const int d: order) {
+        const int newR = current.r + dr[d];
+        const int newC = current.c + dc[d];
+        const int newTurns = prevD < 0 ? 0 : d == prevD ? turns : turns + 1;
+
+        // Check index out of bound or too many turns or circular visit.
+        if (newR < -margin || newR >= board.rows() + margin ||
+            newC < -margin || newC >= board.cols() + margin ||
+            newTurns > maxTurns) {
+            continue;
+        }
+        uint8_t &visited =
+                referenceVisited[(newR + 1) * (board.cols() + 2) + newC + 1];
+        if (visited) {
+            continue;
+        }
+
+        // Check correct answer.
+        if (newR == to.r && newC == to.c) {
+            return true;
+        }
+
+        // Check block occupied. The border lane is always empty.
+        const bool inside = newR >= 0 && newR < board.rows() &&
+                newC >= 0 && newC < board.cols();
+        if (inside && board.type(newR, newC) == BlockType::kBlock) {
+            continue;
+        }
+
+        visited = 1;
+        if (referenceSearch(board, { newR, newC }, to, newTurns, maxTurns,
+                            d)) {
+            return true;
+        }
+        visited = 0;
+    }
+    return false;
+}
+
+void UnitTest::generateFuzzBoard(Board &board, std::mt19937 &rng,
+                                 const int rows, const int cols,
+                                 const int density, const int contents)
+{
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> content(1, contents);
+
+    board.beginUpdate();
+    board.reset(rows, cols);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            const int x = percent(rng);
+            if (x < density) {
+                board.setCell(r, c, BlockType::kBlock, content(rng));
+            } else if (x < density + 5) {
+                board.setCell(r, c, BlockType::kItem, ItemType::kHint);
+            }
+        }
+    }
+    board.endUpdate();
+}
+
+std::string UnitTest::linkMismatch(const Board &board, const Cell &from,
+                                   const Cell &to, const int maxTurns)
+{
+    const bool expected = referenceConnect(board, from, to, maxTurns);
+    const int margin = board.borderRouting() ? 1 : 0;
+    std::string report;
+
+    // A path must run from <from> to <to> along straight segments over
+    // cells that links may pass, with no more than <maxTurns> turns.
+    auto brokenPath = [&](const LinkPath &path) {
+        if (path.size() < 2 ||
+            static_cast<int>(path.size()) > maxTurns + 2 ||
+            path.front().r != from.r || path.front().c != from.c ||
+            path.back().r != to.r || path.back().c != to.c) {
+            return true;
+        }
+        for (size_t i = 1; i < path.size(); ++i) {
+            const Cell &a = path[i - 1];
+            const Cell &b = path[i];
+            if ((a.r != b.r) == (a.c != b.c)) {
+                return true;
+            }
+            const int dr = (b.r > a.r) - (b.r < a.r);
+            const int dc = (b.c > a.c) - (b.c < a.c);
+            for (Cell cell = { a.r + dr, a.c + dc };
+                 cell.r != b.r || cell.c != b.c;
+                 cell.r += dr, cell.c += dc) {
+                if (cell.r < -margin || cell.r >= board.rows() + margin ||
+                    cell.c < -margin || cell.c >= board.cols() + margin ||
+                    board.isBlock(board.index(cell))) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    auto check = [&](const char *engine, const bool linked,
+                     const LinkPath *path) {
+        if (linked != expected) {
+            report += std::string(engine) + ": " +
+                    (linked ? "linked" : "not linked") + "\n";
+        } else if (linked && path != nullptr && brokenPath(*path)) {
+            report += std::string(engine) + ": broken path\n";
+        }
+    };
+
+    LinkChecker checker(&board);
+    LinkPath path;
+    check("layered bfs", checker.connect(from, to, maxTurns, &path), &path);
+    if (maxTurns <= 2) {
+        checker.setEngine(LinkEngine::kLineOfSight);
+        check("line of sight", checker.connect(from, to, maxTurns, &path),
+              &path);
+    }
+    checker.setTurnLimit(maxTurns);
+    check("link kernel", checker.link(from, to, &path), &path);
+    checker.connectAll(from, maxTurns, nullptr);
+    check("sweep", checker.isReached(to), nullptr);
+
+    if (!report.empty()) {
+        report = std::string("reference: ") +
+                (expected ? "linked" : "not linked") + "\n" + report;
+    }
+    return report;
+}
+
+void UnitTest::shrinkLinkMismatch(Board &board, Cell &from, Cell &to,
+                                  const int maxTurns)
+{
+    bool shrunk = true;
+    while (shrunk) {
+        shrunk = false;
+
+        // Drop a row or a column that neither end is on.
+        std::string text = board.toAscii();
+        std::vector<std::string> lines;
+        for (size_t start = 0; start < text.size();) {
+            const size_t end = text.find('\n', start);
+            lines.push_back(text.substr(start, end - start));
+            start = end + 1;
+        }
+        for (int r = 0; r < board.rows() && !shrunk; ++r) {
+            if (r == from.r || r == to.r || board.rows() == 1) {
+                continue;
+            }
+            Board smaller(board);
+            std::string rest;
+            for (int i = 0; i < board.rows(); ++i) {
+                if (i != r) {
+                    rest += lines[i] + '\n';
+                }
+            }
+            smaller.fromAscii(rest);
+            const Cell f = { from.r - (from.r > r), from.c };
+            const Cell t = { to.r - (to.r > r), to.c };
+            if (!linkMismatch(smaller, f, t, maxTurns).empty()) {
+                board = smaller;
+                from = f;
+                to = t;
+                shrunk = true;
+            }
+        }
+        for (int c = 0; c < board.cols() && !shrunk; ++c) {
+            if (c == from.c || c == to.c || board.cols() == 1) {
+                continue;
+            }
+            Board smaller(board);
+            std::string rest;
+            for (const std::string &line: lines) {
+                rest += line.substr(0, c) + line.substr(c + 1) + '\n';
+            }
+            smaller.fromAscii(rest);
+            const Cell f = { from.r, from.c - (from.c > c) };
+            const Cell t = { to.r, to.c - (to.c > c) };
+            if (!linkMismatch(smaller, f, t, maxTurns).empty()) {
+                board = smaller;
+                from = f;
+                to = t;
+                shrunk = true;
+            }
+        }
+
+        // Clear a cell other than the two ends.
+        for (int r = 0; r < board.rows() && !shrunk; ++r) {
+            for (int c = 0; c < board.cols() && !shrunk; ++c) {
+                if (board.type(r, c) == BlockType::kEmpty ||
+                    (r == from.r && c == from.c) || (r == to.r && c == to.c)) {
+                    continue;
+                }
+                Board smaller(board);
+                smaller.clearCell(r, c);
+                if (!linkMismatch(smaller, from, to, maxTurns).empty()) {
+                    board = smaller;
+                    shrunk = true;
+                }
+            }
+        }
+    }
 }
 
 void UnitTest::testSuccess()
 {
-    GameWindow w(UiManager::kUiConfig);
-    clearBlockMap(w);
+    GameEngine engine;
+    clearGame(engine);
 
     // Check success in no turn.
-    generateBlock(w, 0, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 0, 1, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    QVERIFY(w.checkMatch(w.blockMap[0][0], w.blockMap[0][1], nullptr));
+    generateBlock(engine, 0, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 0, 1, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    QVERIFY(engine.checkMatch({ 0, 0 }, { 0, 1 }, nullptr));
 
     // Check success in one turn.
-    generateBlock(w, 1, 2, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 2, 3, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    QVERIFY(w.checkMatch(w.blockMap[1][2], w.blockMap[2][3], nullptr));
+    generateBlock(engine, 1, 2, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 2, 3, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    QVERIFY(engine.checkMatch({ 1, 2 }, { 2, 3 }, nullptr));
 
     // Check success in two turns.
-    generateBlock(w, 2, 2, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 2, 4, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    QVERIFY(w.checkMatch(w.blockMap[2][2], w.blockMap[2][4], nullptr));
+    generateBlock(engine, 2, 2, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 2, 4, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    QVERIFY(engine.checkMatch({ 2, 2 }, { 2, 4 }, nullptr));
 }
 
 void UnitTest::testWrongContent()
 {
-    GameWindow w(UiManager::kUiConfig);
-    clearBlockMap(w);
+    GameEngine engine;
+    clearGame(engine);
 
-    generateBlock(w, 0, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 0, 1, BlockType::kBlock, 2, WhichPlayer::kPlayer1);
-    QVERIFY(!w.checkMatch(w.blockMap[0][0], w.blockMap[0][1], nullptr));
+    generateBlock(engine, 0, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 0, 1, BlockType::kBlock, 2, WhichPlayer::kPlayer1);
+    QVERIFY(!engine.checkMatch({ 0, 0 }, { 0, 1 }, nullptr));
 }
 
 void UnitTest::testWrongType()
 {
-    GameWindow w(UiManager::kUiConfig);
-    clearBlockMap(w);
+    GameEngine engine;
+    clearGame(engine);
 
-    generateBlock(w, 0, 0, BlockType::kItem, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 0, 1, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    QVERIFY(!w.checkMatch(w.blockMap[0][0], w.blockMap[0][1], nullptr));
+    generateBlock(engine, 0, 0, BlockType::kItem, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 0, 1, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    QVERIFY(!engine.checkMatch({ 0, 0 }, { 0, 1 }, nullptr));
 
-    generateBlock(w, 0, 0, BlockType::kEmpty, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 0, 1, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    QVERIFY(!w.checkMatch(w.blockMap[0][0], w.blockMap[0][1], nullptr));
+    generateBlock(engine, 0, 0, BlockType::kEmpty, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 0, 1, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    QVERIFY(!engine.checkMatch({ 0, 0 }, { 0, 1 }, nullptr));
 
-    generateBlock(w, 0, 0, BlockType::kEmpty, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 0, 1, BlockType::kItem, 1, WhichPlayer::kPlayer1);
-    QVERIFY(!w.checkMatch(w.blockMap[0][0], w.blockMap[0][1], nullptr));
+    generateBlock(engine, 0, 0, BlockType::kEmpty, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 0, 1, BlockType::kItem, 1, WhichPlayer::kPlayer1);
+    QVERIFY(!engine.checkMatch({ 0, 0 }, { 0, 1 }, nullptr));
 }
 
 void UnitTest::testExcessiveTurns()
 {
-    GameWindow w(UiManager::kUiConfig);
-    clearBlockMap(w);
+    GameEngine engine;
+    clearGame(engine);
 
-    generateBlock(w, 0, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 1, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 0, 2, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 2, 1, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 2, 2, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 2, 3, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 0, 3, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 0, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 1, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 0, 2, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 2, 1, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 2, 2, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 2, 3, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 0, 3, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
 
-    QVERIFY(!w.checkMatch(w.blockMap[0][0], w.blockMap[0][3], nullptr));
+    QVERIFY(!engine.checkMatch({ 0, 0 }, { 0, 3 }, nullptr));
 }
 
 void UnitTest::testMatchSelf()
 {
-    GameWindow w(UiManager::kUiConfig);
-    clearBlockMap(w);
+    GameEngine engine;
+    clearGame(engine);
 
-    generateBlock(w, 0, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    QVERIFY(!w.checkMatch(w.blockMap[0][0], w.blockMap[0][0], nullptr));
+    generateBlock(engine, 0, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    QVERIFY(!engine.checkMatch({ 0, 0 }, { 0, 0 }, nullptr));
 }
 
 void UnitTest::testChosenByDifferentPlayer()
 {
-    GameWindow w(UiManager::kUiConfig);
-    clearBlockMap(w);
+    GameEngine engine;
+    clearGame(engine);
+
+    generateBlock(engine, 0, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 0, 1, BlockType::kBlock, 1, WhichPlayer::kPlayer2);
+    QVERIFY(!engine.checkMatch({ 0, 0 }, { 0, 1 }, nullptr));
+}
+
+
+void UnitTest::testPathCorners()
+{
+    GameEngine engine;
+    clearGame(engine);
+    LinkPath path;
+
+    // Straight link only has the two blocks as corners.
+    generateBlock(engine, 0, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    generateBlock(engine, 0, 3, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
+    QVERIFY(engine.checkMatch({ 0, 0 }, { 0, 3 }, &path));
+    QCOMPARE(path.size(), size_t(2));
+
+    // Wall off the straight link, so that it has to go around through row 1.
+    generateBlock(engine, 0, 1, BlockType::kBlock, 2, WhichPlayer::kNoPlayer);
+    QVERIFY(engine.checkMatch({ 0, 0 }, { 0, 3 }, &path));
+    QCOMPARE(path.size(), size_t(4));
+    QCOMPARE(path[1].r, 1);
+    QCOMPARE(path[1].c, 0);
+    QCOMPARE(path[2].r, 1);
+    QCOMPARE(path[2].c, 3);
+}
+
+void UnitTest::testLinkEnginesAgree()
+{
+    const int rows = GameEngine::kMaxRows;
+    const int cols = GameEngine::kMaxCols;
+    Board board;
+    LinkChecker bfs(&board);
+    LinkChecker lineOfSight(&board);
+    lineOfSight.setEngine(LinkEngine::kLineOfSight);
+
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        generateBoard(board, seed);
+        for (int i = 0; i < rows * cols; ++i) {
+            for (int j = i + 1; j < rows * cols; j += 7) {
+                const Cell from = { i / cols, i % cols };
+                const Cell to = { j / cols, j % cols };
+                for (int turns = 0; turns <= GameEngine::kDefaultMaxTurns;
+                     ++turns) {
+                    QCOMPARE(lineOfSight.connect(from, to, turns, nullptr),
+                             bfs.connect(from, to, turns, nullptr));
+                }
+            }
+        }
+    }
+}
+
+void UnitTest::testLinkKernels()
+{
+    const int rows = GameEngine::kMaxRows;
+    const int cols = GameEngine::kMaxCols;
+    Board board;
+    LinkChecker bfs(&board);
+    LinkChecker kernel(&board);
+    LinkPath path;
+
+    for (int turns = 0; turns <= LinkChecker::kMaxTurnLimit; ++turns) {
+        kernel.setTurnLimit(turns);
+        QCOMPARE(kernel.turnLimit(), turns);
+        for (unsigned seed = 0; seed < 3; ++seed) {
+            generateBoard(board, seed);
+            for (int i = 0; i < rows * cols; ++i) {
+                for (int j = i + 1; j < rows * cols; j += 7) {
+                    const Cell from = { i / cols, i % cols };
+                    const Cell to = { j / cols, j % cols };
+                    const bool linked = kernel.link(from, to, &path);
+                    QCOMPARE(linked, bfs.connect(from, to, turns, nullptr));
+                    if (linked) {
+                        QVERIFY(static_cast<int>(path.size()) <= turns + 2);
+                        QCOMPARE(path.front().r, from.r);
+                        QCOMPARE(path.front().c, from.c);
+                        QCOMPARE(path.back().r, to.r);
+                        QCOMPARE(path.back().c, to.c);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void UnitTest::testBorderRouting()
+{
+    Board board;
+    QVERIFY(board.fromAscii("1221\n"));
+    LinkChecker checker(&board);
+    LinkPath path;
+
+    // The two ends of the row can only be linked around the top or the
+    // bottom of the map.
+    QVERIFY(!checker.connect({ 0, 0 }, { 0, 3 }, 2, nullptr));
+    board.setBorderRouting(true);
+    QVERIFY(board.borderRouting());
+    for (const LinkEngine engine: { LinkEngine::kLayeredBfs,
+                                    LinkEngine::kLineOfSight }) {
+        checker.setEngine(engine);
+        QVERIFY(!checker.connect({ 0, 0 }, { 0, 3 }, 1, nullptr));
+        QVERIFY(checker.connect({ 0, 0 }, { 0, 3 }, 2, &path));
+        QCOMPARE(static_cast<int>(path.size()), 4);
+        QVERIFY(path[1].r == -1 || path[1].r == 1);
+        QCOMPARE(path[1].c, 0);
+        QCOMPARE(path[2].r, path[1].r);
+        QCOMPARE(path[2].c, 3);
+    }
+
+    // Players still cannot walk on the border lane.
+    QVERIFY(board.isObstacle(board.index(-1, 0)));
+    QVERIFY(!board.isLinkObstacle(board.index(-1, 0)));
+
+    // The mode survives a reset, and turning it off closes the lane again.
+    QVERIFY(board.fromAscii("1221\n"));
+    QVERIFY(checker.connect({ 0, 0 }, { 0, 3 }, 2, nullptr));
+    board.setBorderRouting(false);
+    QVERIFY(!checker.connect({ 0, 0 }, { 0, 3 }, 2, nullptr));
+
+    // Kernels agree with the breadth first search along the edges too.
+    const int rows = GameEngine::kMaxRows;
+    const int cols = GameEngine::kMaxCols;
+    LinkChecker bfs(&board);
+    board.setBorderRouting(true);
+    for (int turns = 0; turns <= LinkChecker::kMaxTurnLimit; ++turns) {
+        checker.setTurnLimit(turns);
+        for (unsigned seed = 0; seed < 3; ++seed) {
+            generateBoard(board, seed);
+            for (int i = 0; i < rows * cols; ++i) {
+                for (int j = i + 1; j < rows * cols; j += 7) {
+                    const Cell from = { i / cols, i % cols };
+                    const Cell to = { j / cols, j % cols };
+                    QCOMPARE(checker.link(from, to, nullptr),
+                             bfs.connect(from, to, turns, nullptr));
+                }
+            }
+        }
+    }
+}
+
+void UnitTest::testLinkFuzz_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<int>("cols");
+    QTest::addColumn<int>("density");
+    QTest::addColumn<int>("contents");
+    QTest::addColumn<int>("maxTurns");
+    QTest::addColumn<bool>("border");
+
+    QTest::newRow("game board") << GameEngine::kMaxRows <<
+            GameEngine::kMaxCols << 45 << 5 << 2 << false;
+    QTest::newRow("game board, border") << GameEngine::kMaxRows <<
+            GameEngine::kMaxCols << 45 << 5 << 2 << true;
+    QTest::newRow("straight only") << 12 << 20 << 30 << 3 << 0 << true;
+    QTest::newRow("one turn") << 12 << 20 << 40 << 3 << 1 << false;
+    QTest::newRow("dense, three turns") << 10 << 16 << 70 << 4 << 3 << true;
+    QTest::newRow("sparse, four turns") << 6 << 8 << 35 << 2 << 4 << false;
+    QTest::newRow("tiny") << 2 << 3 << 50 << 1 << 2 << true;
+}
+
+void UnitTest::testLinkFuzz()
+{
+    QFETCH(int, rows);
+    QFETCH(int, cols);
+    QFETCH(int, density);
+    QFETCH(int, contents);
+    QFETCH(int, maxTurns);
+    QFETCH(bool, border);
+
+    std::mt19937 rng(rows * 1000003u + cols * 1009u + density * 31u +
+                     contents * 7u + maxTurns * 2u + border);
+    Board board;
+    board.setBorderRouting(border);
+    std::uniform_int_distribution<int> cell(0, rows * cols - 1);
+
+    for (int i = 0; i < kFuzzBoards; ++i) {
+        generateFuzzBoard(board, rng, rows, cols, density, contents);
+        for (int j = 0; j < kFuzzPairsPerBoard; ++j) {
+            // Half of the pairs are two blocks of the same content, like the
+            // game asks about, the others are any two cells.
+            const int a = cell(rng);
+            Cell from = { a / cols, a % cols };
+            Cell to = from;
+            if ((j & 1) && board.type(from.r, from.c) == BlockType::kBlock) {
+                const auto &blocks = board.blocksOf(
+                            board.content(from.r, from.c));
+                to = board.cellAt(blocks[rng() % blocks.size()]);
+            } else {
+                const int b = cell(rng);
+                to = { b / cols, b % cols };
+            }
+            if (from.r == to.r && from.c == to.c) {
+                continue;
+            }
+
+            const std::string mismatch =
+                    linkMismatch(board, from, to, maxTurns);
+            if (!mismatch.empty()) {
+                shrinkLinkMismatch(board, from, to, maxTurns);
+                const std::string message =
+                        "link engines disagree from (" +
+                        std::to_string(from.r) + ", " +
+                        std::to_string(from.c) + ") to (" +
+                        std::to_string(to.r) + ", " + std::to_string(to.c) +
+                        ") with " + std::to_string(maxTurns) + " turns on\n" +
+                        board.toAscii() +
+                        linkMismatch(board, from, to, maxTurns);
+                QFAIL(message.c_str());
+            }
+
+            // Eliminations update the obstacle indices incrementally, so
+            // keep clearing cells while the board is being checked.
+            if (j % 100 == 99) {
+                const int b = cell(rng);
+                board.clearCell(b / cols, b % cols);
+            }
+        }
+    }
+}
+
+void UnitTest::testObstacleDistance()
+{
+    Board board(3, 5);
+    const int center = board.index(1, 2);
+
+    // Only the wall ring around an empty board.
+    QCOMPARE(board.obstacleDistance(center, Direction::kUp), 2);
+    QCOMPARE(board.obstacleDistance(center, Direction::kLeft), 3);
+    QCOMPARE(board.obstacleDistance(center, Direction::kRight), 3);
+
+    // Placing a block only updates its row and column.
+    board.setCell(1, 0, BlockType::kBlock, 1);
+    board.setCell(0, 2, BlockType::kBlock, 1);
+    QCOMPARE(board.obstacleDistance(center, Direction::kUp), 1);
+    QCOMPARE(board.obstacleDistance(center, Direction::kLeft), 2);
+
+    // Items do not obstruct, eliminating a block frees the run again.
+    board.setCell(1, 3, BlockType::kItem, ItemType::kHint);
+    board.clearCell(1, 0);
+    QCOMPARE(board.obstacleDistance(center, Direction::kLeft), 3);
+    QCOMPARE(board.obstacleDistance(center, Direction::kRight), 3);
+}
+
+void UnitTest::testConnectAll()
+{
+    const int rows = GameEngine::kMaxRows;
+    const int cols = GameEngine::kMaxCols;
+    Board board;
+    LinkChecker single(&board);
+    LinkChecker sweep(&board);
+    std::vector<Cell> partners;
+
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        generateBoard(board, seed);
+        for (int i = 0; i < rows * cols; i += 3) {
+            const Cell from = { i / cols, i % cols };
+            sweep.connectAll(from, GameEngine::kDefaultMaxTurns, &partners);
+
+            // The sweep must find exactly the blocks that pairwise queries
+            // find.
+            int connected = 0;
+            for (int j = 0; j < rows * cols; ++j) {
+                const Cell to = { j / cols, j % cols };
+                if (board.type(to.r, to.c) != BlockType::kBlock) {
+                    continue;
+                }
+                const bool linked = single.connect(from, to,
+                                                   GameEngine::kDefaultMaxTurns,
+                                                   nullptr);
+                connected += linked;
+                if (i != j) {
+                    QCOMPARE(sweep.isReached(to), linked);
+                }
+            }
+            QCOMPARE(static_cast<int>(partners.size()), connected);
+        }
+    }
+}
+
+void UnitTest::testPairIndex()
+{
+    Board board;
+    PairIndex index(&board);
+    std::mt19937 rng(0);
+
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        generateBoard(board, seed);
+        index.rebuild(GameEngine::kDefaultMaxTurns);
+        QVERIFY(index.isConsistent());
+
+        // Play random legal moves until the board is stuck, the index has to
+        // match a full rebuild after each of them.
+        while (index.count()) {
+            const auto pair = index.pairAt(rng() % index.count());
+            QVERIFY(index.contains(pair.first, pair.second));
+            board.clearCell(pair.first.r, pair.first.c);
+            index.removeBlock(pair.first);
+            board.clearCell(pair.second.r, pair.second.c);
+            index.removeBlock(pair.second);
+            QVERIFY(index.isConsistent());
+        }
+    }
+}
+
+void UnitTest::testContentBuckets()
+{
+    Board board;
+    std::mt19937 rng(0);
+    generateBoard(board, 0);
+
+    // Mix bulk and incremental changes, then compare every bucket with a
+    // plain scan of the board.
+    for (int i = 0; i < 100; ++i) {
+        const int r = rng() % board.rows();
+        const int c = rng() % board.cols();
+        if (rng() % 2) {
+            board.clearCell(r, c);
+        } else {
+            board.setCell(r, c, BlockType::kBlock,
+                          rng() % GameEngine::kTypeNum + 1);
+        }
+    }
+
+    for (BlockContent bc = 1; bc < board.contentLimit(); ++bc) {
+        QVector<int> expected;
+        for (int r = 0; r < board.rows(); ++r) {
+            for (int c = 0; c < board.cols(); ++c) {
+                if (board.type(r, c) == BlockType::kBlock &&
+                    board.content(r, c) == bc) {
+                    expected.append(board.index(r, c));
+                }
+            }
+        }
+        QVector<int> actual(board.blocksOf(bc).begin(),
+                            board.blocksOf(bc).end());
+        std::sort(actual.begin(), actual.end());
+        QCOMPARE(actual, expected);
+    }
+}
+
+void UnitTest::testRegionIndex()
+{
+    Board board;
+    RegionIndex index(&board);
+    std::mt19937 rng(0);
+    generateBoard(board, 0);
+    index.rebuild();
+    QVERIFY(index.isConsistent());
+
+    // Reachability from the top left corner, by flood fill.
+    auto reachable = [&board]() {
+        QVector<bool> seen(board.size(), false);
+        QVector<int> queue = { board.index(0, 0) };
+        seen[queue[0]] = true;
+        for (int i = 0; i < queue.size(); ++i) {
+            for (const Direction d: { Direction::kUp, Direction::kDown,
+                                      Direction::kLeft, Direction::kRight }) {
+                const int next = queue[i] + board.offset(d);
+                if (!seen[next] && !board.isObstacle(next)) {
+                    seen[next] = true;
+                    queue.append(next);
+                }
+            }
+        }
+        return seen;
+    };
+
+    // Punch random holes into the board, which only ever merges regions.
+    board.clearCell(0, 0);
+    index.removeBlock({ 0, 0 });
+    for (int i = 0; i < 200; ++i) {
+        const int r = rng() % board.rows();
+        const int c = rng() % board.cols();
+        if (!board.isBlock(board.index(r, c))) {
+            continue;
+        }
+        board.clearCell(r, c);
+        index.removeBlock({ r, c });
+        QVERIFY(index.isConsistent());
+
+        const QVector<bool> seen = reachable();
+        for (int rr = 0; rr < board.rows(); ++rr) {
+            for (int cc = 0; cc < board.cols(); ++cc) {
+                bool expected = false;
+                for (const Direction d: { Direction::kUp, Direction::kDown,
+                                          Direction::kLeft,
+                                          Direction::kRight }) {
+                    expected |= seen[board.index(rr, cc) + board.offset(d)];
+                }
+                QCOMPARE(index.canReach({ 0, 0 }, { rr, cc }), expected);
+            }
+        }
+    }
+}
+
+void UnitTest::testDistanceField()
+{
+    Board board;
+    DistanceField field(&board);
+    std::mt19937 rng(0);
+    generateBoard(board, 0);
+    board.clearCell(0, 0);
+
+    // The field is only searched again once the player changes cell.
+    field.setSource({ 0, 0 });
+    QVERIFY(field.refresh());
+    QVERIFY(!field.refresh());
+    field.setSource({ 0, 0 });
+    QVERIFY(!field.refresh());
+    QCOMPARE(field.searches(), 1);
+    QCOMPARE(field.distanceTo({ 0, 0 }), 0);
+
+    // Eliminations are repaired in place, and agree with a fresh search.
+    DistanceField fresh(&board);
+    for (int i = 0; i < 200; ++i) {
+        const int r = rng() % board.rows();
+        const int c = rng() % board.cols();
+        if (!board.isBlock(board.index(r, c))) {
+            continue;
+        }
+        board.clearCell(r, c);
+        field.removeBlock({ r, c });
+        QVERIFY(!field.refresh());
+
+        fresh.invalidate();
+        fresh.setSource({ 0, 0 });
+        fresh.refresh();
+        for (int rr = 0; rr < board.rows(); ++rr) {
+            for (int cc = 0; cc < board.cols(); ++cc) {
+                QCOMPARE(field.distanceTo({ rr, cc }),
+                         fresh.distanceTo({ rr, cc }));
+                QCOMPARE(field.reachCost({ rr, cc }),
+                         fresh.reachCost({ rr, cc }));
+            }
+        }
+    }
+    QCOMPARE(field.searches(), 1);
+
+    // Pairs ranked by walking cost from (2, 0). The pair of 1s is walled off
+    // by the 2s, even though it is only two rows away.
+    QVERIFY(board.fromAscii("1.1\n"
+                            "222\n"
+                            "...\n"
+                            ".3.\n"
+                            "3..\n"));
+    PairIndex pairs(&board);
+    pairs.rebuild(GameEngine::kDefaultMaxTurns);
+    field.invalidate();
+    field.setSource({ 2, 0 });
+    field.refresh();
+    QCOMPARE(pairCost(field, { 0, 0 }, { 0, 2 }), -1);
+    QCOMPARE(pairCost(field, { 1, 0 }, { 1, 1 }), 1);
+
+    std::vector<std::pair<Cell, Cell>> best;
+    QCOMPARE(findCheapestPairs(board, pairs, field, 10, &best), 4);
+    const int expected[4][4] = {
+        { 1, 0, 1, 1 }, { 1, 0, 1, 2 }, { 3, 1, 4, 0 }, { 1, 1, 1, 2 }
+    };
+    for (int i = 0; i < 4; ++i) {
+        QCOMPARE(best[i].first.r, expected[i][0]);
+        QCOMPARE(best[i].first.c, expected[i][1]);
+        QCOMPARE(best[i].second.r, expected[i][2]);
+        QCOMPARE(best[i].second.c, expected[i][3]);
+    }
+    QCOMPARE(findCheapestPairs(board, pairs, field, 1, &best), 1);
+    QCOMPARE(best[0].second.c, 1);
+}
+
+void UnitTest::testPathFinder()
+{
+    Board board;
+    PathFinder finder(&board);
+    DistanceField field(&board);
+    std::mt19937 rng(0);
+    generateBoard(board, 0);
+
+    // A route is a walk over free cells, as short as the distance field says.
+    auto isRoute = [&board](const std::vector<Cell> &route, const Cell &from,
+                            const Cell &target) {
+        if (route.empty() || route[0].r != from.r || route[0].c != from.c) {
+            return false;
+        }
+        for (size_t i = 0; i < route.size(); ++i) {
+            if (board.isObstacle(board.index(route[i])) ||
+                (i && std::abs(route[i].r - route[i - 1].r) +
+                      std::abs(route[i].c - route[i - 1].c) != 1)) {
+                return false;
+            }
+        }
+        return std::abs(route.back().r - target.r) +
+                std::abs(route.back().c - target.c) == 1;
+    };
+
+    std::vector<Cell> route;
+    int found = 0;
+    for (int i = 0; i < 200; ++i) {
+        const Cell from = { static_cast<int>(rng() % board.rows()),
+                            static_cast<int>(rng() % board.cols()) };
+        const Cell target = { static_cast<int>(rng() % board.rows()),
+                              static_cast<int>(rng() % board.cols()) };
+        if (board.isObstacle(board.index(from))) {
+            continue;
+        }
+        field.setSource(from);
+        field.refresh();
+        const int cost = field.reachCost(target);
+        QCOMPARE(finder.findRoute(from, target, &route), cost >= 0);
+        if (cost < 0) {
+            continue;
+        }
+        ++found;
+        QVERIFY(isRoute(route, from, target));
+        QCOMPARE(static_cast<int>(route.size()) - 1, cost);
+
+        // Blocks dropped onto the route are walked around.
+        if (route.size() < 4) {
+            continue;
+        }
+        const Cell start = route[1];
+        const Cell blocked = route[route.size() / 2];
+        board.setCell(blocked.r, blocked.c, BlockType::kBlock, 1);
+        field.invalidate();
+        field.refresh();
+        QCOMPARE(finder.repair(&route, 1, target),
+                 field.reachCost(target) >= 0);
+        if (!route.empty()) {
+            QVERIFY(isRoute(route, start, target));
+        }
+        board.clearCell(blocked.r, blocked.c);
+        field.invalidate();
+    }
+    QVERIFY(found > 0);
+}
+
+void UnitTest::testMoveEnumerator()
+{
+    Board board;
+    PairIndex index(&board);
+    MoveEnumerator enumerator(4);
+    std::vector<MoveEnumerator::Move> moves;
+    MoveEnumerator::Move move;
+
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        generateBoard(board, seed);
+        index.rebuild(GameEngine::kDefaultMaxTurns);
+
+        // All moves, merged from every worker.
+        enumerator.findAll(board, GameEngine::kDefaultMaxTurns, &moves);
+        QCOMPARE(static_cast<int>(moves.size()), index.count());
+        for (const auto &m: moves) {
+            QVERIFY(index.contains(board.cellAt(m.first),
+                                   board.cellAt(m.second)));
+        }
+
+        // Every block as a source, in reverse order of flat index, with
+        // partners ranked the same way.
+        std::vector<int> sources;
+        std::vector<int> ranks(board.size(), -1);
+        for (int idx = board.size() - 1; idx >= 0; --idx) {
+            if (board.isBlock(idx)) {
+                ranks[idx] = static_cast<int>(sources.size());
+                sources.push_back(idx);
+            }
+        }
+
+        // The first source that is part of a move, with its best partner.
+        int expectedFrom = -1;
+        int expectedTo = -1;
+        for (const int a: sources) {
+            for (int j = 0; j < index.count(); ++j) {
+                const auto pair = index.pairAt(j);
+                int b = board.index(pair.second);
+                if (board.index(pair.first) != a && b != a) {
+                    continue;
+                }
+                if (b == a) {
+                    b = board.index(pair.first);
+                }
+                if (expectedTo < 0 || ranks[b] < ranks[expectedTo]) {
+                    expectedTo = b;
+                }
+            }
+            if (expectedTo >= 0) {
+                expectedFrom = a;
+                break;
+            }
+        }
 
-    generateBlock(w, 0, 0, BlockType::kBlock, 1, WhichPlayer::kPlayer1);
-    generateBlock(w, 0, 1, BlockType::kBlock, 1, WhichPlayer::kPlayer2);
-    QVERIFY(!w.checkMatch(w.blockMap[0][0], w.blockMap[0][1], nullptr));
+        QCOMPARE(enumerator.findFirst(board, GameEngine::kDefaultMaxTurns,
+                                      sources, ranks, &move),
+                 expectedFrom >= 0);
+        if (expectedFrom >= 0) {
+            QCOMPARE(move.first, expectedFrom);
+            QCOMPARE(move.second, expectedTo);
+        }
+    }
 }
 
+void UnitTest::testAnalysisWorker()
+{
+    qRegisterMetaType<BoardAnalysis>();
+    AnalysisWorker worker;
+    QSignalSpy spy(&worker, &AnalysisWorker::sendAnalysis);
+    LinkChecker checker;
+
+    auto snapshot = make_shared<BoardSnapshot>();
+    generateBoard(snapshot->board, 0);
+    snapshot->maxTurns = GameEngine::kDefaultMaxTurns;
+    snapshot->players[0] = { -1, -1 };
+    snapshot->players[1] = { -1, -1 };
+
+    // Place player 2 on an empty cell, player 1 stays out of the game.
+    for (int idx = 0; idx < snapshot->board.size(); ++idx) {
+        if (!snapshot->board.isObstacle(idx)) {
+            snapshot->players[1] = snapshot->board.cellAt(idx);
+            break;
+        }
+    }
+
+    // Only the latter of two snapshots submitted in a row is analyzed.
+    auto stale = make_shared<BoardSnapshot>(*snapshot);
+    stale->version = 1;
+    snapshot->version = 2;
+    worker.submit(stale);
+    worker.submit(snapshot);
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 1);
+
+    const auto analysis = qvariant_cast<BoardAnalysis>(spy.takeFirst().at(0));
+    QCOMPARE(analysis.version, uint64_t(2));
+    QVERIFY(!analysis.hasHint[0]);
+    QCOMPARE(analysis.stuck, !analysis.hasHint[1]);
+    if (analysis.hasHint[1]) {
+        const auto &hint = analysis.hints[1];
+        const Board &board = snapshot->board;
+        checker.setBoard(&board);
+        QCOMPARE(board.content(hint.first.r, hint.first.c),
+                 board.content(hint.second.r, hint.second.c));
+        QVERIFY(checker.connect(hint.first, hint.second,
+                                GameEngine::kDefaultMaxTurns, nullptr));
+    }
+}
+
+void UnitTest::testBoardAscii()
+{
+    Board board;
+    Board copy;
+    generateBoard(board, 0);
+    board.setCell(0, 0, BlockType::kItem, ItemType::kHint);
+    QVERIFY(copy.fromAscii(board.toAscii()));
+    QCOMPARE(copy.toAscii(), board.toAscii());
+
+    QVERIFY(!copy.fromAscii("12\n1\n"));
+    QVERIFY(!copy.fromAscii("1?\n"));
+}
+
+void UnitTest::testBoardGenerator()
+{
+    BoardGenerator generator;
+    GeneratorOptions options;
+    options.rows = GameEngine::kMaxRows;
+    options.cols = GameEngine::kMaxCols;
+    options.blocks = GameEngine::kBlockNum;
+    options.blocksPerType = GameEngine::kBlocksPerType;
+    options.players = 2;
+
+    for (int turns = 0; turns <= LinkChecker::kMaxTurnLimit; ++turns) {
+        options.maxTurns = turns;
+        for (unsigned seed = 0; seed < 4; ++seed) {
+            Board board;
+            board.setBorderRouting(seed & 1);
+            const GeneratorResult result =
+                    generator.generate(&board, seed, options);
+            QVERIFY(result.complete);
+            QCOMPARE(static_cast<int>(result.spawns.size()), 2);
+
+            // The same seed gives the same board.
+            Board again;
+            again.setBorderRouting(seed & 1);
+            generator.generate(&again, seed, options);
+            QCOMPARE(again.toAscii(), board.toAscii());
+
+            // Taking the pairs away in order clears the board, and every pair
+            // can be linked and walked up to from both spawn points.
+            LinkChecker checker(&board);
+            RegionIndex regions(&board);
+            regions.rebuild();
+            for (const auto &move: result.order) {
+                QCOMPARE(board.type(move.first.r, move.first.c),
+                         BlockType::kBlock);
+                QCOMPARE(board.content(move.first.r, move.first.c),
+                         board.content(move.second.r, move.second.c));
+                QVERIFY(checker.connect(move.first, move.second, turns,
+                                        nullptr));
+                for (const Cell &spawn: result.spawns) {
+                    QVERIFY(regions.canReach(spawn, move.first));
+                    QVERIFY(regions.canReach(spawn, move.second));
+                }
+                board.clearCell(move.first.r, move.first.c);
+                board.clearCell(move.second.r, move.second.c);
+                regions.removeBlock(move.first);
+                regions.removeBlock(move.second);
+            }
+            QCOMPARE(static_cast<int>(result.order.size()) * 2,
+                     GameEngine::kBlockNum);
+            QCOMPARE(board.toAscii(), Board(options.rows,
+                                            options.cols).toAscii());
+        }
+    }
+
+    // Boards of tens of thousands of cells.
+    options.rows = 150;
+    options.cols = 300;
+    options.blocks = 20000;
+    options.blocksPerType = 100;
+    options.maxTurns = GameEngine::kDefaultMaxTurns;
+    Board board;
+    QVERIFY(generator.generate(&board, 1, options).complete);
+}
+
+void UnitTest::testMapPool()
+{
+    const GeneratorOptions options = GameEngine::mapOptions();
+    MapPool pool(options, 3, 2);
+    MapSpec spec;
+    spec.maxTurns = 1;
+    spec.borderRouting = true;
+    spec.players = 2;
+
+    // Workers fill the queue of a spec once it has been asked for, and keep
+    // it filled as maps are taken.
+    pool.prefill(spec);
+    QTRY_COMPARE_WITH_TIMEOUT(pool.ready(spec), 3, 10000);
+    for (int i = 0; i < 5; ++i) {
+        QTRY_VERIFY_WITH_TIMEOUT(pool.ready(spec) > 0, 10000);
+        const PooledMap map = pool.take(spec);
+        QVERIFY(map.validated);
+        QCOMPARE(map.spec.maxTurns, 1);
+        QVERIFY(map.spec.borderRouting);
+        QVERIFY(map.board.borderRouting());
+        QCOMPARE(static_cast<int>(map.spawns.size()), 2);
+        QCOMPARE(map.board.rows(), options.rows);
+        QCOMPARE(map.board.cols(), options.cols);
+        int blocks = 0;
+        for (int r = 0; r < options.rows; ++r) {
+            for (int c = 0; c < options.cols; ++c) {
+                blocks += map.board.type(r, c) == BlockType::kBlock;
+            }
+        }
+        QCOMPARE(blocks, options.blocks);
+        for (const Cell &spawn: map.spawns) {
+            QCOMPARE(map.board.type(spawn.r, spawn.c), BlockType::kEmpty);
+        }
+    }
+    QCOMPARE(pool.hits(), uint64_t(5));
+    QCOMPARE(pool.misses(), uint64_t(0));
+    QTRY_COMPARE_WITH_TIMEOUT(pool.ready(spec), 3, 10000);
+
+    // A spec that has not been asked for is generated on the spot.
+    MapSpec other;
+    QCOMPARE(pool.ready(other), 0);
+    const PooledMap map = pool.take(other);
+    QVERIFY(map.validated);
+    QCOMPARE(map.spec.maxTurns, other.maxTurns);
+    QVERIFY(!map.board.borderRouting());
+    QCOMPARE(static_cast<int>(map.spawns.size()), 1);
+    QCOMPARE(pool.misses(), uint64_t(1));
+    QTRY_COMPARE_WITH_TIMEOUT(pool.ready(other), 3, 10000);
+
+    // The depth can be changed on the fly.
+    pool.setDepth(5);
+    QCOMPARE(pool.depth(), 5);
+    QTRY_COMPARE_WITH_TIMEOUT(pool.ready(spec), 5, 10000);
+}
+
+void UnitTest::testFreeCells()
+{
+    FreeCells cells(3, 4);
+    QVERIFY(cells.empty());
+    cells.insert({ 0, 0 });
+    cells.insert({ 2, 3 });
+    cells.insert({ 1, 2 });
+    cells.insert({ 2, 3 });
+    QCOMPARE(cells.size(), 3);
+    QVERIFY(cells.contains({ 2, 3 }));
+    QVERIFY(!cells.contains({ 2, 2 }));
+
+    // Erasing moves the last cell into the hole.
+    cells.erase({ 0, 0 });
+    cells.erase({ 0, 0 });
+    QCOMPARE(cells.size(), 2);
+    QVERIFY(!cells.contains({ 0, 0 }));
+    QSet<int> seen;
+    for (int i = 0; i < cells.size(); ++i) {
+        const Cell cell = cells.at(i);
+        QVERIFY(cells.contains(cell));
+        seen.insert(cell.r * 4 + cell.c);
+    }
+    QCOMPARE(seen, QSet<int>({ 2 * 4 + 3, 1 * 4 + 2 }));
+    cells.reset(3, 4);
+    QVERIFY(cells.empty());
+
+    // The set of a game follows its board.
+    GameEngine engine;
+    clearGame(engine);
+    QCOMPARE(engine.freeCells.size(),
+             GameEngine::kMaxRows * GameEngine::kMaxCols);
+    generateBlock(engine, 3, 4, BlockType::kBlock, 1, WhichPlayer::kNoPlayer);
+    generateBlock(engine, 5, 6, BlockType::kItem, ItemType::kHint,
+                  WhichPlayer::kNoPlayer);
+    QVERIFY(!engine.freeCells.contains({ 3, 4 }));
+    QVERIFY(!engine.freeCells.contains({ 5, 6 }));
+    QCOMPARE(engine.freeCells.size(),
+             GameEngine::kMaxRows * GameEngine::kMaxCols - 2);
+    generateBlock(engine, 3, 4, BlockType::kEmpty, 0,
+                  WhichPlayer::kNoPlayer);
+    QVERIFY(engine.freeCells.contains({ 3, 4 }));
+
+    // A player cannot be placed on a full map.
+    for (int r = 0; r < GameEngine::kMaxRows; ++r) {
+        for (int c = 0; c < GameEngine::kMaxCols; ++c) {
+            generateBlock(engine, r, c, BlockType::kBlock, 1,
+                          WhichPlayer::kNoPlayer);
+        }
+    }
+    QVERIFY(engine.freeCells.empty());
+    engine.spawnPoints.clear();
+    QVERIFY(!engine.generatePlayer(WhichPlayer::kPlayer1));
+}
+
+void UnitTest::testBoardShuffler()
+{
+    BoardShuffler shuffler;
+    auto histogram = [](const Board &board) {
+        QMap<QPair<int, int>, int> counts;
+        for (int r = 0; r < board.rows(); ++r) {
+            for (int c = 0; c < board.cols(); ++c) {
+                ++counts[qMakePair(static_cast<int>(board.type(r, c)),
+                                   board.content(r, c))];
+            }
+        }
+        return counts;
+    };
+    auto playable = [](const Board &board, const Cell &player,
+                       const int maxTurns) {
+        LinkChecker checker(&board);
+        RegionIndex regions(&board);
+        regions.rebuild();
+        for (BlockContent bc = 1; bc < board.contentLimit(); ++bc) {
+            const std::vector<int> &blocks = board.blocksOf(bc);
+            for (size_t i = 0; i < blocks.size(); ++i) {
+                for (size_t j = i + 1; j < blocks.size(); ++j) {
+                    const Cell a = board.cellAt(blocks[i]);
+                    const Cell b = board.cellAt(blocks[j]);
+                    if (regions.canReach(player, a) &&
+                        regions.canReach(player, b) &&
+                        checker.connect(a, b, maxTurns, nullptr)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    };
+
+    // Game sized boards keep their contents, leave the covered cells empty,
+    // and report exactly the cells that changed.
+    for (unsigned seed = 0; seed < 8; ++seed) {
+        Board board;
+        generateBoard(board, seed);
+        const Cell player = { 7, 15 };
+        const std::vector<Cell> covered = { { 7, 15 }, { 7, 16 },
+                                            { 8, 15 }, { 8, 16 } };
+        for (const Cell &cell: covered) {
+            board.clearCell(cell.r, cell.c);
+        }
+        const Board before = board;
+        const ShuffleResult result = shuffler.shuffle(
+                    &board, { player }, covered,
+                    GameEngine::kDefaultMaxTurns, seed);
+        QVERIFY(result.playable);
+        QVERIFY(playable(board, player, GameEngine::kDefaultMaxTurns));
+        QVERIFY(histogram(board) == histogram(before));
+        for (const Cell &cell: covered) {
+            QCOMPARE(board.type(cell.r, cell.c), BlockType::kEmpty);
+        }
+        int changed = 0;
+        for (int r = 0; r < board.rows(); ++r) {
+            for (int c = 0; c < board.cols(); ++c) {
+                changed += board.type(r, c) != before.type(r, c) ||
+                        board.content(r, c) != before.content(r, c);
+            }
+        }
+        QCOMPARE(static_cast<int>(result.changed.size()), changed);
+
+        // The same seed gives the same arrangement.
+        Board again = before;
+        shuffler.shuffle(&again, { player }, covered,
+                         GameEngine::kDefaultMaxTurns, seed);
+        QCOMPARE(again.toAscii(), board.toAscii());
+    }
+
+    // A full board with distinct pairs and no turns rarely deals a pair next
+    // to the player, and has to be repaired.
+    int repaired = 0;
+    for (unsigned seed = 0; seed < 32; ++seed) {
+        Board board;
+        QVERIFY(board.fromAscii("11223\n"
+                                "34455\n"
+                                "66.77\n"
+                                "889aa\n"
+                                "9bbcc\n"));
+        const Cell player = { 2, 2 };
+        const ShuffleResult result = shuffler.shuffle(&board, { player },
+                                                      { player }, 0, seed);
+        QVERIFY(result.playable);
+        QVERIFY(playable(board, player, 0));
+        repaired += result.repaired;
+    }
+    QVERIFY(repaired > 0);
+}
+
+void UnitTest::testGameRandom()
+{
+    // The same seed gives the same numbers.
+    GameRandom a(42);
+    GameRandom b(42);
+    QCOMPARE(a.seed(), uint64_t(42));
+    for (int i = 0; i < 100; ++i) {
+        QCOMPARE(a.stream(kShuffleStream)(), b.stream(kShuffleStream)());
+    }
+
+    // Streams are independent: drawing from one leaves the others as they
+    // are, and no two streams start alike.
+    for (int i = 0; i < 1000; ++i) {
+        a.uniform(kItemStream, 0, 3);
+    }
+    for (int i = 0; i < 100; ++i) {
+        QCOMPARE(a.stream(kPlayerStream)(), b.stream(kPlayerStream)());
+    }
+    GameRandom fresh(42);
+    QSet<quint64> firsts;
+    for (int i = 0; i < GameRandom::kStreams; ++i) {
+        firsts.insert(fresh.stream(static_cast<RandomStream>(i))());
+    }
+    QCOMPARE(firsts.size(), GameRandom::kStreams);
+
+    // Restoring the state of all streams continues them.
+    GameRandom restored;
+    restored.setState(a.seed(), a.state());
+    QCOMPARE(restored.seed(), uint64_t(42));
+    for (int i = 0; i < GameRandom::kStreams; ++i) {
+        const RandomStream which = static_cast<RandomStream>(i);
+        QCOMPARE(restored.stream(which)(), a.stream(which)());
+    }
+
+    // Bounded numbers stay in range and hit every value.
+    int counts[7] = { 0 };
+    for (int i = 0; i < 7000; ++i) {
+        const int x = a.uniform(kItemStream, -3, 4);
+        QVERIFY(x >= -3 && x < 4);
+        ++counts[x + 3];
+    }
+    for (const int count: counts) {
+        QVERIFY(count > 800 && count < 1200);
+    }
+
+    // A game seed reproduces its map.
+    MapPool pool(GameEngine::mapOptions(), 0, 0);
+    MapSpec spec;
+    const PooledMap first = pool.mapFor(spec, 7);
+    const PooledMap second = pool.mapFor(spec, 7);
+    QCOMPARE(first.seed, uint64_t(7));
+    QCOMPARE(first.board.toAscii(), second.board.toAscii());
+    QCOMPARE(first.spawns.front().r, second.spawns.front().r);
+    QCOMPARE(first.spawns.front().c, second.spawns.front().c);
+    QVERIFY(pool.mapFor(spec, 8).board.toAscii() != first.board.toAscii());
+}
+
+void UnitTest::testDifficultySearch()
+{
+    // The pair of 2s is only next to the region of the spawn point once the
+    // 1s are gone, so the playout sees one pair at a time.
+    DifficultyMeter meter;
+    Board board;
+    QVERIFY(board.fromAscii("..\n11\n22\n"));
+    BoardMetrics metrics = meter.measure(board, { 0, 0 }, 0, 1);
+    QCOMPARE(metrics.pairs, 1);
+    QCOMPARE(metrics.branching, 1.0);
+    QCOMPARE(metrics.depth, 1.0);
+
+    // Without turns, the 1s cannot be linked.
+    QVERIFY(board.fromAscii("1.\n.1\n"));
+    metrics = meter.measure(board, { 0, 1 }, 0, 1);
+    QCOMPARE(metrics.pairs, 0);
+    QCOMPARE(metrics.depth, 0.0);
+    metrics = meter.measure(board, { 0, 1 }, 1, 1);
+    QCOMPARE(metrics.pairs, 1);
+    QCOMPARE(metrics.depth, 1.0);
+
+    // Harder tiers offer fewer pairs, out of more contents.
+    const GeneratorOptions options = GameEngine::mapOptions();
+    const DifficultyTarget easy = DifficultyTarget::forTier(
+                kEasy, options.maxTurns, false, options.blocks);
+    const DifficultyTarget hard = DifficultyTarget::forTier(
+                kHard, options.maxTurns, false, options.blocks);
+    QVERIFY(easy.pairs > hard.pairs && easy.branching > hard.branching);
+    QVERIFY(easy.types < hard.types);
+    BoardMetrics exact;
+    exact.pairs = easy.pairs;
+    exact.branching = easy.branching;
+    exact.depth = easy.depth;
+    QCOMPARE(easy.distance(exact), 0.0);
+    exact.pairs = easy.pairs * 2;
+    QVERIFY(easy.distance(exact) > 1);
+
+    // Searches land on target, and the result only depends on the seeds,
+    // not on the number of workers.
+    QString boards[2];
+    for (int i = 0; i < 2; ++i) {
+        DifficultySearch search(i + 1);
+        Xoshiro256 rng(3);
+        Board found;
+        const SearchResult result = search.search(&found, options, hard,
+                                                  &rng, 60000);
+        QVERIFY(result.generated.complete);
+        QVERIFY(result.onTarget);
+        QVERIFY(hard.distance(result.metrics) <= 1);
+        QSet<int> contents;
+        for (int r = 0; r < options.rows; ++r) {
+            for (int c = 0; c < options.cols; ++c) {
+                if (found.type(r, c) == BlockType::kBlock) {
+                    contents.insert(found.content(r, c));
+                }
+            }
+        }
+        QCOMPARE(contents.size(), hard.types);
+        boards[i] = QString::fromStdString(found.toAscii());
+    }
+    QCOMPARE(boards[0], boards[1]);
+
+    // Every tier can be hit with every turn limit and routing mode.
+    DifficultySearch search;
+    for (int turns = 0; turns <= LinkChecker::kMaxTurnLimit; ++turns) {
+        for (int border = 0; border < 2; ++border) {
+            for (int tier = kEasy; tier <= kHard; ++tier) {
+                GeneratorOptions tierOptions = options;
+                tierOptions.maxTurns = turns;
+                const DifficultyTarget target = DifficultyTarget::forTier(
+                            static_cast<Difficulty>(tier), turns, border,
+                            options.blocks);
+                Xoshiro256 rng(tier);
+                Board found;
+                found.setBorderRouting(border);
+                const SearchResult result = search.search(
+                            &found, tierOptions, target, &rng, 60000);
+                QVERIFY(result.onTarget);
+            }
+        }
+    }
+
+    // Pooled maps come with the difficulty they were asked for.
+    MapPool pool(options, 0, 0);
+    MapSpec spec;
+    spec.difficulty = kEasy;
+    const PooledMap map = pool.mapFor(spec, 5);
+    QCOMPARE(map.spec.difficulty, kEasy);
+    QVERIFY(map.metrics.pairs > hard.pairs);
+}
+
+void UnitTest::testLevelPack()
+{
+    // Contents up to 15 take a nibble per cell, more take a byte.
+    std::vector<PackedLevel> levels(3);
+    BoardGenerator generator;
+    GeneratorOptions options = GameEngine::mapOptions();
+    GeneratorResult generated = generator.generate(&levels[0].board, 1,
+                                                   options);
+    QVERIFY(generated.complete);
+    levels[0].spawns = generated.spawns;
+    options.blocksPerType = 4;
+    options.maxTurns = 1;
+    levels[1].board.setBorderRouting(true);
+    generated = generator.generate(&levels[1].board, 2, options);
+    QVERIFY(generated.complete);
+    levels[1].spawns = generated.spawns;
+    levels[1].maxTurns = 1;
+    QVERIFY(levels[2].board.fromAscii("1.1\n...\n2.2\n"));
+    levels[2].spawns = { { 1, 0 }, { 1, 2 } };
+    levels[2].maxTurns = 0;
+
+    const std::string bytes = LevelPack::pack(levels);
+    QVERIFY(!bytes.empty());
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const std::string path = dir.filePath("levels.qlp").toStdString();
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(bytes.data(), bytes.size());
+    }
+
+    LevelPack pack;
+    QVERIFY(pack.open(path));
+    QCOMPARE(pack.count(), 3);
+    PackedLevel level;
+    for (int i = 2; i >= 0; --i) {
+        QVERIFY(pack.load(i, &level));
+        QCOMPARE(level.board.toAscii(), levels[i].board.toAscii());
+        QCOMPARE(level.board.borderRouting(),
+                 levels[i].board.borderRouting());
+        QCOMPARE(level.maxTurns, levels[i].maxTurns);
+        QCOMPARE(level.spawns.size(), levels[i].spawns.size());
+        for (size_t s = 0; s < level.spawns.size(); ++s) {
+            QCOMPARE(level.spawns[s].r, levels[i].spawns[s].r);
+            QCOMPARE(level.spawns[s].c, levels[i].spawns[s].c);
+        }
+    }
+    QVERIFY(!pack.load(3, &level));
+    QVERIFY(!pack.load(-1, &level));
+
+    // Turn limits the game does not support are refused both ways.
+    std::vector<PackedLevel> single(1, levels[2]);
+    single[0].maxTurns = LinkChecker::kMaxTurnLimit + 1;
+    QVERIFY(LevelPack::pack(single).empty());
+    single[0].maxTurns = 0;
+    std::string tampered = LevelPack::pack(single);
+    QVERIFY(!tampered.empty());
+    tampered[LevelPack::kHeaderSize + 2 * 8 + 2] =
+            static_cast<char>(LinkChecker::kMaxTurnLimit + 1);
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(tampered.data(), tampered.size());
+    }
+    QVERIFY(pack.open(path));
+    QVERIFY(!pack.load(0, &level));
+
+    // Items cannot be packed, and a damaged header is refused.
+    levels[2].board.setCell(1, 1, BlockType::kItem, ItemType::kHint);
+    QVERIFY(LevelPack::pack(levels).empty());
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(bytes.data(), bytes.size() - 1);
+    }
+    QVERIFY(!pack.open(path));
+    QVERIFY(!pack.isOpen());
+    QCOMPARE(pack.count(), 0);
+}
+
+void UnitTest::testGameEngine()
+{
+    // Records what an engine tells its listeners.
+    struct Recorder: public GameListener {
+        int resets = 0;
+        int links = 0;
+        int score = 0;
+        int time = -1;
+        std::vector<GameOutcome> outcomes;
+
+        void gameReset() override { ++resets; }
+        void scoreChanged(const WhichPlayer, const int s) override
+        {
+            score = s;
+        }
+        void timeChanged(const int t) override { time = t; }
+        void linked(const WhichPlayer, const LinkPath &) override { ++links; }
+        void gameOver(const GameOutcome o) override { outcomes.push_back(o); }
+    };
+
+    PooledMap map;
+    map.spec.players = 1;
+    map.seed = 7;
+    map.board.beginUpdate();
+    map.board.reset(GameEngine::kMaxRows, GameEngine::kMaxCols);
+    map.board.setCell(0, 0, BlockType::kBlock, 1);
+    map.board.setCell(0, 1, BlockType::kBlock, 1);
+    map.board.setCell(5, 5, BlockType::kBlock, 2);
+    map.board.setCell(5, 8, BlockType::kBlock, 2);
+    map.board.endUpdate();
+    map.spawns = { { 7, 7 } };
+
+    GameEngine engine;
+    Recorder recorder;
+    engine.addListener(&recorder);
+    engine.newGame(GameMode::kSingle, map);
+    QCOMPARE(recorder.resets, 1);
+    QCOMPARE(engine.timeRemaining(), GameEngine::kInitialTime);
+    QCOMPARE(engine.blocksRemaining(), 4);
+    QCOMPARE(engine.player(WhichPlayer::kPlayer1).x,
+             7 * GameEngine::kCellSize + GameEngine::kCellSize / 2);
+
+    // Commands are ignored until the game is started.
+    engine.choose(WhichPlayer::kPlayer1, { 0, 0 });
+    QCOMPARE(engine.chosenBy({ 0, 0 }), WhichPlayer::kNoPlayer);
+    engine.start();
+    engine.choose(WhichPlayer::kPlayer1, { 0, 0 });
+    QCOMPARE(engine.chosenBy({ 0, 0 }), WhichPlayer::kPlayer1);
+    engine.choose(WhichPlayer::kPlayer1, { 0, 1 });
+    QCOMPARE(recorder.links, 1);
+    QCOMPARE(recorder.score, GameEngine::kScorePerMatch);
+    QCOMPARE(engine.board().type(0, 0), BlockType::kEmpty);
+    QCOMPARE(engine.board().type(0, 1), BlockType::kEmpty);
+    QCOMPARE(engine.blocksRemaining(), 2);
+
+    // A second of ticks takes a second off the clock.
+    for (int i = 0; i < GameEngine::kTicksPerSecond; ++i) {
+        engine.tick();
+    }
+    QCOMPARE(engine.timeRemaining(), GameEngine::kInitialTime - 1);
+    QCOMPARE(recorder.time, GameEngine::kInitialTime - 1);
+
+    // A saved game loads stopped, as it was.
+    std::stringstream saved;
+    engine.save(saved);
+    GameEngine loaded;
+    Recorder loadedRecorder;
+    loaded.addListener(&loadedRecorder);
+    QVERIFY(loaded.load(saved));
+    QCOMPARE(loadedRecorder.resets, 1);
+    QVERIFY(!loaded.isRunning());
+    QCOMPARE(loaded.blocksRemaining(), 2);
+    QCOMPARE(loaded.timeRemaining(), GameEngine::kInitialTime - 1);
+    QCOMPARE(loaded.seed(), engine.seed());
+    QCOMPARE(loaded.player(WhichPlayer::kPlayer1).score,
+             GameEngine::kScorePerMatch);
+    QCOMPARE(loaded.player(WhichPlayer::kPlayer1).x,
+             engine.player(WhichPlayer::kPlayer1).x);
+    QCOMPARE(loaded.board().content(5, 5), 2);
+    std::stringstream malformed("1\n0 0 garbage");
+    QVERIFY(!loaded.load(malformed));
+    QCOMPARE(loaded.blocksRemaining(), 2);
+
+    // So is a save with a random stream that would only ever draw zeros.
+    std::vector<std::string> words;
+    std::istringstream savedWords(saved.str());
+    for (std::string word; savedWords >> word; ) {
+        words.push_back(word);
+    }
+    const size_t firstStream = words.size() - 4 * GameRandom::kStreams;
+    std::fill(words.begin() + firstStream, words.begin() + firstStream + 4,
+              "0");
+    std::stringstream zeroed;
+    for (const std::string &word: words) {
+        zeroed << word << ' ';
+    }
+    QVERIFY(!loaded.load(zeroed));
+    QCOMPARE(loaded.blocksRemaining(), 2);
+
+    // And a save with a turn limit that no link engine supports. The limit
+    // comes before the routing mode and the seed.
+    words[firstStream - 3] = std::to_string(LinkChecker::kMaxTurnLimit + 1);
+    std::fill(words.begin() + firstStream, words.begin() + firstStream + 4,
+              "1");
+    std::stringstream tooManyTurns;
+    for (const std::string &word: words) {
+        tooManyTurns << word << ' ';
+    }
+    QVERIFY(!loaded.load(tooManyTurns));
+    QCOMPARE(loaded.blocksRemaining(), 2);
+
+    // Clearing the board ends the game.
+    loaded.start();
+    loaded.choose(WhichPlayer::kPlayer1, { 5, 5 });
+    loaded.choose(WhichPlayer::kPlayer1, { 5, 8 });
+    QCOMPARE(loaded.blocksRemaining(), 0);
+    QVERIFY(loaded.isOver());
+    QCOMPARE(loadedRecorder.outcomes.size(), size_t(1));
+    QCOMPARE(loadedRecorder.outcomes[0], GameOutcome::kAllMatched);
+
+    // Without turns no pair can be linked, which ends the game as soon as it
+    // starts.
+    map.spec.maxTurns = 0;
+    map.board.setCell(0, 1, BlockType::kEmpty, 0);
+    map.board.setCell(1, 1, BlockType::kBlock, 1);
+    map.board.setCell(5, 8, BlockType::kEmpty, 0);
+    map.board.setCell(6, 8, BlockType::kBlock, 2);
+    engine.newGame(GameMode::kSingle, map);
+    QVERIFY(recorder.outcomes.empty());
+    engine.start();
+    QVERIFY(engine.isOver());
+    QCOMPARE(recorder.outcomes.size(), size_t(1));
+    QCOMPARE(recorder.outcomes[0], GameOutcome::kNoMoreMatch);
+    engine.removeListener(&recorder);
+}
+
+void UnitTest::testSolver()
+{
+    Solver solver(16);
+    Board board;
+
+    // The middle blocks are in the way, and there is no way around them.
+    QVERIFY(board.fromAscii("1212\n"));
+    QCOMPARE(solver.solve(board, GameEngine::kDefaultMaxTurns).status,
+             SolveStatus::kUnsolvable);
+    QVERIFY(board.fromAscii("12\n21\n"));
+    QCOMPARE(solver.solve(board, GameEngine::kDefaultMaxTurns).status,
+             SolveStatus::kUnsolvable);
+
+    // A game sized board, checked by replaying the solution.
+    generateBoard(board, 0);
+    const SolverResult result = solver.solve(board,
+                                             GameEngine::kDefaultMaxTurns);
+    QCOMPARE(result.status, SolveStatus::kSolved);
+    QCOMPARE(static_cast<int>(result.moves.size()),
+             GameEngine::kBlockNum / 2);
+    LinkChecker checker(&board);
+    for (const auto &m: result.moves) {
+        QVERIFY(board.isBlock(board.index(m.first)));
+        QCOMPARE(board.content(m.first.r, m.first.c),
+                 board.content(m.second.r, m.second.c));
+        QVERIFY(checker.connect(m.first, m.second, GameEngine::kDefaultMaxTurns,
+                                nullptr));
+        board.clearCell(m.first.r, m.first.c);
+        board.clearCell(m.second.r, m.second.c);
+    }
+
+    SolverBudget budget;
+    budget.maxNodes = 1;
+    generateBoard(board, 0);
+    QCOMPARE(solver.solve(board, GameEngine::kDefaultMaxTurns, budget).status,
+             SolveStatus::kOutOfBudget);
+}
+
+void UnitTest::testBeamSolver()
+{
+    BeamSolver solver(2);
+    Board board;
+
+    // Dead ends are pruned, but a stuck board cannot be cleared.
+    QVERIFY(board.fromAscii("1212\n"));
+    BeamResult result = solver.solve(board, GameEngine::kDefaultMaxTurns);
+    QVERIFY(!result.cleared);
+    QCOMPARE(result.blocksLeft, 4);
+
+    // A game sized board, checked by replaying the line found.
+    generateBoard(board, 0);
+    result = solver.solve(board, GameEngine::kDefaultMaxTurns);
+    QVERIFY(result.cleared);
+    QVERIFY(!result.timedOut);
+    QCOMPARE(result.blocksLeft, 0);
+    QCOMPARE(static_cast<int>(result.moves.size()),
+             GameEngine::kBlockNum / 2);
+    LinkChecker checker(&board);
+    for (const auto &m: result.moves) {
+        QVERIFY(board.isBlock(board.index(m.first)));
+        QCOMPARE(board.content(m.first.r, m.first.c),
+                 board.content(m.second.r, m.second.c));
+        QVERIFY(checker.connect(m.first, m.second, GameEngine::kDefaultMaxTurns,
+                                nullptr));
+        board.clearCell(m.first.r, m.first.c);
+        board.clearCell(m.second.r, m.second.c);
+    }
+
+    // Too large to clear in a millisecond, but some line is still returned.
+    board.beginUpdate();
+    board.reset(100, 100);
+    for (int i = 0; i < 6000; ++i) {
+        board.setCell(i / 100, i % 100, BlockType::kBlock, i % 20 + 1);
+    }
+    board.endUpdate();
+    BeamOptions options;
+    options.maxMillis = 1;
+    result = solver.solve(board, GameEngine::kDefaultMaxTurns, options);
+    QVERIFY(result.timedOut);
+    QVERIFY(!result.cleared);
+    QCOMPARE(result.blocksLeft,
+             6000 - 2 * static_cast<int>(result.moves.size()));
+}
+
+void UnitTest::benchmarkLinkEngines_data()
+{
+    QTest::addColumn<int>("engine");
+    QTest::newRow("layered bfs") << static_cast<int>(LinkEngine::kLayeredBfs);
+    QTest::newRow("line of sight") <<
+            static_cast<int>(LinkEngine::kLineOfSight);
+}
+
+void UnitTest::benchmarkLinkEngines()
+{
+    QFETCH(int, engine);
+    const int rows = GameEngine::kMaxRows;
+    const int cols = GameEngine::kMaxCols;
+    Board board;
+    LinkChecker checker(&board);
+    checker.setEngine(static_cast<LinkEngine>(engine));
+    generateBoard(board, 0);
+
+    // Every pair of blocks of the same content, like `hasNextStep` does.
+    QBENCHMARK {
+        for (int i = 0; i < rows * cols; ++i) {
+            const Cell from = { i / cols, i % cols };
+            if (board.type(from.r, from.c) != BlockType::kBlock) {
+                continue;
+            }
+            for (int j = i + 1; j < rows * cols; ++j) {
+                const Cell to = { j / cols, j % cols };
+                if (board.type(to.r, to.c) == BlockType::kBlock &&
+                    board.content(to.r, to.c) ==
+                        board.content(from.r, from.c)) {
+                    checker.connect(from, to, GameEngine::kDefaultMaxTurns,
+                                    nullptr);
+                }
+            }
+        }
+    }
+}
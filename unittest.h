@@ -2,23 +2,75 @@
 #define UNITTEST_H
 
 #include "includes.h"
+#include "beamsolver.h"
+#include "boardgenerator.h"
+#include "boardshuffler.h"
+#include "gameengine.h"
+#include "levelpack.h"
+#include "mappool.h"
+#include "nextstep.h"
+#include "solver.h"
 #include "uimanager.h"
 
 class UnitTest: public QObject
 {
     Q_OBJECT
 private:
-    // Utility function to set <blockMap> in GameWindow to
-    // all empty.
-    void clearBlockMap(GameWindow &w);
+    // Utility function to set the board of <engine> to all empty.
+    void clearGame(GameEngine &engine);
 
-    // Utility function to generate a block at <r>, <c> on blockMap of <w>,
-    // with type being <t>, content being <bc> and choosing player being <which>.
-    void generateBlock(GameWindow &w, const int r, const int c,
+    // Utility function to generate a block at <r>, <c> on the board of
+    // <engine>, with type being <t>, content being <bc> and choosing player
+    // being <which>.
+    void generateBlock(GameEngine &engine, const int r, const int c,
                        const BlockType t,
                        const BlockContent bc,
                        const WhichPlayer which);
 
+    // Utility function to fill <board> with the blocks of a game at random
+    // cells, from a fixed <seed> so that every run sees the same boards.
+    void generateBoard(Board &board, const unsigned seed);
+
+    // Number of boards that each row of `testLinkFuzz` generates, and of
+    // pairs that it links on each board.
+    static const int kFuzzBoards = 50;
+    static const int kFuzzPairsPerBoard = 2000;
+
+    // Cells visited by the current `referenceSearch`, indexed like a board
+    // that is padded by the border lane only.
+    std::vector<uint8_t> referenceVisited;
+
+    // Port of the recursive search that `GameWindow::checkConnectivity` ran
+    // before there were link engines, extended to the border lane. Far too
+    // slow for the game, but simple enough to be the reference that every
+    // engine has to agree with.
+    bool referenceConnect(const Board &board, const Cell &from, const Cell &to,
+                          const int maxTurns);
+    bool referenceSearch(const Board &board, const Cell &current,
+                         const Cell &to, const int turns, const int maxTurns,
+                         const int prevD);
+
+    // Utility function to fill <board> with <rows> x <cols> cells. Each cell
+    // holds a block of one of <contents> contents with a chance of <density>
+    // percent, and an item with a small chance otherwise. The routing mode of
+    // <board> is kept.
+    void generateFuzzBoard(Board &board, std::mt19937 &rng, const int rows,
+                           const int cols, const int density,
+                           const int contents);
+
+    // Link <from> and <to> on <board> with at most <maxTurns> turns with
+    // every link engine, and check the paths they return. Returns a line for
+    // each engine that disagrees with `referenceConnect` or returns a broken
+    // path, or an empty string if they all agree.
+    std::string linkMismatch(const Board &board, const Cell &from,
+                             const Cell &to, const int maxTurns);
+
+    // Shrink <board> by dropping rows and columns and clearing cells, as long
+    // as `linkMismatch` still reports a mismatch. <from> and <to> are kept,
+    // and moved along with their cells.
+    void shrinkLinkMismatch(Board &board, Cell &from, Cell &to,
+                            const int maxTurns);
+
 private slots:
     void testSuccess();
 
@@ -32,6 +84,48 @@ private slots:
 
     void testChosenByDifferentPlayer();
 
+    void testPathCorners();
+
+    void testLinkEnginesAgree();
+    void testLinkKernels();
+    void testBorderRouting();
+    void testLinkFuzz_data();
+    void testLinkFuzz();
+
+    void testObstacleDistance();
+
+    void testConnectAll();
+
+    void testPairIndex();
+
+    void testContentBuckets();
+
+    void testRegionIndex();
+    void testDistanceField();
+    void testPathFinder();
+
+    void testMoveEnumerator();
+
+    void testAnalysisWorker();
+
+    void testBoardAscii();
+
+    void testBoardGenerator();
+    void testMapPool();
+    void testFreeCells();
+    void testBoardShuffler();
+    void testGameRandom();
+    void testDifficultySearch();
+    void testLevelPack();
+    void testGameEngine();
+
+    void testSolver();
+    void testBeamSolver();
+
+    void benchmarkLinkEngines_data();
+
+    void benchmarkLinkEngines();
+
 public:
     UnitTest();
 };
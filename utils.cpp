@@ -8,14 +8,6 @@ void Utils::centerWindowInScreen(QWidget *widget)
                  widget->frameGeometry().center());
 }
 
-int Utils::randomInt(int min, int max)
-{
-    static std::random_device rd;
-    static std::mt19937 rng(rd());
-    std::uniform_int_distribution<int> uni(min, max - 1);
-    return uni(rng);
-}
-
 void Utils::removeAllWidgets(QLayout *const layout)
 {
     QLayoutItem *item;
@@ -0,0 +1,68 @@
+#include "xoshiro256.h"
+
+#include <cassert>
+
+Xoshiro256::Xoshiro256(const uint64_t seed)
+{
+    this->seed(seed);
+}
+
+void Xoshiro256::seed(const uint64_t seed)
+{
+    // SplitMix64 never yields four zeros in a row, so the state is valid.
+    uint64_t x = seed;
+    for (uint64_t &word: s) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        word = z ^ (z >> 31);
+    }
+}
+
+uint64_t Xoshiro256::below(const uint64_t n)
+{
+    assert(n > 0);
+    // Numbers below 2^64 mod <n> would make the low results more likely.
+    const uint64_t threshold = -n % n;
+    uint64_t x;
+    do {
+        x = (*this)();
+    } while (x < threshold);
+    return x % n;
+}
+
+void Xoshiro256::jump()
+{
+    static const uint64_t kJump[] = {
+        0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+        0xa9582618e03fc9aa, 0x39abdc4529b1661c
+    };
+
+    uint64_t t[4] = { 0, 0, 0, 0 };
+    for (const uint64_t jump: kJump) {
+        for (int b = 0; b < 64; ++b) {
+            if (jump & (uint64_t(1) << b)) {
+                for (int i = 0; i < 4; ++i) {
+                    t[i] ^= s[i];
+                }
+            }
+            (*this)();
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        s[i] = t[i];
+    }
+}
+
+std::array<uint64_t, 4> Xoshiro256::state() const
+{
+    return { s[0], s[1], s[2], s[3] };
+}
+
+void Xoshiro256::setState(const std::array<uint64_t, 4> &state)
+{
+    assert(state[0] || state[1] || state[2] || state[3]);
+    for (int i = 0; i < 4; ++i) {
+        s[i] = state[i];
+    }
+}
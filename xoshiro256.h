@@ -0,0 +1,79 @@
+#ifndef XOSHIRO256_H
+#define XOSHIRO256_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// The xoshiro256** generator of Blackman and Vigna: 256 bits of state, a
+// period of 2^256 - 1, and a handful of shifts and multiplies per number.
+// Meets the requirements of UniformRandomBitGenerator, so it works with the
+// distributions and algorithms of <random> and <algorithm>. Their results
+// differ between standard libraries though, so anything a seed must decide
+// draws through `below` and `shuffle` instead.
+class Xoshiro256 {
+public:
+    typedef uint64_t result_type;
+
+    // A generator whose state is expanded from <seed> by SplitMix64, as the
+    // authors recommend. The same seed always gives the same numbers.
+    explicit Xoshiro256(const uint64_t seed = 0);
+
+    void seed(const uint64_t seed);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    result_type operator()();
+
+    // A uniformly random integer in [0, <n>), <n> > 0.
+    uint64_t below(const uint64_t n);
+
+    // Put <items> in a uniformly random order, by Fisher-Yates.
+    template <typename T>
+    void shuffle(std::vector<T> *items);
+
+    // Advance the generator by 2^128 numbers. Jumping a copy of a generator
+    // gives a stream that does not overlap it for any practical length.
+    void jump();
+
+    // The whole state, for saving and restoring a generator. An all zero
+    // state is invalid.
+    std::array<uint64_t, 4> state() const;
+    void setState(const std::array<uint64_t, 4> &state);
+
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(const uint64_t x, const int k);
+};
+
+inline uint64_t Xoshiro256::rotl(const uint64_t x, const int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+inline Xoshiro256::result_type Xoshiro256::operator()()
+{
+    const uint64_t result = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+template <typename T>
+void Xoshiro256::shuffle(std::vector<T> *items)
+{
+    for (size_t i = items->size(); i > 1; --i) {
+        std::swap((*items)[i - 1], (*items)[below(i)]);
+    }
+}
+
+#endif // XOSHIRO256_H